@@ -2,7 +2,6 @@
 
 #include "graphics.h"
 #include "resources.h"
-#include "value.h"
 #include "audio.h"
 #include "window.h"
 #include "SDL.h"
@@ -12,8 +11,121 @@
 #include <string.h>
 #include <stdbool.h>
 #include <math.h>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+//--- voice allocation ---------------------------------------------
+// Tracks played by arcmAudioReplay are recorded as voices, with their sample, priority, volume, and
+// the time span they are expected to play. Once all tracks are busy, the voice of lowest priority is
+// stolen for a sound of at least equal priority, the oldest and then the quietest one among equals,
+// otherwise the new sound is dropped. Tracks playing streams are never stolen. Replays of a sample
+// still playing with equal balance and detune within AUDIO_MERGE_INTERVAL are merged into one voice
+// at the higher volume, so that sounds triggered by many objects at once are mixed only once.
+
+/// time in seconds within which replays of the same sample are merged
+#define AUDIO_MERGE_INTERVAL 0.008
+
+typedef struct {
+	uint32_t sample; ///< 0 if the track is not played by arcmAudioReplay
+	int priority;
+	float volume, balance, detune;
+	double start, end;
+} AudioVoice;
+
+static AudioVoice* audioVoices = NULL;
+static uint32_t audioNumVoices = 0;
+static uint32_t audioDropped = 0, audioStolen = 0, audioMerged = 0;
+
+static double audioTimestamp() {
+	return (double)SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency();
+}
+
+/// @return the voice playing on a track, or NULL if the track is not played by arcmAudioReplay anymore
+static AudioVoice* audioVoice(uint32_t track, double now) {
+	if(track >= audioNumVoices || !audioVoices[track].sample)
+		return NULL;
+	AudioVoice* voice = &audioVoices[track];
+	if(now > voice->end || !AudioPlaying(track)) {
+		voice->sample = 0;
+		return NULL;
+	}
+	return voice;
+}
+
+/// stops the least important voice of lower or equal priority
+static bool audioSteal(int priority, double now) {
+	AudioVoice* victim = NULL;
+	for(uint32_t track=0; track<audioNumVoices; ++track) {
+		AudioVoice* voice = audioVoice(track, now);
+		if(!voice || voice->priority > priority)
+			continue;
+		if(!victim || voice->priority < victim->priority || (voice->priority == victim->priority
+			&& (voice->start < victim->start || (voice->start == victim->start && voice->volume < victim->volume))))
+			victim = voice;
+	}
+	if(!victim)
+		return false;
+	AudioStop((uint32_t)(victim - audioVoices));
+	victim->sample = 0;
+	++audioStolen;
+	return true;
+}
+
+uint32_t arcmAudioReplay(uint32_t sample, float volume, float balance, float detune, int priority) {
+	uint8_t numChannels = 0;
+	uint32_t numSamples = 0;
+	AudioSampleInfo(sample, &numChannels, &numSamples);
+	if(!numSamples)
+		return UINT32_MAX;
+	if(!audioVoices) {
+		audioNumVoices = AudioTracks();
+		audioVoices = (AudioVoice*)calloc(audioNumVoices ? audioNumVoices : 1, sizeof(AudioVoice));
+	}
+
+	const double now = audioTimestamp();
+	for(uint32_t track=0; track<audioNumVoices; ++track) {
+		AudioVoice* voice = audioVoice(track, now);
+		if(!voice || voice->sample != sample || now - voice->start > AUDIO_MERGE_INTERVAL
+			|| voice->balance != balance || voice->detune != detune)
+			continue;
+		if(volume > voice->volume) {
+			AudioAdjustVolume(track, volume);
+			voice->volume = volume;
+		}
+		if(priority > voice->priority)
+			voice->priority = priority;
+		++audioMerged;
+		return track;
+	}
+
+	uint32_t track = AudioReplay(sample, volume, balance, detune);
+	if(track == UINT32_MAX && audioSteal(priority, now))
+		track = AudioReplay(sample, volume, balance, detune);
+	if(track == UINT32_MAX) {
+		++audioDropped;
+		return UINT32_MAX;
+	}
+	if(track < audioNumVoices) {
+		AudioVoice* voice = &audioVoices[track];
+		voice->sample = sample;
+		voice->priority = priority;
+		voice->volume = volume;
+		voice->balance = balance;
+		voice->detune = detune;
+		voice->start = now;
+		voice->end = now + numSamples / (AudioSampleRate() * pow(2.0, detune / 12.0));
+	}
+	return track;
+}
 
 void arcmAudioVolume(uint32_t track, float volume, float fadeTime) {
+	if(track < audioNumVoices) { // stopped tracks may play streams next
+		AudioVoice* voice = &audioVoices[track];
+		voice->volume = volume;
+		if(volume <= 0.0f && voice->end > audioTimestamp() + fadeTime)
+			voice->end = audioTimestamp() + fadeTime;
+	}
 	if(fadeTime <= 0.0f) {
 		if(volume>0.0f)
 			AudioAdjustVolume(track, volume);
@@ -25,6 +137,322 @@ void arcmAudioVolume(uint32_t track, float volume, float fadeTime) {
 		AudioAdjustVolume(track, volume);
 }
 
+//--- audio clock --------------------------------------------------
+// arcajs opens the audio device with a mixer buffer of 1/60 s and starts replays at the beginning of the
+// next buffer. The device is opened through __wrap_SDL_OpenAudioDevice instead, linked by
+// -Wl,--wrap=SDL_OpenAudioDevice, which applies the configured buffer size and interposes a callback
+// counting mixed frames as the audio clock. Replays scheduled against that clock are started by the
+// callback at the beginning of the buffer containing their onset frame. As the arcajs mixer always
+// mixes whole buffers, the offset of the onset within its buffer is played as silence: the sample is
+// copied behind a lead-in of that many (detuned) frames when the replay is scheduled, and the copy is
+// played by AudioPlay, which references it until the track has ended. The callback frees copies once
+// their track has certainly ended. Onsets due within the first buffer already mixed start at once.
+// Copies are made from the sample data passed to AudioUploadPCM by arcmAudioUploadPCM, samples not
+// uploaded by it start at the beginning of the buffer containing their onset.
+// Scheduled replays are neither merged nor stolen, and are dropped if no track is available.
+// Each callback is instrumented as well: its duration, the jitter of its interval, late callbacks as
+// probable underruns, the number of tracks playing, and the peak level of its output. Callbacks are
+// recorded for the trace export while it is enabled, to be written by the main thread.
+
+/// maximum number of pending scheduled replays
+#define AUDIO_SCHEDULE_MAX 256
+/// callback interval relative to the buffer duration beyond which the device has likely run dry
+#define AUDIO_LATE_INTERVAL 2.0
+/// maximum number of callbacks recorded for the trace export between two frames
+#define AUDIO_TRACE_MAX 64
+
+/// copy of a scheduled sample behind its lead-in, played by AudioPlay
+typedef struct AudioLeadIn {
+	struct AudioLeadIn* next;
+	uint64_t endFrame; ///< after which the track playing it has ended
+	uint32_t numFrames, leadFrames;
+	uint32_t offset; ///< of the onset within its buffer
+	uint8_t numChannels;
+	float data[];
+} AudioLeadIn;
+
+typedef struct {
+	uint64_t frame;
+	uint32_t sample;
+	float volume, balance, detune;
+	AudioLeadIn* leadIn; ///< NULL if the onset is at the beginning of its buffer
+} AudioScheduled;
+
+static SDL_AudioDeviceID audioDevice = 0;
+static SDL_AudioSpec audioSpec; ///< the device spec obtained by arcajs
+static SDL_AudioCallback audioMixer = NULL;
+static uint16_t audioBufferFrames = 0; ///< 0 for the arcajs default
+static uint64_t audioFrames = 0;
+static AudioScheduled audioSchedule[AUDIO_SCHEDULE_MAX]; ///< by descending frame, next one last
+static uint32_t audioNumScheduled = 0, audioScheduleDropped = 0;
+static AudioLeadIn* audioLeadIns = NULL; ///< copies of started scheduled replays
+static const float** audioSampleData = NULL; ///< by sample handle - 1, beginning after the offset
+static uint32_t audioSampleDataCapacity = 0;
+
+typedef struct {
+	uint64_t start, end; ///< performance counter
+	uint32_t voices;
+	float peak;
+	bool underrun;
+} AudioCallbackRecord;
+
+static uint64_t audioCallbackLast = 0;
+static double audioMixTime = 0.0, audioMixTimeMax = 0.0, audioJitter = 0.0, audioJitterMax = 0.0;
+static uint32_t audioUnderruns = 0, audioActive = 0, audioActiveMax = 0, audioClipped = 0;
+static int audioPeak = 0; ///< since last queried
+static bool audioTraced = false;
+static AudioCallbackRecord audioTrace[AUDIO_TRACE_MAX];
+static uint32_t audioNumTraced = 0, audioTraceDropped = 0;
+
+/// measures a callback that started at start having mixed numFrames into stream
+static void audioInstrument(const Uint8* stream, uint16_t numFrames, uint64_t start) {
+	const uint64_t end = SDL_GetPerformanceCounter();
+	const double counterFreq = (double)SDL_GetPerformanceFrequency();
+	const double bufferTime = (double)numFrames / audioSpec.freq;
+	const double mixTime = (end - start) / counterFreq;
+	audioMixTime = audioMixTime > 0.0 ? 0.95 * audioMixTime + 0.05 * mixTime : mixTime;
+	if(mixTime > audioMixTimeMax)
+		audioMixTimeMax = mixTime;
+	bool underrun = mixTime > bufferTime;
+	if(audioCallbackLast) {
+		const double interval = (start - audioCallbackLast) / counterFreq;
+		const double jitter = fabs(interval - bufferTime);
+		audioJitter = 0.95 * audioJitter + 0.05 * jitter;
+		if(jitter > audioJitterMax)
+			audioJitterMax = jitter;
+		if(interval > AUDIO_LATE_INTERVAL * bufferTime)
+			underrun = true;
+	}
+	audioCallbackLast = start;
+	if(underrun)
+		++audioUnderruns;
+
+	uint32_t active = 0;
+	for(uint32_t track=0, numTracks = AudioTracks(); track<numTracks; ++track)
+		if(AudioPlaying(track))
+			++active;
+	audioActive = active;
+	if(active > audioActiveMax)
+		audioActiveMax = active;
+
+	int peak = 0;
+	if(audioSpec.format == AUDIO_S16SYS) {
+		const Sint16* samples = (const Sint16*)stream;
+		for(uint32_t i=0, count = numFrames * audioSpec.channels; i<count; ++i) {
+			const int value = samples[i] < 0 ? -samples[i] : samples[i];
+			if(value > peak)
+				peak = value;
+			if(value >= 32767)
+				++audioClipped;
+		}
+	}
+	if(peak > audioPeak)
+		audioPeak = peak;
+
+	if(!audioTraced)
+		return;
+	if(audioNumTraced == AUDIO_TRACE_MAX) {
+		++audioTraceDropped;
+		return;
+	}
+	AudioCallbackRecord* record = &audioTrace[audioNumTraced++];
+	record->start = start;
+	record->end = end;
+	record->voices = active;
+	record->peak = peak / 32767.0f;
+	record->underrun = underrun;
+}
+
+/// starts a scheduled replay within the buffer beginning at the current audio clock
+static void audioStartScheduled(const AudioScheduled* scheduled) {
+	AudioLeadIn* leadIn = scheduled->leadIn;
+	if(!leadIn) {
+		if(AudioReplay(scheduled->sample, scheduled->volume, scheduled->balance, scheduled->detune) == UINT32_MAX)
+			++audioScheduleDropped;
+		return;
+	}
+	// a late onset skips (part of) its lead-in
+	const float rate = powf(2.0f, scheduled->detune / 12.0f);
+	const uint64_t begin = scheduled->frame - leadIn->offset;
+	const uint64_t late = audioFrames > begin ? audioFrames - begin : 0;
+	const uint32_t skip = late >= leadIn->offset ? leadIn->leadFrames : (uint32_t)(late * rate + 0.5f);
+	if(AudioPlay(leadIn->data + skip * leadIn->numChannels, leadIn->numFrames - skip, leadIn->numChannels,
+		scheduled->volume, scheduled->balance, scheduled->detune) == UINT32_MAX)
+	{
+		++audioScheduleDropped;
+		free(leadIn);
+		return;
+	}
+	leadIn->endFrame = audioFrames + (uint64_t)((leadIn->numFrames - skip) / rate) + 2;
+	leadIn->next = audioLeadIns;
+	audioLeadIns = leadIn;
+}
+
+/// frees the copies of scheduled replays whose tracks have ended
+static void audioFreeLeadIns(bool all) {
+	for(AudioLeadIn** it = &audioLeadIns; *it; ) {
+		AudioLeadIn* leadIn = *it;
+		if(all || leadIn->endFrame <= audioFrames) {
+			*it = leadIn->next;
+			free(leadIn);
+		}
+		else
+			it = &leadIn->next;
+	}
+}
+
+static void SDLCALL audioClockCallback(void* udata, Uint8* stream, int len) {
+	const uint64_t start = SDL_GetPerformanceCounter();
+	const uint16_t numFrames = audioSpec.samples;
+	while(audioNumScheduled && audioSchedule[audioNumScheduled-1].frame < audioFrames + numFrames)
+		audioStartScheduled(&audioSchedule[--audioNumScheduled]);
+	audioMixer(udata, stream, len);
+	audioFrames += numFrames;
+	audioFreeLeadIns(false);
+	audioInstrument(stream, numFrames, start);
+}
+
+extern SDL_AudioDeviceID __real_SDL_OpenAudioDevice(const char* device, int iscapture,
+	const SDL_AudioSpec* desired, SDL_AudioSpec* obtained, int allowedChanges);
+
+SDL_AudioDeviceID __wrap_SDL_OpenAudioDevice(const char* device, int iscapture,
+	const SDL_AudioSpec* desired, SDL_AudioSpec* obtained, int allowedChanges)
+{
+	if(iscapture || !obtained || !desired->callback || (allowedChanges & SDL_AUDIO_ALLOW_SAMPLES_CHANGE))
+		return __real_SDL_OpenAudioDevice(device, iscapture, desired, obtained, allowedChanges);
+	SDL_AudioSpec spec = *desired;
+	if(audioBufferFrames)
+		spec.samples = audioBufferFrames;
+	spec.callback = audioClockCallback;
+	audioMixer = desired->callback;
+	for(uint32_t i=0; i<audioNumScheduled; ++i)
+		free(audioSchedule[i].leadIn);
+	audioFreeLeadIns(true);
+	audioFrames = 0;
+	audioNumScheduled = 0;
+	audioCallbackLast = 0;
+	audioDevice = __real_SDL_OpenAudioDevice(device, iscapture, &spec, obtained, allowedChanges);
+	if(audioDevice)
+		audioSpec = *obtained;
+	return audioDevice;
+}
+
+uint32_t arcmAudioUploadPCM(float* waveData, uint32_t numSamples, uint8_t numChannels, uint32_t offset) {
+	const uint32_t sample = AudioUploadPCM(waveData, numSamples, numChannels, offset);
+	if(sample > audioSampleDataCapacity) {
+		const uint32_t capacity = sample > 2 * audioSampleDataCapacity ? sample + 63 : 2 * audioSampleDataCapacity;
+		const float** data = (const float**)realloc((void*)audioSampleData, capacity * sizeof(float*));
+		if(!data)
+			return sample;
+		memset((void*)(data + audioSampleDataCapacity), 0, (capacity - audioSampleDataCapacity) * sizeof(float*));
+		audioSampleData = data;
+		audioSampleDataCapacity = capacity;
+	}
+	if(sample)
+		audioSampleData[sample-1] = waveData + (size_t)offset * numChannels;
+	return sample;
+}
+
+uint32_t arcmAudioBufferSize() {
+	return audioDevice ? audioSpec.samples : 0;
+}
+
+double arcmAudioLatency() {
+	return audioDevice ? (double)audioSpec.samples / audioSpec.freq : 0.0;
+}
+
+double arcmAudioTime() {
+	if(!audioDevice)
+		return 0.0;
+	SDL_LockAudioDevice(audioDevice);
+	const uint64_t frames = audioFrames;
+	SDL_UnlockAudioDevice(audioDevice);
+	return (double)frames / audioSpec.freq;
+}
+
+bool arcmAudioReplayAt(uint32_t sample, double when, float volume, float balance, float detune) {
+	uint8_t numChannels = 0;
+	uint32_t numSamples = 0;
+	AudioSampleInfo(sample, &numChannels, &numSamples);
+	if(!numSamples || (numChannels > 1 && (balance != 0.0f || detune != 0.0f)))
+		return false;
+	if(!audioDevice)
+		return arcmAudioReplay(sample, volume, balance, detune, 0) != UINT32_MAX;
+
+	const uint64_t frame = when > 0.0 ? (uint64_t)(when * audioSpec.freq + 0.5) : 0;
+	AudioLeadIn* leadIn = NULL;
+	const uint32_t offset = (uint32_t)(frame % audioSpec.samples);
+	const float* data = sample <= audioSampleDataCapacity ? audioSampleData[sample-1] : NULL;
+	if(offset && data) { // lead-in of the onset's offset within its buffer, in frames of the detuned sample
+		const uint32_t leadFrames = (uint32_t)(offset * powf(2.0f, detune / 12.0f) + 0.5f);
+		leadIn = (AudioLeadIn*)malloc(sizeof(AudioLeadIn) + ((size_t)leadFrames + numSamples) * numChannels * sizeof(float));
+		if(!leadIn)
+			return false;
+		leadIn->next = NULL;
+		leadIn->numFrames = leadFrames + numSamples;
+		leadIn->leadFrames = leadFrames;
+		leadIn->offset = offset;
+		leadIn->numChannels = numChannels;
+		memset(leadIn->data, 0, (size_t)leadFrames * numChannels * sizeof(float));
+		memcpy(leadIn->data + (size_t)leadFrames * numChannels, data, (size_t)numSamples * numChannels * sizeof(float));
+	}
+
+	SDL_LockAudioDevice(audioDevice);
+	const bool scheduled = audioNumScheduled < AUDIO_SCHEDULE_MAX;
+	if(scheduled) { // replays scheduled for the same frame start in call order
+		uint32_t i = audioNumScheduled++;
+		for(; i > 0 && audioSchedule[i-1].frame <= frame; --i)
+			audioSchedule[i] = audioSchedule[i-1];
+		audioSchedule[i].frame = frame;
+		audioSchedule[i].sample = sample;
+		audioSchedule[i].volume = volume;
+		audioSchedule[i].balance = balance;
+		audioSchedule[i].detune = detune;
+		audioSchedule[i].leadIn = leadIn;
+	}
+	SDL_UnlockAudioDevice(audioDevice);
+	if(!scheduled) {
+		free(leadIn);
+		++audioDropped;
+	}
+	return scheduled;
+}
+
+static double arcmAudioStats(const char* name) {
+	if(!strcmp(name, "audioDropped"))
+		return (double)audioDropped + audioScheduleDropped;
+	if(!strcmp(name, "audioStolen"))
+		return (double)audioStolen;
+	if(!strcmp(name, "audioMerged"))
+		return (double)audioMerged;
+	if(!audioDevice) // mixer statistics
+		return NAN;
+	double value = NAN;
+	SDL_LockAudioDevice(audioDevice);
+	if(!strcmp(name, "audioMixTime"))
+		value = audioMixTime;
+	else if(!strcmp(name, "audioMixTimeMax"))
+		value = audioMixTimeMax;
+	else if(!strcmp(name, "audioJitter"))
+		value = audioJitter;
+	else if(!strcmp(name, "audioJitterMax"))
+		value = audioJitterMax;
+	else if(!strcmp(name, "audioUnderruns"))
+		value = (double)audioUnderruns;
+	else if(!strcmp(name, "audioVoices"))
+		value = (double)audioActive;
+	else if(!strcmp(name, "audioVoicesMax"))
+		value = (double)audioActiveMax;
+	else if(!strcmp(name, "audioClipped"))
+		value = (double)audioClipped;
+	else if(!strcmp(name, "audioPeak")) {
+		value = audioPeak / 32767.0;
+		audioPeak = 0;
+	}
+	SDL_UnlockAudioDevice(audioDevice);
+	return value;
+}
+
 static void arcmAudioDeltaVolume(float delta) {
 	float volume = AudioGetVolume() + delta;
 	if(volume<0.0f)
@@ -34,12 +462,414 @@ static void arcmAudioDeltaVolume(float delta) {
 	AudioSetVolume(volume);
 }
 
+//--- startup profile ----------------------------------------------
+// Stages are timed from one arcmStartupStage() call to the next, resources loaded synchronously until
+// the first frame is presented are timed individually. All timestamps are relative to the call of
+// arcmStartupProfile(), on Linux the time from exec() up to then is reported as well.
+
+#define STARTUP_MAX_ENTRIES 256
+
+typedef struct {
+	char* name;
+	double start, end;
+	bool resource;
+} StartupEntry;
+
+static int startupProfile = 0; ///< 0: off, 1: table, 2: JSON
+static double startupBegin = 0.0, startupLast = 0.0, startupExec = NAN;
+static StartupEntry startupEntries[STARTUP_MAX_ENTRIES];
+static size_t startupNumEntries = 0;
+
+static double startupTimestamp() {
+	return (double)SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency();
+}
+
+/// @return seconds since the process was started, at a resolution of clock ticks, or NaN if unknown
+static double startupSinceExec() {
+#ifdef __linux__
+	double uptime = 0.0;
+	unsigned long long startTicks = 0;
+	FILE* f = fopen("/proc/uptime", "r");
+	const bool hasUptime = f && fscanf(f, "%lf", &uptime) == 1;
+	if(f)
+		fclose(f);
+	f = fopen("/proc/self/stat", "r");
+	char buf[1024];
+	const size_t n = f ? fread(buf, 1, sizeof(buf)-1, f) : 0;
+	if(f)
+		fclose(f);
+	buf[n] = 0;
+	const char* pos = strrchr(buf, ')'); // skips the command name, which may contain spaces
+	if(hasUptime && pos && sscanf(pos+2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &startTicks) == 1)
+		return uptime - (double)startTicks / (double)sysconf(_SC_CLK_TCK);
+#endif
+	return NAN;
+}
+
+static void startupRecord(const char* name, double start, double end, bool resource) {
+	if(startupNumEntries == STARTUP_MAX_ENTRIES)
+		return;
+	StartupEntry* entry = &startupEntries[startupNumEntries++];
+	entry->name = strdup(name);
+	entry->start = start - startupBegin;
+	entry->end = end - startupBegin;
+	entry->resource = resource;
+}
+
+static void startupResource(const char* name, double start) {
+	if(startupProfile)
+		startupRecord(name, start, startupTimestamp(), true);
+}
+
+static void startupReport() {
+	const double total = startupLast - startupBegin;
+	if(startupProfile == 2) {
+		printf("{\"execToProfile\":%.6f,\"stages\":[", isnan(startupExec) ? -1.0 : startupExec);
+		for(int resource = 0; resource < 2; ++resource) {
+			if(resource)
+				printf("],\"resources\":[");
+			bool first = true;
+			for(size_t i=0; i<startupNumEntries; ++i) {
+				const StartupEntry* entry = &startupEntries[i];
+				if(entry->resource != (bool)resource)
+					continue;
+				printf("%s{\"name\":\"", first ? "" : ",");
+				for(const char* ch = entry->name; *ch; ++ch)
+					printf(*ch=='"' || *ch=='\\' ? "\\%c" : "%c", *ch);
+				printf("\",\"start\":%.6f,\"duration\":%.6f}", entry->start, entry->end - entry->start);
+				first = false;
+			}
+		}
+		printf("],\"firstPresent\":%.6f}\n", total);
+	}
+	else {
+		for(size_t i=1; i<startupNumEntries; ++i) { // stages ahead of the resources loaded during them
+			const StartupEntry entry = startupEntries[i];
+			size_t j = i;
+			for(; j>0 && startupEntries[j-1].start > entry.start; --j)
+				startupEntries[j] = startupEntries[j-1];
+			startupEntries[j] = entry;
+		}
+		printf("%-40s %10s %10s\n", "startup stage", "start ms", "ms");
+		if(!isnan(startupExec))
+			printf("%-40s %10.1f %10.1f\n", "exec", -startupExec * 1000.0, startupExec * 1000.0);
+		for(size_t i=0; i<startupNumEntries; ++i) {
+			const StartupEntry* entry = &startupEntries[i];
+			printf("%s%-*.*s %10.2f %10.2f\n", entry->resource ? "  " : "", entry->resource ? 38 : 40, entry->resource ? 38 : 40,
+				entry->name, entry->start * 1000.0, (entry->end - entry->start) * 1000.0);
+		}
+		printf("%-40s %10.2f\n", "first present", total * 1000.0);
+		if(!isnan(startupExec))
+			printf("%-40s %10.2f\n", "exec to first present", (startupExec + total) * 1000.0);
+	}
+	fflush(stdout);
+	for(size_t i=0; i<startupNumEntries; ++i)
+		free(startupEntries[i].name);
+	startupNumEntries = 0;
+}
+
+void arcmStartupProfile(bool json) {
+	startupProfile = json ? 2 : 1;
+	startupBegin = startupLast = startupTimestamp();
+	startupExec = startupSinceExec();
+}
+
+void arcmStartupStage(const char* stage) {
+	if(!startupProfile)
+		return;
+	const double now = startupTimestamp();
+	startupRecord(stage, startupLast, now, false);
+	startupLast = now;
+}
+
+void arcmStartupPresented() {
+	if(!startupProfile)
+		return;
+	arcmStartupStage("first frame");
+	startupReport();
+	startupProfile = 0;
+}
+
+//--- trace export -------------------------------------------------
+// Writes a JSON trace in the Trace Event Format read by chrome://tracing and Perfetto, with a complete
+// event per frame from one present to the next on the main thread, and per audio mixer callback on the
+// audio thread, along with counters of its playing tracks and peak level. Callbacks are recorded by the
+// audio thread and written by the main thread after each present, so that no file I/O delays mixing.
+
+static FILE* traceFile = NULL;
+static uint64_t traceBegin = 0, tracePresent = 0;
+
+static double traceMicroseconds(uint64_t counter) {
+	return (double)(counter - traceBegin) * 1.0e6 / (double)SDL_GetPerformanceFrequency();
+}
+
+/// writes the audio callbacks recorded since the previous call
+static void traceAudio() {
+	static AudioCallbackRecord records[AUDIO_TRACE_MAX];
+	if(!audioDevice)
+		return;
+	SDL_LockAudioDevice(audioDevice);
+	audioTraced = true;
+	const uint32_t numRecords = audioNumTraced, numDropped = audioTraceDropped;
+	memcpy(records, audioTrace, numRecords * sizeof(AudioCallbackRecord));
+	audioNumTraced = audioTraceDropped = 0;
+	SDL_UnlockAudioDevice(audioDevice);
+
+	for(uint32_t i=0; i<numRecords; ++i) {
+		const AudioCallbackRecord* record = &records[i];
+		const double ts = traceMicroseconds(record->start);
+		fprintf(traceFile, ",\n{\"name\":\"audio mix\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.1f,\"dur\":%.1f}",
+			ts, traceMicroseconds(record->end) - ts);
+		fprintf(traceFile, ",\n{\"name\":\"audio\",\"ph\":\"C\",\"pid\":1,\"ts\":%.1f,\"args\":{\"voices\":%u,\"peak\":%.3f}}",
+			ts, record->voices, record->peak);
+		if(record->underrun)
+			fprintf(traceFile, ",\n{\"name\":\"audio underrun\",\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"tid\":2,\"ts\":%.1f}", ts);
+	}
+	if(numDropped)
+		fprintf(traceFile, ",\n{\"name\":\"audio records dropped\",\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"tid\":2,"
+			"\"ts\":%.1f,\"args\":{\"count\":%u}}", traceMicroseconds(SDL_GetPerformanceCounter()), numDropped);
+}
+
+/// records the frame ending with the present just done
+static void traceFramePresented() {
+	if(!traceFile)
+		return;
+	const uint64_t now = SDL_GetPerformanceCounter();
+	if(tracePresent)
+		fprintf(traceFile, ",\n{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f}",
+			traceMicroseconds(tracePresent), traceMicroseconds(now) - traceMicroseconds(tracePresent));
+	tracePresent = now;
+	traceAudio();
+}
+
+bool arcmTraceOpen(const char* fileName) {
+	arcmTraceClose();
+	traceFile = fopen(fileName, "w");
+	if(!traceFile)
+		return false;
+	traceBegin = SDL_GetPerformanceCounter();
+	tracePresent = 0;
+	fputs("{\"traceEvents\":[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}},\n"
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"audio\"}}", traceFile);
+	return true;
+}
+
+void arcmTraceClose() {
+	if(!traceFile)
+		return;
+	traceAudio();
+	if(audioDevice) {
+		SDL_LockAudioDevice(audioDevice);
+		audioTraced = false;
+		SDL_UnlockAudioDevice(audioDevice);
+	}
+	fputs("\n]}\n", traceFile);
+	fclose(traceFile);
+	traceFile = NULL;
+}
+
+//--- parallel startup ---------------------------------------------
+// Opening the audio device, setting up storage and caches below the preferences path, and reading the
+// script and its cached bytecode do not depend on the window. They run on worker threads while the host
+// opens the window and initializes graphics on the main thread, which owns the GL context. The VM is
+// created after joining on the main thread as well, as top-level script code may already load resources.
+// SDL's subsystem reference counts are not thread-safe, so the audio subsystem is initialized on the main
+// thread before the workers start. The SDL_InitSubSystem call of AudioOpen on the worker is skipped by
+// __wrap_SDL_InitSubSystem, linked by -Wl,--wrap=SDL_InitSubSystem, leaving it only to open the device.
+
+typedef struct {
+	const char* stage;
+	void (*run)();
+	SDL_Thread* thread;
+	double start, end;
+} StartupTask;
+
+static StartupTask startupTasks[3];
+static size_t startupNumTasks = 0;
+static const char* startupAppName = NULL;
+static char* startupStorageName = NULL;
+static char* startupScriptName = NULL;
+static const char* startupBytecodeFormat = NULL;
+static int startupAudioTracks = 8;
+static const char* startupScript = NULL;
+static char* startupScriptCopy = NULL;
+/// set while the audio subsystem initialized by arcmStartupBegin awaits the init call of AudioOpen
+static bool startupAudioInitialized = false;
+
+extern int __real_SDL_InitSubSystem(Uint32 flags);
+
+int __wrap_SDL_InitSubSystem(Uint32 flags) {
+	if(flags == SDL_INIT_AUDIO && startupAudioInitialized) {
+		startupAudioInitialized = false; // counted once, as if AudioOpen had initialized it itself
+		return 0;
+	}
+	return __real_SDL_InitSubSystem(flags);
+}
+
+static void startupAudio() {
+	AudioOpen(44100, startupAudioTracks);
+	AudioSetVolume(0.5);
+}
+
+static void startupStorage() {
+	arcmStorageInit(startupAppName, startupStorageName);
+	arcmSVGCacheInit(startupAppName);
+	arcmAudioCacheInit(startupAppName);
+}
+
+static void startupScriptRead() {
+	arcmBytecodeCacheInit(startupAppName);
+	// scripts shipped as bytecode only have no source
+	startupScript = arcmResourceText(startupScriptName, &startupScriptCopy);
+	if(startupBytecodeFormat)
+		arcmBytecodePrefetch(startupScriptName, startupScript, startupBytecodeFormat);
+}
+
+static int startupTaskRun(void* udata) {
+	StartupTask* task = (StartupTask*)udata;
+	task->start = startupTimestamp();
+	task->run();
+	task->end = startupTimestamp();
+	return 0;
+}
+
+static void startupTaskStart(const char* stage, void (*run)()) {
+	StartupTask* task = &startupTasks[startupNumTasks++];
+	task->stage = stage;
+	task->run = run;
+	task->thread = SDL_CreateThread(startupTaskRun, stage, task);
+	if(!task->thread) // runs synchronously instead
+		startupTaskRun(task);
+}
+
+static uint64_t inputClockOrigin; // see inputTimestamp(), input is timed from startup on
+
+void arcmStartupBegin(const char* appName, const char* storageName, const char* scriptName, const char* bytecodeFormat, int audioTracks) {
+	inputClockOrigin = SDL_GetPerformanceCounter();
+	startupAudioInitialized = SDL_InitSubSystem(SDL_INIT_AUDIO) == 0;
+	startupAppName = appName;
+	startupStorageName = strdup(storageName);
+	startupScriptName = scriptName ? strdup(scriptName) : NULL;
+	startupBytecodeFormat = bytecodeFormat;
+	startupAudioTracks = audioTracks;
+	const int bufferFrames = arcmManifestInt("audio_buffer", 0); // the manifest is opened by the host before
+	audioBufferFrames = bufferFrames < 64 ? 0 : bufferFrames > 8192 ? 8192 : (uint16_t)bufferFrames;
+	startupTaskStart("audio open", startupAudio);
+	startupTaskStart("storage init", startupStorage);
+	if(scriptName)
+		startupTaskStart("script read", startupScriptRead);
+}
+
+const char* arcmStartupJoin(char** copy) {
+	for(size_t i=0; i<startupNumTasks; ++i) {
+		StartupTask* task = &startupTasks[i];
+		if(task->thread)
+			SDL_WaitThread(task->thread, NULL);
+		if(startupProfile)
+			startupRecord(task->stage, task->start, task->end, false);
+	}
+	startupNumTasks = 0;
+	arcmStartupStage("startup tasks joined");
+	free(startupStorageName);
+	free(startupScriptName);
+	startupStorageName = startupScriptName = NULL;
+	const char* script = startupScript;
+	if(copy)
+		*copy = startupScriptCopy;
+	else
+		free(startupScriptCopy);
+	startupScript = NULL;
+	startupScriptCopy = NULL;
+	return script;
+}
+
 //--- Resource -----------------------------------------------------
 uint32_t arcmResourceGetImage(const char* name, float scale, float centerX, float centerY, int filtering) {
 	//fprintf(stderr, "arcmResourceGetImage(%s, %f, %f, %f, %d)", name, scale, centerX, centerY, filtering);
-    uint32_t handle = ResourceGetImage(name, scale, filtering);
-    gfxImageSetCenter(handle, centerX, centerY);
-    return handle;
+	uint32_t handle = arcmManifestPreloaded(name, scale, centerX, centerY, filtering);
+	if(handle)
+		return handle;
+	const double start = startupProfile ? startupTimestamp() : 0.0;
+	if(strcmp(ResourceSuffix(name), "svg")==0) { // rasterizations are cached by content
+		char* copy;
+		const char* svg = arcmResourceText(name, &copy);
+		handle = svg ? arcmSVGCacheImage(svg, scale, centerX, centerY, filtering) : 0;
+		free(copy);
+	}
+	else {
+		handle = arcmResourceLoadMapped(name, scale, centerX, centerY, filtering);
+		if(!handle && !arcmArchivePacked()) {
+			arcmResourceArchiveLock(true);
+			handle = ResourceGetImage(name, scale, filtering);
+			arcmResourceArchiveLock(false);
+			gfxImageSetCenter(handle, centerX, centerY);
+		}
+	}
+	startupResource(name, start);
+	return handle;
+}
+
+uint32_t arcmResourceGetAudio(const char* name) {
+	uint32_t handle = arcmManifestPreloaded(name, 0.0f, 0.0f, 0.0f, 0);
+	if(handle)
+		return handle;
+	const double start = startupProfile ? startupTimestamp() : 0.0;
+	handle = arcmResourceLoadMapped(name, 0.0f, 0.0f, 0.0f, 0);
+	if(!handle && !arcmArchivePacked()) {
+		arcmResourceArchiveLock(true);
+		handle = ResourceGetAudio(name);
+		arcmResourceArchiveLock(false);
+	}
+	startupResource(name, start);
+	return handle;
+}
+
+uint32_t arcmResourceGetFont(const char* name, unsigned fontSize) {
+	uint32_t handle = arcmManifestPreloaded(name, (float)fontSize, 0.0f, 0.0f, 0);
+	if(handle)
+		return handle;
+	const double start = startupProfile ? startupTimestamp() : 0.0;
+	handle = arcmResourceLoadMapped(name, (float)fontSize, 0.0f, 0.0f, 0);
+	if(!handle && !arcmArchivePacked()) {
+		arcmResourceArchiveLock(true);
+		handle = ResourceGetFont(name, fontSize);
+		arcmResourceArchiveLock(false);
+	}
+	startupResource(name, start);
+	return handle;
+}
+
+char* arcmResourceGetText(const char* name) {
+	size_t size;
+	arcmResourceArchiveLock(true);
+	const char* view = (const char*)arcmArchiveView(name, &size);
+	char* text = view ? (char*)malloc(size+1) : (char*)arcmArchiveRead(name, NULL);
+	if(view)
+		memcpy(text, view, size+1);
+	else if(!text && !arcmArchivePacked())
+		text = ResourceGetText(name);
+	arcmResourceArchiveLock(false);
+	return text;
+}
+
+const char* arcmResourceText(const char* name, char** copy) {
+	arcmResourceArchiveLock(true);
+	const char* text = (const char*)arcmArchiveView(name, NULL);
+	*copy = text ? NULL : (char*)arcmArchiveRead(name, NULL);
+	if(!text && !*copy && !arcmArchivePacked())
+		*copy = ResourceGetText(name);
+	arcmResourceArchiveLock(false);
+	return text ? text : *copy;
+}
+
+const void* arcmResourceBinary(const char* name, size_t* numBytes, void** copy) {
+	arcmResourceArchiveLock(true);
+	const void* data = arcmArchiveView(name, numBytes);
+	*copy = data ? NULL : arcmArchiveRead(name, numBytes);
+	if(!data && !*copy && !arcmArchivePacked())
+		*copy = ResourceGetBinary(name, numBytes);
+	arcmResourceArchiveLock(false);
+	return data ? data : *copy;
 }
 
 uint32_t arcmResourceCreateImage(const uint8_t* data, int width, int height, float centerX, float centerY, int filtering) {
@@ -49,9 +879,7 @@ uint32_t arcmResourceCreateImage(const uint8_t* data, int width, int height, flo
 }
 
 uint32_t arcmResourceCreateSVGImage(const char* svg, float scale, float centerX, float centerY) {
-	uint32_t handle = ResourceCreateSVGImage(svg, scale);
-    gfxImageSetCenter(handle, centerX, centerY);
-    return handle;
+	return arcmSVGCacheImage(svg, scale, centerX, centerY, -1);
 }
 
 uint32_t arcmResourceGetTileImage(uint32_t parent, int x, int y, int w, int h, float cx, float cy) {
@@ -106,103 +934,265 @@ float arcmQueryFont(uint32_t font, const char* property, const char* str) {
 	return NAN;
 }
 
-//--- Storage ------------------------------------------------------
-static char * storageFileName = NULL;
-static Value* storageData = NULL;
+//--- event handling -----------------------------------------------
+void dispatchAxisEvent(size_t id, uint8_t axis, float value, double timestamp, void* callback);
+void dispatchButtonEvent(size_t id, uint8_t button, float value, double timestamp, void* callback);
+bool dispatchInputBatch(const double* events, size_t numEvents, void* callback);
 
-static bool StorageLoad() {
-	if(!storageData) {
-		FILE* f = fopen(storageFileName, "r");
-		if (!f)
-			return false;
-		// Seek to end to find size
-		fseek(f, 0, SEEK_END);
-		const long length = ftell(f);
-		rewind(f);
-
-		// Allocate memory (+1 for null terminator)
-		char *buffer = (char *)malloc(length + 1);
-		if (!buffer) {
-			fprintf(stderr, "Memory allocation failed\n");
-			fclose(f);
-			return false;
+/// input event as collected during one arcmDispatchInputEvents() call
+typedef struct {
+	double timestamp;
+	float value;
+	uint16_t device;
+	uint8_t type;
+	uint8_t id;
+} InputEvent;
+
+#define INPUT_QUEUE_CAPACITY 256
+static InputEvent inputQueue[INPUT_QUEUE_CAPACITY];
+static size_t inputQueueSize = 0;
+/// marks a queued axis event superseded by a later one of the same frame
+#define INPUT_COALESCED 0xff
+
+#define INPUT_MAX_DEVICES 16
+/// controllers supported by WindowControllerOpen, keyboard devices follow the connected ones
+#define INPUT_MAX_CONTROLLERS 8
+#define INPUT_MAX_AXES 16
+
+/// current state per device, see arcmWindowInputState()
+typedef struct {
+	uint32_t buttons, pressed, released;
+	float axes[INPUT_MAX_AXES];
+	uint8_t numAxes;
+} InputState;
+static InputState inputState[INPUT_MAX_DEVICES];
+
+// axis filtering, see arcmWindowAxisFilter()
+static float axisResolution = 0.1f, axisDeadzone = 0.0f;
+static uint64_t axisEventsCoalesced = 0;
+/// last value handed to the VM per device and axis
+static float axisLast[INPUT_MAX_DEVICES][INPUT_MAX_AXES];
+/// index+1 of a queued event not yet handed to the VM per device and axis, 0 if none
+static uint16_t axisPending[INPUT_MAX_DEVICES][INPUT_MAX_AXES];
+
+// input-to-present latency of events handed to the VM since the last present
+static double latencyTimestampSum = 0.0, latencyTimestampMin = 0.0;
+static size_t latencyNumEvents = 0;
+static double inputLatency = NAN, inputLatencyMax = NAN;
+
+// late latching, see arcmWindowLateLatch()
+static int lateLatchMode = 0;
+static double presentTimestamp = 0.0, framePeriod = 0.0, latchDelay = 0.0;
+/// set while the host latches input before the next update, so that polling after present can be skipped
+static bool latchPending = false;
+
+/// performance counter value at startup, input timestamps handed to scripts count seconds since then
+static uint64_t inputClockOrigin = 0;
+
+static double inputTimestamp() {
+	const uint64_t t = SDL_GetPerformanceCounter();
+	if(!inputClockOrigin) // hosts not calling arcmStartupBegin()
+		inputClockOrigin = t;
+	return (double)(t - inputClockOrigin) / (double)SDL_GetPerformanceFrequency();
+}
+
+/// hands all queued events to the VM, in a single call if it defines an inputBatch handler
+static void inputQueueFlush(void* callback) {
+	static double packed[INPUT_QUEUE_CAPACITY * ARCM_INPUT_EVENT_STRIDE];
+	size_t numEvents = 0;
+	for(size_t i=0; i<inputQueueSize; ++i) {
+		const InputEvent* queued = &inputQueue[i];
+		if(queued->type == INPUT_COALESCED)
+			continue;
+		if(queued->type == ARCM_INPUT_AXIS && queued->device < INPUT_MAX_DEVICES && queued->id < INPUT_MAX_AXES) {
+			axisLast[queued->device][queued->id] = queued->value;
+			axisPending[queued->device][queued->id] = 0;
 		}
-		// Read file into buffer
-		const size_t read = fread(buffer, 1, length, f);
-		buffer[read] = '\0';
+		if(!latencyNumEvents++ || queued->timestamp < latencyTimestampMin)
+			latencyTimestampMin = queued->timestamp;
+		latencyTimestampSum += queued->timestamp;
 
-		fclose(f);
-		storageData = Value_parse(buffer);
-		free(buffer);
+		double* evt = &packed[numEvents++ * ARCM_INPUT_EVENT_STRIDE];
+		evt[0] = queued->type;
+		evt[1] = queued->device;
+		evt[2] = queued->id;
+		evt[3] = queued->value;
+		evt[4] = queued->timestamp;
+	}
+	inputQueueSize = 0;
+	if(!numEvents)
+		return;
+	if(dispatchInputBatch(packed, numEvents, callback))
+		return;
+	for(size_t i=0; i<numEvents; ++i) {
+		const double* evt = &packed[i * ARCM_INPUT_EVENT_STRIDE];
+		if(evt[0] == ARCM_INPUT_AXIS)
+			dispatchAxisEvent((size_t)evt[1], (uint8_t)evt[2], (float)evt[3], evt[4], callback);
+		else
+			dispatchButtonEvent((size_t)evt[1], (uint8_t)evt[2], (float)evt[3], evt[4], callback);
 	}
-	return storageData ? true : false;
 }
 
-static bool StorageSave() {
-	FILE* f = fopen(storageFileName, "w");
-	if (!f) {
-		fprintf(stderr, "localStorage file not writable\n");
-		return false;
+static void queueInputEvent(uint8_t type, size_t device, uint8_t id, float value, void* callback) {
+	if(inputQueueSize == INPUT_QUEUE_CAPACITY)
+		inputQueueFlush(callback);
+	InputEvent* evt = &inputQueue[inputQueueSize++];
+	evt->timestamp = inputTimestamp();
+	evt->value = value;
+	evt->device = (uint16_t)device;
+	evt->type = type;
+	evt->id = id;
+}
+
+/// applies the deadzone and keeps only the latest value per device and axis within a frame
+static void queueAxisEvent(size_t id, uint8_t axis, float value, void* callback) {
+	if(axisDeadzone > 0.0f) // rescale the remaining range to keep the response continuous
+		value = fabsf(value) <= axisDeadzone ? 0.0f
+			: (value - copysignf(axisDeadzone, value)) / (1.0f - axisDeadzone);
+	if(id >= INPUT_MAX_DEVICES || axis >= INPUT_MAX_AXES) {
+		queueInputEvent(ARCM_INPUT_AXIS, id, axis, value, callback);
+		return;
+	}
+	InputState* state = &inputState[id];
+	state->axes[axis] = value;
+	if(axis >= state->numAxes)
+		state->numAxes = axis + 1;
+
+	uint16_t* pending = &axisPending[id][axis];
+	if(*pending) {
+		inputQueue[*pending - 1].type = INPUT_COALESCED;
+		*pending = 0;
+		++axisEventsCoalesced;
+	}
+	if(value == axisLast[id][axis]) { // back where the VM last saw it, or within the deadzone
+		++axisEventsCoalesced;
+		return;
+	}
+	queueInputEvent(ARCM_INPUT_AXIS, id, axis, value, callback);
+	*pending = (uint16_t)inputQueueSize;
+}
+
+void arcmWindowAxisFilter(float resolution, float deadzone) {
+	axisResolution = resolution > 0.0f ? resolution : 0.0f;
+	axisDeadzone = deadzone < 0.0f ? 0.0f : deadzone < 1.0f ? deadzone : 0.99f;
+}
+
+static void queueButtonEvent(size_t id, uint8_t button, float value, void* callback) {
+	if(id < INPUT_MAX_DEVICES && button < 32) {
+		InputState* state = &inputState[id];
+		const uint32_t mask = 1u << button;
+		if(value != 0.0f) {
+			if(!(state->buttons & mask))
+				state->pressed |= mask;
+			state->buttons |= mask;
+		}
+		else {
+			if(state->buttons & mask)
+				state->released |= mask;
+			state->buttons &= ~mask;
+		}
+		// close window if both buttons 6+7 (escape+tab) are pressed:
+		if((state->buttons & (1u << 6)) && (state->buttons & (1u << 7)))
+			WindowEmitClose();
 	}
-	if(storageData)
-		Value_print(storageData, f);
-	return fclose(f) == 0;
+	queueInputEvent(ARCM_INPUT_BUTTON, id, button, value, callback);
 }
 
-void arcmStorageInit(const char* appName, const char* scriptBaseName) {
-	const char* storagePath = SDL_GetPrefPath(appName, "arcaqjs");
-	storageFileName = (char*)malloc(strlen(storagePath)+strlen(scriptBaseName)+6);
-	storageFileName[0]=0;
-	strcat(strcat(strcat(storageFileName, storagePath), scriptBaseName),".json");
-	SDL_free((void*)storagePath);
-	StorageLoad();
+int arcmWindowInputState(size_t device, uint32_t* buttons, float* axes, int maxAxes) {
+	if(device >= INPUT_MAX_DEVICES) {
+		*buttons = 0;
+		return 0;
+	}
+	const InputState* state = &inputState[device];
+	*buttons = state->buttons;
+	const int numAxes = state->numAxes < maxAxes ? state->numAxes : maxAxes;
+	memcpy(axes, state->axes, numAxes * sizeof(float));
+	return numAxes;
 }
-void arcmStorageClose() {
-	free(storageFileName);
-	free(storageData);
+
+bool arcmWindowPressed(size_t device, uint8_t button) {
+	return device < INPUT_MAX_DEVICES && button < 32 && (inputState[device].pressed & (1u << button));
 }
 
-const char* arcmResourceGetStorageItem(const char* key) {
-	return !storageData ? NULL : Value_gets(storageData, key, NULL);
+bool arcmWindowReleased(size_t device, uint8_t button) {
+	return device < INPUT_MAX_DEVICES && button < 32 && (inputState[device].released & (1u << button));
 }
 
-void arcmResourceSetStorageItem(const char* key, const char* value) {
-	if(!storageData && !StorageLoad())
-		storageData = Value_new(VALUE_MAP, NULL);
-	Value_sets(storageData, key, value);
-	StorageSave();
+/// measures the latency of all inputs that have been handed to the VM before this present
+/// and adapts the late latching delay to the observed frame period
+static void inputFramePresented() {
+	const double now = inputTimestamp();
+	if(latencyNumEvents) {
+		inputLatency = now - latencyTimestampSum / latencyNumEvents;
+		if(isnan(inputLatencyMax) || now - latencyTimestampMin > inputLatencyMax)
+			inputLatencyMax = now - latencyTimestampMin;
+		latencyTimestampSum = 0.0;
+		latencyNumEvents = 0;
+	}
+	for(size_t i=0; i<INPUT_MAX_DEVICES; ++i)
+		inputState[i].pressed = inputState[i].released = 0;
+
+	if(presentTimestamp > 0.0) {
+		const double interval = now - presentTimestamp;
+		if(framePeriod <= 0.0)
+			framePeriod = interval;
+		const bool onTime = interval < 1.5 * framePeriod;
+		// moving average, also following a lasting change of the frame rate, single stalls are capped
+		framePeriod = 0.95 * framePeriod + 0.05 * (interval < 4.0 * framePeriod ? interval : 4.0 * framePeriod);
+		// creep towards vsync while frames are on time, back off quickly if one was missed
+		if(!onTime)
+			latchDelay *= 0.5;
+		else if(lateLatchMode > 1 && latchDelay < 0.75 * framePeriod)
+			latchDelay += 0.0005;
+		if(latchDelay > 0.75 * framePeriod)
+			latchDelay = 0.75 * framePeriod;
+	}
+	presentTimestamp = now;
 }
 
-//--- event handling -----------------------------------------------
-void dispatchAxisEvent(size_t id, uint8_t axis, float value, void* callback);
-void dispatchButtonEvent(size_t id, uint8_t button, float value, void* callback);
+/// hands queued events to the VM and forgets the state of all devices, as device ids shift
+/// when a controller is connected or disconnected
+static void inputDevicesChanged(void* callback) {
+	inputQueueFlush(callback);
+	memset(inputState, 0, sizeof(inputState));
+	memset(axisLast, 0, sizeof(axisLast));
+	memset(axisPending, 0, sizeof(axisPending));
+}
 
-int arcmDispatchInputEvents(void* callback) {
+/// closes all controllers and opens those still connected, at their current device index
+static void controllersReopen() {
+	for(size_t i=0; i<INPUT_MAX_CONTROLLERS; ++i)
+		WindowControllerClose(i);
+	for(size_t i=0; i<WindowNumControllers(); ++i)
+		WindowControllerOpen(i, 0);
+}
+
+static int pollInputEvents(void* callback) {
 	const size_t numControllers = WindowNumControllers();
 	SDL_Event evt;
 	while( SDL_PollEvent( &evt )) switch(evt.type) {
 		case SDL_KEYDOWN:
 			if(!evt.key.repeat) switch(evt.key.keysym.sym) {
-				case SDLK_LEFT: dispatchAxisEvent(numControllers+0, 0, -1.0f, callback); break;
-				case SDLK_RIGHT: dispatchAxisEvent(numControllers+0, 0, +1.0f, callback); break;
-				case SDLK_UP: dispatchAxisEvent(numControllers+0, 1, -1.0f, callback); break;
-				case SDLK_DOWN: dispatchAxisEvent(numControllers+0, 1, 1.0f, callback); break;
+				case SDLK_LEFT: queueAxisEvent(numControllers+0, 0, -1.0f, callback); break;
+				case SDLK_RIGHT: queueAxisEvent(numControllers+0, 0, +1.0f, callback); break;
+				case SDLK_UP: queueAxisEvent(numControllers+0, 1, -1.0f, callback); break;
+				case SDLK_DOWN: queueAxisEvent(numControllers+0, 1, 1.0f, callback); break;
 				case ' ':
-				case SDLK_RETURN: dispatchButtonEvent(numControllers+0, 0, 1.0f, callback); break;
-				case SDLK_BACKSPACE: dispatchButtonEvent(numControllers+0, 1, 1.0f, callback); break;
-				case SDLK_RALT: dispatchButtonEvent(numControllers+0, 2, 1.0f, callback); break;
-				case SDLK_RCTRL: dispatchButtonEvent(numControllers+0, 3, 1.0f, callback); break;
-				case SDLK_TAB: dispatchButtonEvent(numControllers+0, 6, 1.0f, callback); break;
-				case SDLK_ESCAPE: dispatchButtonEvent(numControllers+0, 7, 1.0f, callback); break;
-
-				case 'a': dispatchAxisEvent(numControllers+1, 0, -1.0f, callback); break;
-				case 'd': dispatchAxisEvent(numControllers+1, 0, 1.0f, callback); break;
-				case 'w': dispatchAxisEvent(numControllers+1, 1, -1.0f, callback); break;
-				case 's': dispatchAxisEvent(numControllers+1, 1, 1.0f, callback); break;
-				case '1': dispatchButtonEvent(numControllers+1, 0, 1.0f, callback); break;
-				case '2': dispatchButtonEvent(numControllers+1, 1, 1.0f, callback); break;
-				case '3': dispatchButtonEvent(numControllers+1, 2, 1.0f, callback); break;
-				case '4': dispatchButtonEvent(numControllers+1, 3, 1.0f, callback); break;
+				case SDLK_RETURN: queueButtonEvent(numControllers+0, 0, 1.0f, callback); break;
+				case SDLK_BACKSPACE: queueButtonEvent(numControllers+0, 1, 1.0f, callback); break;
+				case SDLK_RALT: queueButtonEvent(numControllers+0, 2, 1.0f, callback); break;
+				case SDLK_RCTRL: queueButtonEvent(numControllers+0, 3, 1.0f, callback); break;
+				case SDLK_TAB: queueButtonEvent(numControllers+0, 6, 1.0f, callback); break;
+				case SDLK_ESCAPE: queueButtonEvent(numControllers+0, 7, 1.0f, callback); break;
+
+				case 'a': queueAxisEvent(numControllers+1, 0, -1.0f, callback); break;
+				case 'd': queueAxisEvent(numControllers+1, 0, 1.0f, callback); break;
+				case 'w': queueAxisEvent(numControllers+1, 1, -1.0f, callback); break;
+				case 's': queueAxisEvent(numControllers+1, 1, 1.0f, callback); break;
+				case '1': queueButtonEvent(numControllers+1, 0, 1.0f, callback); break;
+				case '2': queueButtonEvent(numControllers+1, 1, 1.0f, callback); break;
+				case '3': queueButtonEvent(numControllers+1, 2, 1.0f, callback); break;
+				case '4': queueButtonEvent(numControllers+1, 3, 1.0f, callback); break;
 
 				case SDLK_VOLUMEUP: arcmAudioDeltaVolume(+0.1f); break;
 				case SDLK_VOLUMEDOWN: arcmAudioDeltaVolume(-0.1f); break;
@@ -211,46 +1201,88 @@ int arcmDispatchInputEvents(void* callback) {
 		case SDL_KEYUP: {
 				if(evt.type == SDL_KEYUP) switch(evt.key.keysym.sym) {
 				case SDLK_LEFT:
-				case SDLK_RIGHT: dispatchAxisEvent(numControllers+0, 0, 0.0f, callback); break;
+				case SDLK_RIGHT: queueAxisEvent(numControllers+0, 0, 0.0f, callback); break;
 				case SDLK_UP:
-				case SDLK_DOWN: dispatchAxisEvent(numControllers+0, 1, 0.0f, callback); break;
-				case SDLK_RETURN: dispatchButtonEvent(numControllers+0, 0, 0.0f, callback); break;
-				case SDLK_BACKSPACE: dispatchButtonEvent(numControllers+0, 1, 0.0f, callback); break;
-				case SDLK_RALT: dispatchButtonEvent(numControllers+0, 2, 0.0f, callback); break;
-				case SDLK_RCTRL: dispatchButtonEvent(numControllers+0, 3, 0.0f, callback); break;
-				case SDLK_TAB: dispatchButtonEvent(numControllers+0, 6, 0.0f, callback); break;
-				case SDLK_ESCAPE: dispatchButtonEvent(numControllers+0, 7, 0.0f, callback); break;
+				case SDLK_DOWN: queueAxisEvent(numControllers+0, 1, 0.0f, callback); break;
+				case SDLK_RETURN: queueButtonEvent(numControllers+0, 0, 0.0f, callback); break;
+				case SDLK_BACKSPACE: queueButtonEvent(numControllers+0, 1, 0.0f, callback); break;
+				case SDLK_RALT: queueButtonEvent(numControllers+0, 2, 0.0f, callback); break;
+				case SDLK_RCTRL: queueButtonEvent(numControllers+0, 3, 0.0f, callback); break;
+				case SDLK_TAB: queueButtonEvent(numControllers+0, 6, 0.0f, callback); break;
+				case SDLK_ESCAPE: queueButtonEvent(numControllers+0, 7, 0.0f, callback); break;
 
 				case 'a':
-				case 'd': dispatchAxisEvent(numControllers+1, 0, 0.0f, callback); break;
+				case 'd': queueAxisEvent(numControllers+1, 0, 0.0f, callback); break;
 				case 'w':
-				case 's': dispatchAxisEvent(numControllers+1, 1, 0.0f, callback); break;
-				case '1': dispatchButtonEvent(numControllers+1, 0, 0.0f, callback); break;
-				case '2': dispatchButtonEvent(numControllers+1, 1, 0.0f, callback); break;
-				case '3': dispatchButtonEvent(numControllers+1, 2, 0.0f, callback); break;
-				case '4': dispatchButtonEvent(numControllers+1, 3, 0.0f, callback); break;
+				case 's': queueAxisEvent(numControllers+1, 1, 0.0f, callback); break;
+				case '1': queueButtonEvent(numControllers+1, 0, 0.0f, callback); break;
+				case '2': queueButtonEvent(numControllers+1, 1, 0.0f, callback); break;
+				case '3': queueButtonEvent(numControllers+1, 2, 0.0f, callback); break;
+				case '4': queueButtonEvent(numControllers+1, 3, 0.0f, callback); break;
 			}
 			break;
 		}
+		// WindowNumControllers() initializes the joystick subsystem on first use, which then announces
+		// connected controllers as added devices, so that they are opened only if input is polled at all
+		case SDL_JOYDEVICEADDED:
+			inputDevicesChanged(callback);
+			WindowControllerOpen(evt.jdevice.which, 0);
+			break;
+		case SDL_JOYDEVICEREMOVED: // remaining controllers are renumbered
+			inputDevicesChanged(callback);
+			controllersReopen();
+			break;
 		case SDL_QUIT:
 			return 1;
 	}
-	WindowControllerEvents(0.1, callback, dispatchAxisEvent, dispatchButtonEvent);
+	WindowControllerEvents(axisResolution, callback, queueAxisEvent, queueButtonEvent);
+	inputQueueFlush(callback);
 	return 0;
 }
 
-void arcmWindowCloseOnButton67(size_t id, uint8_t button, float value) {
-	static uint16_t btnState[8] = {0};
-	if(id<8 && button<16) {
-		const uint16_t mask = (1 << button);
-		if(value != 0.0f)
-			btnState[id] |= mask;
-		else
-			btnState[id] &= ~mask;
-		// close window if both buttons 6+7 (escape+tab) are pressed:
-		if(btnState[id] & (1 << 6) && btnState[id] & (1 << 7))
-			WindowEmitClose();
+int arcmDispatchInputEvents(void* callback) {
+	// registered as event handler, WindowUpdate() calls it right after presenting a frame
+	inputFramePresented();
+	traceFramePresented();
+	if(lateLatchMode > 1 && latchPending) { // polled at the latch deadline instead
+		latchPending = false;
+		return 0;
 	}
+	return pollInputEvents(callback);
+}
+
+void arcmWindowLateLatch(int mode) {
+	lateLatchMode = mode;
+	latchDelay = 0.0;
+	latchPending = false;
+}
+
+bool arcmWindowLatchInput(void* callback) {
+	if(!lateLatchMode)
+		return true;
+	if(lateLatchMode > 1) {
+		const double wait = presentTimestamp + latchDelay - inputTimestamp();
+		if(wait > 0.0)
+			WindowSleep(wait);
+		latchPending = true;
+	}
+	return pollInputEvents(callback) == 0;
+}
+
+double arcmWindowStats(const char* name) {
+	if(!strcmp(name, "inputCoalesced"))
+		return (double)axisEventsCoalesced;
+	if(!strcmp(name, "inputLatency"))
+		return inputLatency;
+	if(!strcmp(name, "inputLatencyMax"))
+		return inputLatencyMax;
+	if(!strcmp(name, "latchDelay"))
+		return latchDelay;
+	if(!strncmp(name, "archive", 7))
+		return arcmArchiveStats(name);
+	if(!strncmp(name, "audio", 5))
+		return arcmAudioStats(name);
+	return arcmStorageStats(name);
 }
 
 void arcmShowError(const char* msg) {
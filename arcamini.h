@@ -2,6 +2,7 @@
 /// arcajs minimal subset C API
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 ///@{ \module window
 /// sets window title
@@ -13,6 +14,28 @@ extern int WindowHeight();
 /// sets clear color
 /** exposed as window.color(color) */
 extern void WindowClearColor(uint32_t color);
+/// configures filtering of analog axis events
+/** Only axis changes beyond resolution are reported, values within deadzone around the center are reported as 0.0.
+ * Within a frame, only the latest value per device and axis is kept.
+ * exposed as window.axisFilter(resolution=0.1, deadzone=0.0) */
+extern void arcmWindowAxisFilter(float resolution, float deadzone);
+/// returns the current button bitmask and up to maxAxes axis values of an input device
+/** @return number of axis values written to axes
+ * exposed as window.inputState(device) returning a packed array of the button bitmask followed by the axis values */
+extern int arcmWindowInputState(size_t device, uint32_t* buttons, float* axes, int maxAxes);
+/// returns true if a button of an input device has been pressed since the last frame
+/** exposed as window.pressed(device, button) */
+extern bool arcmWindowPressed(size_t device, uint8_t button);
+/// returns true if a button of an input device has been released since the last frame
+/** exposed as window.released(device, button) */
+extern bool arcmWindowReleased(size_t device, uint8_t button);
+/// queries runtime statistics. Returns NaN if name is not a known statistic or has not been measured yet
+/** exposed as window.stats(name) with name being one of
+ * 'inputCoalesced' - the number of axis events dropped by axis filtering,
+ * 'inputLatency' - mean time in seconds from polling the inputs of the latest frame to presenting it,
+ * 'inputLatencyMax' - maximum input latency in seconds,
+ * 'latchDelay' - time in seconds the current late latching waits after a present */
+extern double arcmWindowStats(const char* name);
 ///@}
 
 ///@{ \module gfx
@@ -43,12 +66,30 @@ extern void gfxFillTextAlign(uint32_t font, float x, float y, const char* str, i
 ///@}
 
 ///@{ \module audio
-/// immediately plays previously uploaded sample data
+/// immediately plays previously uploaded sample data, stealing a track of lower or equal priority if all are busy
 /** \note For stereo samples, detune and balance must be 0.0f
+ * exposed as audio.replay(sample[, volume=1.0, balance=0.0, detune=0.0, priority=0])
  * \return track number playing this sound or UINT_MAX if the input is invalid or no track is available */
-extern uint32_t AudioReplay(uint32_t sample, float volume, float balance, float detune);
+extern uint32_t arcmAudioReplay(uint32_t sample, float volume, float balance, float detune, int priority);
 /// sets the volume level of a currently playing track
 extern void arcmAudioVolume(uint32_t track, float volume, float fadeTime);
+/// plays an MP3 or WAV file of the resource archive while decoding it in the background
+/** exposed as audio.stream(name[, volume=1.0, loop=false])
+ * \return track number playing the stream, to be controlled by arcmAudioVolume, or UINT_MAX in case of error */
+extern uint32_t arcmAudioStream(const char* name, float volume, bool loop);
+/// returns the audio clock, the time in seconds of audio mixed since the device was opened
+/** exposed as audio.time() */
+extern double arcmAudioTime();
+/// plays previously uploaded sample data at an exact time of the audio clock, or immediately if that time has passed
+/** exposed as audio.replayAt(sample, when[, volume=1.0, balance=0.0, detune=0.0])
+ * \return false if the input is invalid or too many replays are pending */
+extern bool arcmAudioReplayAt(uint32_t sample, double when, float volume, float balance, float detune);
+/// returns the size of the mixer buffer in frames, configured by audio_buffer in manifest.json
+/** exposed as audio.bufferSize() */
+extern uint32_t arcmAudioBufferSize();
+/// returns the latency in seconds added by the mixer buffer
+/** exposed as audio.latency() */
+extern double arcmAudioLatency();
 ///@}
 
 ///@{ \module resource
@@ -68,12 +109,14 @@ extern uint32_t arcmResourceGetTileImage(uint32_t parent, int x, int y, int w, i
  * exposed as resource.imageTileGrid(parent, tilesX[, tilesY=1, border=0]) */
 extern uint32_t gfxImageTileGrid(uint32_t parent, uint16_t tilesX, uint16_t tilesY, uint16_t border);
 /// returns handle to an audio resource
-extern size_t ResourceGetAudio(const char* name);
+/** exposed as resource.getAudio(name) */
+extern uint32_t arcmResourceGetAudio(const char* name);
 /// uploads mono or stereo PCM wave data and returns a handle for later playback
 /** exposed as resource.createAudio(waveData[, numChannels=1]) */
 extern uint32_t AudioUploadPCM(float* waveData, uint32_t numSamples, uint8_t numChannels, uint32_t offset);
 /// returns handle to a font resource
-extern size_t ResourceGetFont(const char* name, unsigned fontSize);
+/** exposed as resource.getFont(name[, fontSize=16]) */
+extern uint32_t arcmResourceGetFont(const char* name, unsigned fontSize);
 /// queries the width or height of an image, in pixels. Returns 0 if the image handle is invalid
 /** exposed as resource.queryImage(image, property) with property either 'width' or 'height' */
 extern uint32_t arcmQueryImage(uint32_t image, const char* property);
@@ -85,17 +128,279 @@ extern uint32_t arcmQueryAudio(uint32_t sample, const char* property);
 extern float arcmQueryFont(uint32_t font, const char* property, const char* str);
 /// returns pointer to a storage item value identified by a key
 extern const char* arcmResourceGetStorageItem(const char* key);
-/// sets a key-value pair storage item 
+/// sets a key-value pair storage item, or removes it if value is NULL.
+/// Changes are written to disk asynchronously shortly after.
 extern void arcmResourceSetStorageItem(const char* key, const char* value);
+/// returns pointer to a string or binary storage item value identified by a key, or NULL if it does not exist
+/// @param size      receives the value size in bytes, may be NULL
+/// @param isBinary  receives whether the value has been stored as binary data, may be NULL
+extern const void* arcmResourceGetStorageValue(const char* key, size_t* size, bool* isBinary);
+/// sets a string or binary storage item, or removes it if value is NULL
+extern void arcmResourceSetStorageValue(const char* key, const void* value, size_t size, bool isBinary);
+/// writes pending storage changes to disk and waits for completion
+/// @return false if the storage file could not be written
+extern bool arcmResourceFlushStorage();
+/// loads images and packs them into shared textures, so that drawing them does not require texture switches
+/** @param handles receives numNames image handles, 0 for images that could not be loaded
+    @return number of atlas textures created
+    exposed as resource.createAtlas(names[, scale=1.0, centerX=0.0, centerY=0.0, filtering=1]) */
+extern size_t arcmResourceCreateAtlas(const char** names, size_t numNames, float scale,
+	float centerX, float centerY, int filtering, uint32_t* handles);
+/// starts loading an image, audio sample, or font in the background, the type is inferred from the file name
+/** @param param scale for SVG images, font size for fonts, 0 selects the default
+    @return handle of the pending load, or 0 if the resource type is not supported
+    exposed as resource.loadAsync(name[, param, centerX=0.0, centerY=0.0, filtering=1]) and
+    resource.load(names[, onProgress]) */
+extern uint32_t arcmResourceLoadAsync(const char* name, float param, float centerX, float centerY, int filtering);
+/// queries whether a pending load has completed
+/** @param handle receives the resource handle of a completed load, or 0 if loading failed
+    exposed as resource.loaded(pending) */
+extern bool arcmResourceLoaded(uint32_t pending, uint32_t* handle);
+/// returns the fraction of completed loads since the loader was idle the last time, 1.0 if idle
+/** exposed as resource.loadProgress() */
+extern float arcmResourceLoadProgress();
 
 ///@}
 
+///@{ input events as handed to an inputBatch(events) handler
+/// input event types
+enum { ARCM_INPUT_AXIS = 0, ARCM_INPUT_BUTTON = 1 };
+/// number of values per event handed to an inputBatch(events) handler:
+/// type, device, id, value, and timestamp. Timestamps count seconds since arcmStartupBegin() on the
+/// SDL performance counter, they are unrelated to the deltaT of update().
+#define ARCM_INPUT_EVENT_STRIDE 5
+///@}
+
+///@{ typed buffers, exposed to Lua and Python scripts as buffer objects
+/// buffer element types
+typedef enum { ARCM_BUFFER_FLOAT32 = 0, ARCM_BUFFER_UINT32 = 1, ARCM_BUFFER_UINT8 = 2 } ArcmBufferType;
+/// element-wise buffer operations, see arcmBufferApply
+typedef enum { ARCM_BUFFER_ADD, ARCM_BUFFER_MUL, ARCM_BUFFER_MIN, ARCM_BUFFER_MAX } ArcmBufferOp;
+/// buffer header, directly followed by its elements in memory allocated by the VM
+typedef struct { uint32_t type, count; } ArcmBuffer;
+/// returns a pointer to the first element of a buffer
+#define arcmBufferData(buf) ((void*)((ArcmBuffer*)(buf) + 1))
+/// @return element type named float32, uint32, or uint8, or -1 for other names
+extern int arcmBufferTypeId(const char* name);
+extern const char* arcmBufferTypeName(ArcmBufferType type);
+extern size_t arcmBufferElementSize(ArcmBufferType type);
+/// @return number of bytes to allocate for a buffer including its header, or 0 if count is too large
+extern size_t arcmBufferSize(ArcmBufferType type, size_t count);
+/// initializes the header of a buffer of arcmBufferSize() bytes and zeroes its elements
+extern void arcmBufferInit(ArcmBuffer* buf, ArcmBufferType type, size_t count);
+extern double arcmBufferGet(const ArcmBuffer* buf, size_t index);
+/// sets an element, integer types round and saturate the value to their range
+extern void arcmBufferSet(ArcmBuffer* buf, size_t index, double value);
+/// sets count elements starting at first to a value
+extern void arcmBufferFill(ArcmBuffer* buf, double value, size_t first, size_t count);
+/// copies the elements of src starting at first into an initialized buffer of the same type
+extern void arcmBufferSlice(ArcmBuffer* dst, const ArcmBuffer* src, size_t first);
+/// applies an operation to each element and the corresponding element of src, or scalar if src is NULL
+/** Adding src multiplies its elements by scalar first, so that buffers can be mixed with a gain.
+    @return false if src has a different number of elements */
+extern bool arcmBufferApply(ArcmBuffer* buf, ArcmBufferOp op, const ArcmBuffer* src, double scalar);
+extern double arcmBufferSum(const ArcmBuffer* buf);
+///@}
+
+///@{ sound effect synthesis
+/// oscillator waveforms, named square, sine, triangle, sawtooth, and noise
+typedef enum { ARCM_SYNTH_SQUARE, ARCM_SYNTH_SINE, ARCM_SYNTH_TRIANGLE, ARCM_SYNTH_SAWTOOTH, ARCM_SYNTH_NOISE } ArcmSynthWave;
+/// parameters of a synthesized sound, frequencies in Hz and times in seconds
+typedef struct {
+	int wave; ///< ArcmSynthWave
+	float freq, freqEnd; ///< frequency sliding exponentially from freq to freqEnd, a negative freqEnd equals freq
+	float duty; ///< fraction of a square wave's period at high level
+	float vibrato, vibratoFreq; ///< relative depth and frequency of a frequency modulation
+	float attack, decay, sustain, sustainLevel, release; ///< envelope segment durations and sustain level
+	float volume;
+} ArcmSynthParams;
+extern void arcmSynthDefaults(ArcmSynthParams* params);
+/// @return name of the index-th float parameter, or NULL beyond the last one
+extern const char* arcmSynthParamName(unsigned index);
+/// @return false if there is no float parameter of this name
+extern bool arcmSynthParam(ArcmSynthParams* params, const char* name, float value);
+/// @return false if there is no waveform of this name
+extern bool arcmSynthWave(ArcmSynthParams* params, const char* name);
+/// renders the mono samples of a sound at the device sample rate
+/** @return samples to be freed by caller, or NULL if the sound is empty */
+extern float* arcmSynthRender(const ArcmSynthParams* params, uint32_t* numSamples);
+/// returns handle to an audio sample synthesized from parameters, or one uploaded before with equal parameters
+/** exposed as audio.synth(params), taking a map of parameter names and values
+ * \return handle, or 0 if the sound is empty */
+extern uint32_t arcmAudioSynth(const ArcmSynthParams* params);
+/// drops the handles of synthesized samples, to be called when closing audio
+extern void arcmSynthCacheClose();
+///@}
+
+///@{ helpers shared by the arcamini modules
+/// seed of arcmHash
+#define ARCM_HASH_SEED 14695981039346656037ull
+/// continues a 64 bit FNV-1a hash, starting from ARCM_HASH_SEED
+extern uint64_t arcmHash(const void* data, size_t size, uint64_t hash);
+/// stores a uint32 in little endian byte order
+extern void arcmPut32(uint8_t* dest, uint32_t value);
+/// @return a uint32 stored in little endian byte order
+extern uint32_t arcmGet32(const uint8_t* src);
+/// writes a header followed by data to a temporary file, which then replaces fileName
+/** Readers never see a partially written file. May be called from any thread.
+    @return false in case of errors */
+extern bool arcmWriteFileAtomic(const char* fileName, const void* header, size_t headerSize, const void* data, size_t size);
+///@}
+
 ///@{ auxiliary functions mainly for the host application
 extern void arcmStorageInit(const char* appName, const char* scriptBaseName);
 extern void arcmStorageClose();
+/// @return storage statistics 'storageFlushes', 'storageCompactions', or 'storageSize', or NaN for unknown names
+extern double arcmStorageStats(const char* name);
 extern int arcmDispatchInputEvents(void* callback);
-extern void arcmWindowCloseOnButton67(size_t id, uint8_t button, float value);
+/// configures late input latching: 0 (default) polls inputs only after presenting a frame,
+/// 1 additionally polls them right before update, 2 polls them only before update, delayed towards
+/// the next vsync by a deadline adapting to the measured frame period
+extern void arcmWindowLateLatch(int mode);
+/// polls inputs in late latching mode, to be called by the host right before dispatching update
+/** @return false if the application is requested to quit */
+extern bool arcmWindowLatchInput(void* callback);
 extern void WindowEmitClose();
 extern void arcmShowError(const char* msg);
-extern char* ResourceGetText(const char* name);
+/// enables the startup profiler, to be called by the host as early as possible
+/** Reports stages, resources loaded before the first frame, and the time to the first presented frame.
+    @param json  prints a JSON object instead of a table */
+extern void arcmStartupProfile(bool json);
+/// marks the end of a startup stage, which began at the end of the previous one
+extern void arcmStartupStage(const char* stage);
+/// to be called by the host after presenting a frame, reports the startup profile after the first one
+extern void arcmStartupPresented();
+/// starts writing frames and audio mixer callbacks to a trace file in the Trace Event Format of chrome://tracing
+extern bool arcmTraceOpen(const char* fileName);
+/// completes and closes the trace file, to be called by the host before closing audio
+extern void arcmTraceClose();
+/// starts the startup tasks not depending on the window on worker threads, to be joined by arcmStartupJoin()
+/** Opens the audio device, initializes storage and the SVG cache, and reads the script, looking up its
+    bytecode in the cache. The host meanwhile opens the window and initializes graphics.
+    @param storageName     name of the storage file, usually the script's base name
+    @param scriptName      script of the resource archive to read, or NULL for none
+    @param bytecodeFormat  identifier of the VM's bytecode format to prefetch the script's bytecode, or NULL
+    @param audioTracks     number of audio tracks mixed at the same time */
+extern void arcmStartupBegin(const char* appName, const char* storageName, const char* scriptName, const char* bytecodeFormat, int audioTracks);
+/// waits for the startup tasks, to be called by the host before creating the VM
+/** @param copy receives the script text to be freed by caller if it could not be mapped, else NULL
+    @return the script's source, or NULL if it is shipped as bytecode only or none was read */
+extern const char* arcmStartupJoin(char** copy);
+/// reads the manifest of a script from the resource archive, shared with the browser runtime
+/** That is the manifest*.json listing the script in its scripts, else manifest.json.
+    @return false if there is none */
+extern bool arcmManifestOpen(const char* scriptName);
+extern void arcmManifestClose();
+/// @return a numeric manifest property such as window_width, window_height, or audio_tracks, or defaultValue if missing
+extern int arcmManifestInt(const char* key, int defaultValue);
+/// @return a string manifest property such as display, or defaultValue if missing
+extern const char* arcmManifestString(const char* key, const char* defaultValue);
+/// decodes the resources of the manifest's preload list in parallel and uploads them, showing a progress bar
+/** To be called by the host after opening the window and audio, before the script is entered.
+    Later resource.get* calls with the same parameters return the preloaded handles. Resources that
+    could not be preloaded are reported on stderr.
+    @return false only if the window was closed meanwhile, the host then exits without entering the script */
+extern bool arcmManifestPreload();
+/// @return handle of a preloaded resource, or 0 if it has not been preloaded with these parameters
+extern uint32_t arcmManifestPreloaded(const char* name, float param, float centerX, float centerY, int filtering);
+/// returns text resource, to be freed by caller
+extern char* arcmResourceGetText(const char* name);
+/// returns text resource, as a read-only view into the mapped archive if possible
+/** @param copy receives the text to be freed by caller if it could not be mapped, else NULL */
+extern const char* arcmResourceText(const char* name, char** copy);
+/// returns binary resource, as a read-only view into the mapped archive if possible
+/** @param copy receives the data to be freed by caller if it could not be mapped, else NULL */
+extern const void* arcmResourceBinary(const char* name, size_t* numBytes, void** copy);
+/// indexes a directory or pack archive for mapped, zero-copy resource access
+/** Directories are read by ResourceGet* as well, packs are read by arcamini only.
+    @return false if the archive cannot be mapped, other archives are read by ResourceGet* only */
+extern bool arcmArchiveOpen(const char* path);
+extern void arcmArchiveClose();
+/// @return true if the opened archive is a pack, which ResourceArchiveOpen cannot read
+extern bool arcmArchivePacked();
+/// @return true if the mapped archive contains a file
+extern bool arcmArchiveContains(const char* name);
+/// @return name of the mapped archive's index-th file in alphabetical order, or NULL beyond the last one
+extern const char* arcmArchiveEntry(size_t index);
+/// returns a read-only view of a file in the mapped archive, followed by a NUL byte, valid until arcmArchiveClose
+/** not thread-safe, see arcmResourceBinary
+    @return NULL if the archive is not mapped, does not contain the file, or it is compressed */
+extern const void* arcmArchiveView(const char* name, size_t* size);
+/// returns a copy of a file in the mapped archive followed by a NUL byte, decompressing it if needed
+/** not thread-safe, see arcmResourceBinary
+    @return data to be freed by caller, or NULL if the archive is not mapped or does not contain the file */
+extern void* arcmArchiveRead(const char* name, size_t* size);
+/// @return archive statistics 'archiveEntries', 'archiveMapped', or 'archiveInflated', or NaN for unknown names
+extern double arcmArchiveStats(const char* name);
+/// writes the files of a directory to a pack archive, closing any opened archive
+/** @param compress compresses files in LZ4 block format if that makes them smaller, else they are stored
+    @return false in case of errors */
+extern bool arcmArchivePack(const char* dirName, const char* packName, bool compress);
+/// maps the pack bundled with an executable, appended to it by arcmArchiveBundle
+/** @param exeName argv[0], used where the running executable cannot be determined otherwise
+    @return name of the bundled script to run, or NULL if there is no bundle */
+extern const char* arcmArchiveOpenBundle(const char* exeName);
+/// writes a copy of the running executable with a directory appended as a compressed pack
+/** Scripts of the given suffix are compiled and shipped as bytecode only, the directory is not
+    modified. Closes any opened archive.
+    @param compile  writes the stripped bytecode of a script of the archive to a file
+    @return false in case of errors */
+extern bool arcmArchiveBundle(const char* exeName, const char* dirName, const char* scriptName, const char* bundleName,
+	const char* scriptSuffix, bool (*compile)(const char* scriptName, const char* fileName));
+/// synchronously decodes and uploads an image, audio, or font resource of the mapped archive
+/** @return handle, or 0 if it is not in the mapped archive or could not be decoded */
+extern uint32_t arcmResourceLoadMapped(const char* name, float param, float centerX, float centerY, int filtering);
+/// uploads resources decoded in the background, to be called by the host at frame start
+extern void arcmResourceUploadPending();
+/// reads and decodes an image resource without uploading it. May be called from any thread
+/** @return pixels to be freed by caller, or NULL in case of error */
+extern unsigned char* arcmResourceDecodeImage(const char* name, float scale, int* w, int* h, int* d);
+/// stops the background resource loader, to be called before closing the resource archive
+extern void arcmResourceLoaderClose();
+/// stops all audio streams and their decoding thread, to be called before closing the resource archive
+extern void arcmAudioStreamClose();
+/// serializes resource archive access between the main thread and background loader threads
+extern void arcmResourceArchiveLock(bool lock);
+/// sets up the SVG raster cache directory below the application's preferences path
+extern void arcmSVGCacheInit(const char* appName);
+extern void arcmSVGCacheClose();
+/// uploads an SVG image or returns an already uploaded one with equal text, scale, center, and filtering
+/** @param filtering texture filtering mode, or -1 to keep the current one */
+extern uint32_t arcmSVGCacheImage(const char* svg, float scale, float centerX, float centerY, int filtering);
+/// rasterizes an SVG image or reads its pixels from the cache directory. May be called from any thread
+/** @return RGBA pixels to be freed by caller, or NULL in case of error */
+extern unsigned char* arcmSVGRasterize(const char* svg, float scale, int* w, int* h, int* d);
+/// sets up the decoded audio cache directory below the application's preferences path
+extern void arcmAudioCacheInit(const char* appName);
+extern void arcmAudioCacheClose();
+/// decodes an MP3 or WAV file or reads its samples from the cache directory. May be called from any thread
+/** @return samples to be passed to AudioUploadPCM, or NULL in case of error */
+extern float* arcmAudioDecode(const void* data, size_t numBytes, uint32_t* numSamples, uint8_t* numChannels, uint32_t* offset);
+/// uploads samples by AudioUploadPCM, keeping their location for scheduled replays to start at their exact frame
+/** wave data memory ownership is passed to the function */
+extern uint32_t arcmAudioUploadPCM(float* waveData, uint32_t numSamples, uint8_t numChannels, uint32_t offset);
+/// sets up the script bytecode cache directory below the application's preferences path
+extern void arcmBytecodeCacheInit(const char* appName);
+extern void arcmBytecodeCacheClose();
+/// looks up compiled code of a script in the bytecode cache, or shipped as <name>.bc in the resource archive
+/** @param source script source the bytecode must match, or NULL to look up shipped bytecode
+    @param format identifier of the VM and its bytecode version, at most 16 characters
+    @return bytecode to be freed by caller, or NULL if there is none */
+extern void* arcmBytecodeLoad(const char* name, const char* source, const char* format, size_t* size);
+/// stores compiled code of a script in the bytecode cache
+extern void arcmBytecodeStore(const char* name, const char* source, const char* format, const void* bytecode, size_t size);
+/// writes compiled code of a script to a file to be shipped in place of its source
+extern bool arcmBytecodeShip(const char* fileName, const char* format, const void* bytecode, size_t size);
+/// @return true if a script is shipped as bytecode in the resource archive
+extern bool arcmBytecodeShipped(const char* name, const char* format);
+/// looks up compiled code of a script ahead of its compilation, so that the next arcmBytecodeLoad is served
+/// from memory. May be called from a worker thread while the VM is not yet created
+extern void arcmBytecodePrefetch(const char* name, const char* source, const char* format);
+/// returns compiled code of a scene kept in memory, marking it as most recently used
+/** @return bytecode valid until the next call of arcmSceneCacheStore, or NULL if not cached */
+extern const void* arcmSceneCacheLoad(const char* name, size_t* size);
+/// keeps compiled code of a scene in memory, evicting the least recently used scene if the cache is full
+extern void arcmSceneCacheStore(const char* name, const void* bytecode, size_t size);
+/// drops all cached scenes, to be called when shutting down a VM
+extern void arcmSceneCacheClear();
 ///@}
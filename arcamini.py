@@ -1,15 +1,25 @@
 #!/usr/bin/env python3
 # arcamini.py - CPython bindings for arcamini C library
-import ctypes, struct, array, math
+import ctypes, struct, array, math, operator as _operator
 from ctypes import c_double, c_bool, c_float, c_uint, c_int, c_uint8
 import sys, os, types
 import importlib.abc, importlib.util
 
 def _as_c_array(data, typecode, ctype):
-    """Converts data to a ctypes array, avoiding a copy if it is already an array.array of matching typecode"""
-    if not (isinstance(data, array.array) and data.typecode == typecode):
-        data = array.array(typecode, data)
-    return (ctype * len(data)).from_buffer(data)
+    """Converts data to a ctypes array, using buffer-protocol objects like array.array, bytearray,
+    bytes, or numpy arrays of matching item type or raw bytes in place without a copy"""
+    try:
+        view = memoryview(data)
+        if view.format not in (typecode, 'B', 'b', 'c') or not view.c_contiguous:
+            raise TypeError
+    except TypeError: # lists and buffers of other item types are converted
+        view = memoryview(array.array(typecode, data))
+    count = view.nbytes // ctypes.sizeof(ctype)
+    if not view.readonly:
+        return (ctype * count).from_buffer(view.cast('B'))
+    if isinstance(data, bytes): # immutable, but ctypes can point into it
+        return ctypes.cast(ctypes.c_char_p(data), ctypes.POINTER(ctype * count)).contents
+    return (ctype * count).from_buffer_copy(view)
 
 if __name__ == "__main__": # ensure arcamini is the main module when run as script or imported
     sys.modules["arcamini"] = sys.modules["__main__"]
@@ -28,21 +38,24 @@ _isRunning = ctypes.c_bool.in_dll(_lib, "isRunning")
 
 
 # Callback prototypes
-INPUT_CB  = ctypes.CFUNCTYPE(None, ctypes.c_char_p, ctypes.c_int, ctypes.c_int, c_float, c_float)
+INPUT_CB  = ctypes.CFUNCTYPE(None, ctypes.c_char_p, ctypes.c_int, ctypes.c_int, c_float, c_double)
 UPDATE_CB = ctypes.CFUNCTYPE(c_bool, c_double)
 DRAW_CB   = ctypes.CFUNCTYPE(None)
+INPUT_BATCH_CB = ctypes.CFUNCTYPE(c_bool, ctypes.POINTER(c_double), c_int)
+INPUT_EVENT_STRIDE = 5 # type (0=axis, 1=button), device, id, value, timestamp
 # Keep refs
 _cb_refs = {}
-cbInput, cbUpdate, cbDraw, cbLeave = None, None, None, None
+cbInput, cbInputBatch, cbUpdate, cbDraw, cbLeave = None, None, None, None, None
 
 # Register functions
 _lib.arcamini_set_callbacks.argtypes = [INPUT_CB, UPDATE_CB, DRAW_CB]
+_lib.arcamini_set_input_batch_callback.argtypes = [INPUT_BATCH_CB]
 _lib.arcamini_init.argtypes   = [ctypes.c_int, ctypes.c_int, c_bool, ctypes.c_char_p, ctypes.c_char_p]
 _lib.arcamini_init.restype    = c_bool
 _lib.arcamini_run.restype     = None
-#char* ResourceGetText(const char* name);
-_lib.ResourceGetText.argtypes = [ctypes.c_char_p]
-_lib.ResourceGetText.restype  = ctypes.c_char_p
+#char* arcmResourceGetText(const char* name);
+_lib.arcmResourceGetText.argtypes = [ctypes.c_char_p]
+_lib.arcmResourceGetText.restype  = ctypes.c_char_p
 
 #--- window API ---
 window = types.SimpleNamespace()
@@ -62,9 +75,32 @@ _lib.WindowHeight.restype = c_int
 _lib.WindowClearColor.argtypes = [c_uint]
 _lib.WindowClearColor.restype = None
 
+_sceneCache = {} # compiled scenes by file name, in least recently used order
+_SCENE_CACHE_CAPACITY = 8
+
+def _compileScene(fname):
+    """Returns the code object of a scene, compiling it if not cached, or None if it does not exist"""
+    code = _sceneCache.pop(fname, None)
+    if code is None:
+        script = _lib.arcmResourceGetText(fname.encode('utf-8'))
+        if not script:
+            return None
+        code = compile(script.decode('utf-8'), fname, 'exec')
+        if len(_sceneCache) >= _SCENE_CACHE_CAPACITY:
+            del _sceneCache[next(iter(_sceneCache))]
+    _sceneCache[fname] = code
+    return code
+
+def _preloadScene(fname):
+    """Compiles a scene in advance, so that a later switchScene() to it does not need to"""
+    if not fname.endswith(".py"):
+        fname += ".py"
+    if _compileScene(fname) is None:
+        raise ImportError("window.preloadScene(%s): file not found" % fname)
+
 def _switchScene(fname, *args):
     """Switch to another script/scene, passing optional string arguments"""
-    global cbInput, cbUpdate, cbDraw, cbLeave
+    global cbInput, cbInputBatch, cbUpdate, cbDraw, cbLeave
 
     if cbLeave:
         try:
@@ -80,12 +116,11 @@ def _switchScene(fname, *args):
 
     if not fname.endswith(".py"):
         fname += ".py"
-    script = _lib.ResourceGetText(fname.encode('utf-8'))
-    if not script:
+    script = _compileScene(fname)
+    if script is None:
         print("Error: could not load script", fname)
         _isRunning.value = False
         return
-    script = script.decode('utf-8')
     fname = fname[:-3]
     if fname in sys.modules:
         currScene = sys.modules[fname]
@@ -97,6 +132,7 @@ def _switchScene(fname, *args):
     exec(script, currScene.__dict__)
 
     cbInput = getattr(currScene, "input", None)
+    cbInputBatch = getattr(currScene, "inputBatch", None)
     cbUpdate = getattr(currScene, "update", None)
     cbDraw = getattr(currScene, "draw", None)
     cbLeave = getattr(currScene, "leave", None)
@@ -105,19 +141,95 @@ def _switchScene(fname, *args):
         cbEnter(args if args else [])
 
 window.switchScene = _switchScene
+window.preloadScene = _preloadScene
+
+#extern void arcmWindowAxisFilter(float resolution, float deadzone);
+_lib.arcmWindowAxisFilter.argtypes = [c_float, c_float]
+_lib.arcmWindowAxisFilter.restype = None
+window.axisFilter = lambda resolution=0.1, deadzone=0.0: _lib.arcmWindowAxisFilter(
+    c_float(resolution), c_float(deadzone))
+#extern int arcmWindowInputState(size_t device, uint32_t* buttons, float* axes, int maxAxes);
+_lib.arcmWindowInputState.argtypes = [ctypes.c_size_t, ctypes.POINTER(c_uint), ctypes.POINTER(c_float), c_int]
+_lib.arcmWindowInputState.restype = c_int
+def _inputState(device):
+    buttons, axes = c_uint(0), (c_float * 16)()
+    numAxes = _lib.arcmWindowInputState(device, ctypes.byref(buttons), axes, 16)
+    return [buttons.value] + axes[:numAxes]
+window.inputState = _inputState
+#extern bool arcmWindowPressed(size_t device, uint8_t button);
+_lib.arcmWindowPressed.argtypes = [ctypes.c_size_t, c_uint8]
+_lib.arcmWindowPressed.restype = c_bool
+window.pressed = lambda device, button: _lib.arcmWindowPressed(device, button)
+#extern bool arcmWindowReleased(size_t device, uint8_t button);
+_lib.arcmWindowReleased.argtypes = [ctypes.c_size_t, c_uint8]
+_lib.arcmWindowReleased.restype = c_bool
+window.released = lambda device, button: _lib.arcmWindowReleased(device, button)
+#extern double arcmWindowStats(const char* name);
+_lib.arcmWindowStats.argtypes = [ctypes.c_char_p]
+_lib.arcmWindowStats.restype = c_double
+def _stats(name):
+    value = _lib.arcmWindowStats(name.encode('utf-8'))
+    return None if math.isnan(value) else value
+window.stats = _stats
 
 #--- audio API ---
 audio = types.SimpleNamespace()
-#extern uint32_t AudioReplay(uint32_t sample, float volume, float balance, float detune);
-_lib.AudioReplay.argtypes = [c_uint, c_float, c_float, c_float]
-_lib.AudioReplay.restype = c_uint
-audio.replay = lambda sample, volume=1.0, balance=0.0, detune=0.0: _lib.AudioReplay(
-    c_uint(sample), c_float(volume), c_float(balance), c_float(detune))
+#extern uint32_t arcmAudioReplay(uint32_t sample, float volume, float balance, float detune, int priority);
+_lib.arcmAudioReplay.argtypes = [c_uint, c_float, c_float, c_float, c_int]
+_lib.arcmAudioReplay.restype = c_uint
+audio.replay = lambda sample, volume=1.0, balance=0.0, detune=0.0, priority=0: _lib.arcmAudioReplay(
+    c_uint(sample), c_float(volume), c_float(balance), c_float(detune), c_int(priority))
+#extern bool arcmAudioReplayAt(uint32_t sample, double when, float volume, float balance, float detune);
+_lib.arcmAudioReplayAt.argtypes = [c_uint, ctypes.c_double, c_float, c_float, c_float]
+_lib.arcmAudioReplayAt.restype = c_bool
+audio.replayAt = lambda sample, when, volume=1.0, balance=0.0, detune=0.0: _lib.arcmAudioReplayAt(
+    c_uint(sample), ctypes.c_double(when), c_float(volume), c_float(balance), c_float(detune))
+#extern double arcmAudioTime();
+_lib.arcmAudioTime.argtypes = []
+_lib.arcmAudioTime.restype = ctypes.c_double
+audio.time = _lib.arcmAudioTime
+#extern uint32_t arcmAudioBufferSize();
+_lib.arcmAudioBufferSize.argtypes = []
+_lib.arcmAudioBufferSize.restype = c_uint
+audio.bufferSize = _lib.arcmAudioBufferSize
+#extern double arcmAudioLatency();
+_lib.arcmAudioLatency.argtypes = []
+_lib.arcmAudioLatency.restype = ctypes.c_double
+audio.latency = _lib.arcmAudioLatency
 #extern void arcmAudioVolume(uint32_t track, float volume, float fadeTime);
 _lib.arcmAudioVolume.argtypes = [c_uint, c_float, c_float]
 _lib.arcmAudioVolume.restype = None
 audio.volume = lambda track, volume=1.0, fadeTime=0.0: _lib.arcmAudioVolume(
     c_uint(track), c_float(volume), c_float(fadeTime))
+#extern uint32_t arcmAudioStream(const char* name, float volume, bool loop);
+_lib.arcmAudioStream.argtypes = [ctypes.c_char_p, c_float, c_bool]
+_lib.arcmAudioStream.restype = c_uint
+def _stream(name, volume=1.0, loop=False):
+    track = _lib.arcmAudioStream(name.encode('utf-8'), c_float(volume), c_bool(loop))
+    return None if track == 0xffffffff else track
+audio.stream = _stream
+#extern uint32_t arcmAudioSynth(const ArcmSynthParams* params);
+_lib.arcmSynthParamName.argtypes = [c_uint]
+_lib.arcmSynthParamName.restype = ctypes.c_char_p
+class _SynthParams(ctypes.Structure):
+    _fields_ = [('wave', c_int)] + [(name.decode('utf-8'), c_float) for name in
+        iter((lambda i=iter(range(64)): _lib.arcmSynthParamName(next(i))), None)]
+_lib.arcmSynthDefaults.argtypes = [ctypes.POINTER(_SynthParams)]
+_lib.arcmSynthDefaults.restype = None
+_lib.arcmSynthWave.argtypes = [ctypes.POINTER(_SynthParams), ctypes.c_char_p]
+_lib.arcmSynthWave.restype = c_bool
+_lib.arcmAudioSynth.argtypes = [ctypes.POINTER(_SynthParams)]
+_lib.arcmAudioSynth.restype = c_uint
+def _synth(params):
+    p = _SynthParams()
+    _lib.arcmSynthDefaults(ctypes.byref(p))
+    if 'wave' in params and not _lib.arcmSynthWave(ctypes.byref(p), str(params['wave']).encode('utf-8')):
+        raise ValueError("audio.synth: unknown wave")
+    for name, _ in _SynthParams._fields_[1:]:
+        if name in params:
+            setattr(p, name, float(params[name]))
+    return _lib.arcmAudioSynth(ctypes.byref(p))
+audio.synth = _synth
 
 #--- resource API ---
 resource = types.SimpleNamespace()
@@ -151,21 +263,60 @@ _lib.gfxImageTileGrid.restype = c_uint
 resource.getTileGrid = lambda parent, tilesX, tilesY=1, border=0: _lib.gfxImageTileGrid(
     c_uint(parent), ctypes.c_uint16(tilesX), ctypes.c_uint16(tilesY), ctypes.c_uint16(border))
 
-#extern size_t ResourceGetAudio(const char* name);
-_lib.ResourceGetAudio.argtypes = [ctypes.c_char_p]
-_lib.ResourceGetAudio.restype = c_uint
-resource.getAudio = lambda name: _lib.ResourceGetAudio(name.encode('utf-8'))
+#extern uint32_t arcmResourceGetAudio(const char* name);
+_lib.arcmResourceGetAudio.argtypes = [ctypes.c_char_p]
+_lib.arcmResourceGetAudio.restype = c_uint
+resource.getAudio = lambda name: _lib.arcmResourceGetAudio(name.encode('utf-8'))
 
 #uint32_t arcamini_createAudio(float* waveData, uint32_t numSamples, uint8_t numChannels)
 _lib.arcamini_createAudio.argtypes = [ctypes.POINTER(c_float), c_uint, c_uint8]
 _lib.arcamini_createAudio.restype = c_uint
-resource.createAudio = lambda waveData, numChannels=1: _lib.arcamini_createAudio(
-    _as_c_array(waveData, 'f', c_float), c_uint(len(waveData)), c_uint8(numChannels))
-
-#extern size_t ResourceGetFont(const char* name, unsigned fontSize);
-_lib.ResourceGetFont.argtypes = [ctypes.c_char_p, c_uint]
-_lib.ResourceGetFont.restype = c_uint
-resource.getFont = lambda name, fontSize=16: _lib.ResourceGetFont(name.encode('utf-8'), c_uint(fontSize))
+def _createAudio(waveData, numChannels=1):
+    samples = _as_c_array(waveData, 'f', c_float)
+    return _lib.arcamini_createAudio(samples, c_uint(len(samples) // numChannels), c_uint8(numChannels))
+resource.createAudio = _createAudio
+
+#extern uint32_t arcmResourceGetFont(const char* name, unsigned fontSize);
+_lib.arcmResourceGetFont.argtypes = [ctypes.c_char_p, c_uint]
+_lib.arcmResourceGetFont.restype = c_uint
+resource.getFont = lambda name, fontSize=16: _lib.arcmResourceGetFont(name.encode('utf-8'), c_uint(fontSize))
+
+#extern size_t arcmResourceCreateAtlas(const char** names, size_t numNames, float scale, float centerX, float centerY, int filtering, uint32_t* handles);
+_lib.arcmResourceCreateAtlas.argtypes = [ctypes.POINTER(ctypes.c_char_p), ctypes.c_size_t, c_float, c_float, c_float, c_int, ctypes.POINTER(c_uint)]
+_lib.arcmResourceCreateAtlas.restype = ctypes.c_size_t
+def _resource_create_atlas(names, scale=1.0, centerX=0.0, centerY=0.0, filtering=1):
+    c_names = (ctypes.c_char_p * len(names))(*[name.encode('utf-8') for name in names])
+    handles = (c_uint * len(names))()
+    _lib.arcmResourceCreateAtlas(c_names, len(names), c_float(scale), c_float(centerX), c_float(centerY), c_int(filtering), handles)
+    return list(handles)
+resource.createAtlas = _resource_create_atlas
+
+#extern uint32_t arcmResourceLoadAsync(const char* name, float param, float centerX, float centerY, int filtering);
+_lib.arcmResourceLoadAsync.argtypes = [ctypes.c_char_p, c_float, c_float, c_float, c_int]
+_lib.arcmResourceLoadAsync.restype = c_uint
+resource.loadAsync = lambda name, param=0.0, centerX=0.0, centerY=0.0, filtering=1: _lib.arcmResourceLoadAsync(
+    name.encode('utf-8'), c_float(param), c_float(centerX), c_float(centerY), c_int(filtering))
+
+# onProgress handler of resource.load(), called before each update until loading has completed
+_load_progress = [None]
+def _resource_load(names, onProgress=None):
+    if onProgress is not None:
+        _load_progress[0] = onProgress
+    return [resource.loadAsync(name) for name in names]
+resource.load = _resource_load
+
+#extern bool arcmResourceLoaded(uint32_t pending, uint32_t* handle);
+_lib.arcmResourceLoaded.argtypes = [c_uint, ctypes.POINTER(c_uint)]
+_lib.arcmResourceLoaded.restype = c_bool
+def _resource_loaded(pending):
+    handle = c_uint(0)
+    return handle.value if _lib.arcmResourceLoaded(c_uint(pending), ctypes.byref(handle)) else None
+resource.loaded = _resource_loaded
+
+#extern float arcmResourceLoadProgress();
+_lib.arcmResourceLoadProgress.argtypes = []
+_lib.arcmResourceLoadProgress.restype = c_float
+resource.loadProgress = lambda: _lib.arcmResourceLoadProgress()
 
 #extern uint32_t arcmQueryImage(uint32_t image, const char* property);
 _lib.arcmQueryImage.argtypes = [c_uint, ctypes.c_char_p]
@@ -197,15 +348,88 @@ def _queryFont(font, property, str="M"):
     return value
 resource.queryFont = _queryFont
 
-#extern const char* arcmResourceGetStorageItem(const char* key);
-_lib.arcmResourceGetStorageItem.argtypes = [ctypes.c_char_p]
-_lib.arcmResourceGetStorageItem.restype = ctypes.c_char_p
-resource.getStorageItem = lambda key: (_lib.arcmResourceGetStorageItem(key.encode('utf-8')) or b'').decode('utf-8')
-
-#extern void arcmResourceSetStorageItem(const char* key, const char* value);
-_lib.arcmResourceSetStorageItem.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
-_lib.arcmResourceSetStorageItem.restype = None
-resource.setStorageItem = lambda key, value: _lib.arcmResourceSetStorageItem(key.encode('utf-8'), value.encode('utf-8'))
+#extern const void* arcmResourceGetStorageValue(const char* key, size_t* size, bool* isBinary);
+_lib.arcmResourceGetStorageValue.argtypes = [ctypes.c_char_p, ctypes.POINTER(ctypes.c_size_t), ctypes.POINTER(c_bool)]
+_lib.arcmResourceGetStorageValue.restype = ctypes.c_void_p
+def _getStorageItem(key):
+    size, isBinary = ctypes.c_size_t(0), c_bool(False)
+    ptr = _lib.arcmResourceGetStorageValue(key.encode('utf-8'), ctypes.byref(size), ctypes.byref(isBinary))
+    if not ptr:
+        return None
+    data = ctypes.string_at(ptr, size.value)
+    return data if isBinary.value else data.decode('utf-8')
+resource.getStorageItem = _getStorageItem
+
+#extern void arcmResourceSetStorageValue(const char* key, const void* value, size_t size, bool isBinary);
+_lib.arcmResourceSetStorageValue.argtypes = [ctypes.c_char_p, ctypes.c_char_p, ctypes.c_size_t, c_bool]
+_lib.arcmResourceSetStorageValue.restype = None
+def _setStorageItem(key, value):
+    if value is None:
+        return _lib.arcmResourceSetStorageValue(key.encode('utf-8'), None, 0, False)
+    isBinary = isinstance(value, (bytes, bytearray, memoryview, array.array))
+    data = bytes(value) if isBinary else str(value).encode('utf-8')
+    _lib.arcmResourceSetStorageValue(key.encode('utf-8'), data, len(data), isBinary)
+resource.setStorageItem = _setStorageItem
+#extern bool arcmResourceFlushStorage();
+_lib.arcmResourceFlushStorage.argtypes = []
+_lib.arcmResourceFlushStorage.restype = c_bool
+resource.flushStorage = lambda: _lib.arcmResourceFlushStorage()
+
+# typed buffer as provided by the pocketpy runtime, passed to resource.createImage/createAudio in place
+class buffer(array.array):
+    _typecodes = { 'float32': 'f', 'uint32': 'I', 'uint8': 'B' }
+    _maxValues = { 'I': 4294967295, 'B': 255 }
+    def __new__(cls, type, sizeOrValues):
+        typecode = cls._typecodes.get(type)
+        if typecode is None:
+            raise ValueError("buffer() expects buffer type float32, uint32, or uint8")
+        if isinstance(sizeOrValues, int):
+            return super().__new__(cls, typecode, bytes(sizeOrValues * array.array(typecode).itemsize))
+        buf = super().__new__(cls, typecode, bytes(len(sizeOrValues) * array.array(typecode).itemsize))
+        for i, value in enumerate(sizeOrValues):
+            buf[i] = value
+        return buf
+    def _store(self, value):
+        """integer types round and saturate values to their range"""
+        if self.typecode == 'f':
+            return value
+        return 0 if not value >= 0 else min(int(math.floor(value + 0.5)), self._maxValues[self.typecode])
+    def __setitem__(self, index, value):
+        super().__setitem__(index, self._store(value))
+    def __getitem__(self, index):
+        if isinstance(index, slice):
+            if index.step not in (None, 1):
+                raise ValueError("buffer slices do not support steps")
+            return self.slice(index.start, index.stop)
+        return super().__getitem__(index)
+    @property
+    def type(self):
+        return next(name for name, code in self._typecodes.items() if code == self.typecode)
+    def fill(self, value, start=0, stop=None):
+        value = self._store(value)
+        for i in range(*slice(start, stop).indices(len(self))):
+            super().__setitem__(i, value)
+        return self
+    def slice(self, start=0, stop=None):
+        return buffer(self.type, super().__getitem__(slice(start, stop)))
+    def _apply(self, op, other, factor=1.0):
+        if isinstance(other, buffer):
+            if len(other) != len(self):
+                raise ValueError("expects a buffer of equal length")
+            for i in range(len(self)):
+                self[i] = op(super().__getitem__(i), other[i] * factor if op is _operator.add else other[i])
+        else:
+            for i in range(len(self)):
+                self[i] = op(super().__getitem__(i), other)
+        return self
+    def add(self, other, factor=1.0):
+        return self._apply(_operator.add, other, factor)
+    def mul(self, other):
+        return self._apply(_operator.mul, other)
+    def clamp(self, lo, hi):
+        return self._apply(max, lo)._apply(min, hi)
+    def sum(self):
+        return float(math.fsum(self))
 
 # replace built-in breakpoint() by arcamini-compatible breakpoint(args)
 import builtins
@@ -227,7 +451,7 @@ class ResourceLoader(importlib.abc.Loader):
 class ResourceFinder(importlib.abc.MetaPathFinder):
     def find_spec(self, fullname, path, target=None):
         fname = fullname + ".py"
-        code_bytes = _lib.ResourceGetText(fname.encode('utf-8'))
+        code_bytes = _lib.arcmResourceGetText(fname.encode('utf-8'))
         if code_bytes:
             return importlib.util.spec_from_loader(fullname, ResourceLoader(code_bytes))
         return None
@@ -324,12 +548,10 @@ def init(width, height, fullscreen, fname:str):
     archiveName = os.path.dirname(fname)
     if not archiveName:
         archiveName = os.path.curdir
-    scriptBaseName = os.path.basename(fname).replace("_", " ")
-    if scriptBaseName.endswith(".py"):
-        scriptBaseName = scriptBaseName[:-3]
+    scriptName = os.path.basename(fname)
 
     if not _lib.arcamini_init(width, height, fullscreen,
-        archiveName.encode('utf-8'), scriptBaseName.encode('utf-8')):
+        archiveName.encode('utf-8'), scriptName.encode('utf-8')):
         raise RuntimeError("Failed to initialize arcamini with startup script " + fname)
     window._width = _lib.WindowWidth()
     window._height = _lib.WindowHeight()
@@ -349,10 +571,26 @@ def run():
             traceback.print_exc()
             _isRunning.value = False
 
+    def _input_batch(events, numEvents):
+        if not cbInputBatch:
+            return False
+        try:
+            cbInputBatch(events[:numEvents * INPUT_EVENT_STRIDE])
+        except Exception:
+            import traceback
+            traceback.print_exc()
+            _isRunning.value = False
+        return True
+
     def _update(dt):
         if not cbUpdate:
             return False
         try:
+            if _load_progress[0]:
+                onProgress, progress = _load_progress[0], resource.loadProgress()
+                if progress >= 1.0:
+                    _load_progress[0] = None
+                onProgress(progress)
             return bool(cbUpdate(dt))
         except Exception:
             import traceback
@@ -373,12 +611,15 @@ def run():
     inp_cb = INPUT_CB(_input)
     up_cb = UPDATE_CB(_update)
     dr_cb = DRAW_CB(_draw)
+    batch_cb = INPUT_BATCH_CB(_input_batch)
 
     _cb_refs["input"] = inp_cb
     _cb_refs["update"] = up_cb
     _cb_refs["draw"] = dr_cb
+    _cb_refs["inputBatch"] = batch_cb
 
     _lib.arcamini_set_callbacks(inp_cb, up_cb, dr_cb)
+    _lib.arcamini_set_input_batch_callback(batch_cb)
     _lib.arcamini_run()
     if cbLeave:
         try:
@@ -391,10 +632,10 @@ def run():
 
 
 if __name__ != "__main__" or len(sys.argv) < 2:
-    print("Usage: python3 -m arcamini [-f(ullscreen) -w width -h height] <script> [args...]")
+    print("Usage: python3 -m arcamini [-f(ullscreen) -w width -h height -l latch_mode] <script> [args...]")
     sys.exit(1)
 
-window_width, window_height, window_fullscreen = 640, 480, False
+window_width, window_height, window_fullscreen = 0, 0, False # 0: as in manifest.json, else 640x480
 if '-w' in sys.argv and sys.argv.index('-w') + 1 < len(sys.argv):
     window_width = int(sys.argv[sys.argv.index('-w') + 1])
     sys.argv.remove(sys.argv[sys.argv.index('-w') + 1])
@@ -406,6 +647,10 @@ if '-h' in sys.argv and sys.argv.index('-h') + 1 < len(sys.argv):
 if '-f' in sys.argv:
     window_fullscreen = True
     sys.argv.remove('-f')
+if '-l' in sys.argv and sys.argv.index('-l') + 1 < len(sys.argv):
+    _lib.arcmWindowLateLatch(int(sys.argv[sys.argv.index('-l') + 1]))
+    sys.argv.remove(sys.argv[sys.argv.index('-l') + 1])
+    sys.argv.remove('-l')
 
 fname = sys.argv[1]
 
@@ -0,0 +1,731 @@
+#include "arcamini.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#if defined __WIN32__ || defined WIN32
+#define ARCHIVE_MMAP 0
+#else
+#define ARCHIVE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+//--- mapped resource archive --------------------------------------
+// The files of a directory archive are indexed once when opening it, in an open addressing hash table
+// keyed by a 64 bit FNV-1a hash of their relative path. Files are memory-mapped on first access and
+// stay mapped until the archive is closed, so that resources can be handed out as read-only views
+// instead of copies. Views are always followed by a NUL byte, so text resources can be used as C
+// strings in place: mapped bytes beyond the end of a file read as zero up to the end of its last
+// page, files ending exactly at a page boundary are read into memory instead, as on platforms
+// without mmap.
+//
+// Pack archives are single files holding an index followed by the entries' data, which is mapped as
+// a whole when opening the pack. Entries are either stored, followed by a NUL byte and handed out as
+// views, or compressed in LZ4 block format and decompressed into a buffer of the reader's own.
+// Packs consist of PACK_MAGIC, the little endian uint32 number of entries and uint32 size of the
+// index, and the index entries, each made up of the uint64 data offset relative to the start of the
+// pack, the uint32 size, the uint32 compressed size (0 for stored entries), the uint16 name length,
+// and the name without terminating NUL.
+
+#define ARCHIVE_MAX_DEPTH 16
+
+#define PACK_MAGIC "arcmpak1"
+#define PACK_MAGIC_SIZE 8
+#define PACK_HEADER_SIZE (PACK_MAGIC_SIZE + 4 + 4)
+#define PACK_ENTRY_SIZE (8 + 4 + 4 + 2)
+
+typedef struct {
+	char* name; ///< path relative to the archive root, separated by '/'
+	uint64_t hash;
+	size_t size;
+	const uint8_t* data; ///< NULL until first accessed, or for compressed pack entries
+	bool mapped; ///< data is mapped, else allocated
+	uint64_t offset; ///< of pack entries
+	size_t packedSize; ///< of compressed pack entries, else 0
+} ArchiveEntry;
+
+static char* archivePath = NULL;
+static ArchiveEntry* archiveEntries = NULL;
+static size_t archiveNumEntries = 0, archiveCapacity = 0;
+/// hash table of entry indices + 1, 0 marks an unused slot
+static uint32_t* archiveTable = NULL;
+static size_t archiveTableSize = 0;
+static size_t archiveMappedBytes = 0, archiveInflatedBytes = 0;
+/// pack archive contents, NULL for directory archives
+static const uint8_t* packData = NULL;
+static size_t packSize = 0;
+static void* packMapping = NULL;
+static size_t packMappingSize = 0;
+
+static ArchiveEntry* ArchiveAdd(const char* name, size_t size) {
+	if(archiveNumEntries == archiveCapacity) {
+		archiveCapacity = archiveCapacity ? archiveCapacity*2 : 256;
+		archiveEntries = (ArchiveEntry*)realloc(archiveEntries, archiveCapacity * sizeof(ArchiveEntry));
+	}
+	ArchiveEntry* entry = &archiveEntries[archiveNumEntries++];
+	memset(entry, 0, sizeof(ArchiveEntry));
+	entry->name = strdup(name);
+	entry->hash = arcmHash(name, strlen(name), ARCM_HASH_SEED);
+	entry->size = size;
+	return entry;
+}
+
+static void ArchiveReadDir(const char* relPath, int depth) {
+	char* dirPath = (char*)malloc(strlen(archivePath) + strlen(relPath) + 2);
+	sprintf(dirPath, "%s/%s", archivePath, relPath);
+	DIR* dir = opendir(dirPath);
+	free(dirPath);
+	if(!dir)
+		return;
+	for(struct dirent* ent = readdir(dir); ent; ent = readdir(dir)) {
+		if(strcmp(ent->d_name, ".")==0 || strcmp(ent->d_name, "..")==0)
+			continue;
+		char* name = (char*)malloc(strlen(relPath) + strlen(ent->d_name) + 2);
+		sprintf(name, *relPath ? "%s/%s" : "%s%s", relPath, ent->d_name);
+		char* path = (char*)malloc(strlen(archivePath) + strlen(name) + 2);
+		sprintf(path, "%s/%s", archivePath, name);
+		struct stat st;
+		if(stat(path, &st) == 0) {
+			if(S_ISDIR(st.st_mode)) {
+				if(depth < ARCHIVE_MAX_DEPTH)
+					ArchiveReadDir(name, depth+1);
+			}
+			else if(S_ISREG(st.st_mode))
+				ArchiveAdd(name, (size_t)st.st_size);
+		}
+		free(path);
+		free(name);
+	}
+	closedir(dir);
+}
+
+static int ArchiveCompareEntries(const void* a, const void* b) {
+	return strcmp(((const ArchiveEntry*)a)->name, ((const ArchiveEntry*)b)->name);
+}
+
+static void ArchiveBuildTable() {
+	archiveTableSize = 16;
+	while(archiveTableSize < archiveNumEntries*2)
+		archiveTableSize *= 2;
+	archiveTable = (uint32_t*)calloc(archiveTableSize, sizeof(uint32_t));
+	for(size_t i=0; i<archiveNumEntries; ++i) {
+		size_t slot = archiveEntries[i].hash & (archiveTableSize-1);
+		while(archiveTable[slot])
+			slot = (slot+1) & (archiveTableSize-1);
+		archiveTable[slot] = (uint32_t)i+1;
+	}
+}
+
+static ArchiveEntry* ArchiveFind(const char* name) {
+	if(!archiveTableSize)
+		return NULL;
+	while(name[0]=='.' && name[1]=='/')
+		name += 2;
+	const uint64_t hash = arcmHash(name, strlen(name), ARCM_HASH_SEED);
+	for(size_t slot = hash & (archiveTableSize-1); archiveTable[slot]; slot = (slot+1) & (archiveTableSize-1)) {
+		ArchiveEntry* entry = &archiveEntries[archiveTable[slot]-1];
+		if(entry->hash == hash && strcmp(entry->name, name)==0)
+			return entry;
+	}
+	return NULL;
+}
+
+/// reads a file from an offset on into memory, followed by a NUL byte
+static uint8_t* ArchiveReadFile(const char* path, uint64_t offset, size_t* size) {
+	FILE* f = fopen(path, "rb");
+	if(!f)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	const long fileSize = ftell(f) - (long)offset;
+	fseek(f, (long)offset, SEEK_SET);
+	uint8_t* data = (uint8_t*)malloc(fileSize > 0 ? fileSize+1 : 1);
+	*size = fileSize > 0 ? fread(data, 1, fileSize, f) : 0;
+	data[*size] = 0;
+	fclose(f);
+	return data;
+}
+
+static bool ArchiveLoad(ArchiveEntry* entry) {
+	char* path = (char*)malloc(strlen(archivePath) + strlen(entry->name) + 2);
+	sprintf(path, "%s/%s", archivePath, entry->name);
+#if ARCHIVE_MMAP
+	int fd = open(path, O_RDONLY);
+	struct stat st;
+	if(fd >= 0 && fstat(fd, &st) == 0) {
+		entry->size = (size_t)st.st_size;
+		const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+		if(entry->size % pageSize) {
+			void* data = mmap(NULL, entry->size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(data != MAP_FAILED) {
+				entry->data = (const uint8_t*)data;
+				entry->mapped = true;
+				archiveMappedBytes += entry->size;
+			}
+		}
+	}
+	if(fd >= 0)
+		close(fd);
+#endif
+	if(!entry->data)
+		entry->data = ArchiveReadFile(path, 0, &entry->size);
+	free(path);
+	return entry->data != NULL;
+}
+
+static void ArchiveUnload(ArchiveEntry* entry) {
+	if(packData)
+		return; // views into the pack
+#if ARCHIVE_MMAP
+	if(entry->mapped) {
+		munmap((void*)entry->data, entry->size);
+		archiveMappedBytes -= entry->size;
+	}
+	else
+#endif
+	free((void*)entry->data);
+	entry->data = NULL;
+	entry->mapped = false;
+}
+
+//--- LZ4 block format ---------------------------------------------
+// Sequences of a token holding the number of literals in its upper and the match length - 4 in its
+// lower 4 bits, each extended by following bytes if 15, up to including the first byte below 255,
+// the literals, and the little endian uint16 match offset. The last sequence consists of literals
+// only, and matches end at least 5 bytes before the end of a block.
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_LIMIT 12 ///< matches start at least 12 bytes before the end of a block
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 16
+#define LZ4_MAX_RATIO 255 ///< a compressed byte expands to at most this many bytes, as a length byte
+
+static bool ArchiveDecompress(const uint8_t* src, size_t srcSize, uint8_t* dest, size_t destSize) {
+	const uint8_t* ip = src, *const srcEnd = src + srcSize;
+	uint8_t* op = dest, *const destEnd = dest + destSize;
+	while(ip < srcEnd) {
+		const unsigned token = *ip++;
+		size_t len = token >> 4;
+		if(len == 15) {
+			unsigned ext;
+			do {
+				if(ip == srcEnd)
+					return false;
+				len += ext = *ip++;
+			} while(ext == 255);
+		}
+		if(len > (size_t)(srcEnd - ip) || len > (size_t)(destEnd - op))
+			return false;
+		memcpy(op, ip, len);
+		op += len;
+		ip += len;
+		if(ip == srcEnd)
+			break;
+
+		if(srcEnd - ip < 2)
+			return false;
+		const size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if(!offset || offset > (size_t)(op - dest))
+			return false;
+		len = token & 15;
+		if(len == 15) {
+			unsigned ext;
+			do {
+				if(ip == srcEnd)
+					return false;
+				len += ext = *ip++;
+			} while(ext == 255);
+		}
+		len += LZ4_MIN_MATCH;
+		if(len > (size_t)(destEnd - op))
+			return false;
+		const uint8_t* match = op - offset;
+		if(offset >= len) {
+			memcpy(op, match, len);
+			op += len;
+		}
+		else while(len--) // overlapping repetition
+			*op++ = *match++;
+	}
+	return op == destEnd;
+}
+
+static uint8_t* Lz4PutLength(uint8_t* op, size_t len) {
+	for(; len >= 255; len -= 255)
+		*op++ = 255;
+	*op++ = (uint8_t)len;
+	return op;
+}
+
+static uint8_t* Lz4PutSequence(uint8_t* op, const uint8_t* literals, size_t numLiterals, size_t offset, size_t matchLen) {
+	uint8_t* token = op++;
+	*token = (numLiterals < 15 ? numLiterals : 15) << 4;
+	if(numLiterals >= 15)
+		op = Lz4PutLength(op, numLiterals - 15);
+	memcpy(op, literals, numLiterals);
+	op += numLiterals;
+	if(!matchLen)
+		return op;
+	*op++ = offset & 0xff;
+	*op++ = offset >> 8;
+	matchLen -= LZ4_MIN_MATCH;
+	*token |= matchLen < 15 ? matchLen : 15;
+	if(matchLen >= 15)
+		op = Lz4PutLength(op, matchLen - 15);
+	return op;
+}
+
+/// greedy LZ4 block compression, favoring simplicity over ratio
+/** @param dest of at least ArchiveCompressBound(size) bytes
+    @return compressed size */
+static size_t ArchiveCompress(const uint8_t* src, size_t size, uint8_t* dest) {
+	uint8_t* op = dest;
+	size_t pos = 0, anchor = 0;
+	if(size > LZ4_MATCH_LIMIT) {
+		uint32_t* table = (uint32_t*)calloc((size_t)1 << LZ4_HASH_BITS, sizeof(uint32_t)); // positions + 1
+		while(pos + LZ4_MATCH_LIMIT < size) {
+			uint32_t seq;
+			memcpy(&seq, src + pos, 4);
+			const uint32_t h = (seq * 2654435761u) >> (32 - LZ4_HASH_BITS);
+			const size_t ref = table[h];
+			table[h] = (uint32_t)pos + 1;
+			if(!ref || pos - (ref-1) > LZ4_MAX_OFFSET || memcmp(src + ref-1, src + pos, 4) != 0) {
+				++pos;
+				continue;
+			}
+			const size_t maxLen = size - LZ4_LAST_LITERALS - pos;
+			size_t len = LZ4_MIN_MATCH;
+			while(len < maxLen && src[ref-1 + len] == src[pos + len])
+				++len;
+			op = Lz4PutSequence(op, src + anchor, pos - anchor, pos - (ref-1), len);
+			pos += len;
+			anchor = pos;
+		}
+		free(table);
+	}
+	op = Lz4PutSequence(op, src + anchor, size - anchor, 0, 0);
+	return op - dest;
+}
+
+static size_t ArchiveCompressBound(size_t size) {
+	return size + size/255 + 16;
+}
+
+//--- pack archives ------------------------------------------------
+// Packs may also be appended to an executable as a bundle, followed by the name of the script to run
+// and a trailer of the little endian uint64 offset of the pack within the file, the uint32 length of
+// the script name, and BUNDLE_MAGIC.
+
+#define BUNDLE_MAGIC "arcmbdl1"
+#define BUNDLE_MAGIC_SIZE 8
+#define BUNDLE_TRAILER_SIZE (8 + 4 + BUNDLE_MAGIC_SIZE)
+
+static char* bundleScript = NULL;
+
+/// maps a pack starting at offset within a file
+static bool ArchiveOpenPack(const char* path, uint64_t offset) {
+	FILE* f = fopen(path, "rb");
+	if(!f)
+		return false;
+	char magic[PACK_MAGIC_SIZE];
+	const bool isPack = fseek(f, (long)offset, SEEK_SET) == 0 && fread(magic, 1, PACK_MAGIC_SIZE, f) == PACK_MAGIC_SIZE
+		&& memcmp(magic, PACK_MAGIC, PACK_MAGIC_SIZE) == 0;
+	fclose(f);
+	if(!isPack)
+		return false;
+#if ARCHIVE_MMAP
+	int fd = open(path, O_RDONLY);
+	struct stat st;
+	if(fd >= 0 && fstat(fd, &st) == 0 && (uint64_t)st.st_size > offset) {
+		const uint64_t mapOffset = offset - offset % (uint64_t)sysconf(_SC_PAGESIZE);
+		void* data = mmap(NULL, (size_t)(st.st_size - mapOffset), PROT_READ, MAP_PRIVATE, fd, (off_t)mapOffset);
+		if(data != MAP_FAILED) {
+			packMapping = data;
+			packMappingSize = archiveMappedBytes = (size_t)(st.st_size - mapOffset);
+			packData = (const uint8_t*)data + (offset - mapOffset);
+			packSize = (size_t)(st.st_size - offset);
+		}
+	}
+	if(fd >= 0)
+		close(fd);
+#endif
+	if(!packData)
+		packData = ArchiveReadFile(path, offset, &packSize);
+	if(!packData || packSize < PACK_HEADER_SIZE)
+		return false;
+
+	const uint32_t numEntries = arcmGet32(packData + PACK_MAGIC_SIZE);
+	const size_t indexEnd = PACK_HEADER_SIZE + (size_t)arcmGet32(packData + PACK_MAGIC_SIZE + 4);
+	if(indexEnd > packSize)
+		return false;
+	char* name = NULL;
+	for(const uint8_t* pos = packData + PACK_HEADER_SIZE; archiveNumEntries < numEntries; ) {
+		if(pos + PACK_ENTRY_SIZE > packData + indexEnd)
+			break;
+		const uint64_t entryOffset = arcmGet32(pos) | ((uint64_t)arcmGet32(pos+4) << 32);
+		const size_t size = arcmGet32(pos+8), packedSize = arcmGet32(pos+12);
+		const size_t nameLen = pos[16] | (pos[17] << 8);
+		pos += PACK_ENTRY_SIZE;
+		const size_t dataSize = packedSize ? packedSize : size+1; // stored entries are followed by NUL
+		if(pos + nameLen > packData + indexEnd || entryOffset < indexEnd || entryOffset > packSize
+			|| dataSize > packSize - entryOffset)
+			break;
+		// readers allocate the size given here, and hand out stored entries as NUL-terminated views
+		if(packedSize ? size > (uint64_t)packedSize * LZ4_MAX_RATIO : packData[entryOffset + size] != 0)
+			break;
+		name = (char*)realloc(name, nameLen+1);
+		memcpy(name, pos, nameLen);
+		name[nameLen] = 0;
+		pos += nameLen;
+		ArchiveEntry* entry = ArchiveAdd(name, size);
+		entry->offset = entryOffset;
+		entry->packedSize = packedSize;
+		if(!packedSize)
+			entry->data = packData + entryOffset;
+	}
+	free(name);
+	if(archiveNumEntries < numEntries) {
+		fprintf(stderr, "pack archive \"%s\" is corrupt\n", path);
+		return false;
+	}
+	return true;
+}
+
+/// writes the opened directory archive as a pack at the current position of a file
+/** @param stripSources leaves out files compiled to <name>.bc */
+static bool ArchiveWritePack(FILE* f, bool compress, bool stripSources) {
+	const long base = ftell(f);
+	bool* skipped = (bool*)calloc(archiveNumEntries+1, sizeof(bool));
+	size_t numEntries = 0, indexSize = 0;
+	for(size_t i=0; i<archiveNumEntries; ++i) {
+		const char* name = archiveEntries[i].name;
+		if(stripSources) {
+			char* bcName = (char*)malloc(strlen(name) + 4);
+			strcat(strcpy(bcName, name), ".bc");
+			skipped[i] = ArchiveFind(bcName) != NULL;
+			free(bcName);
+			if(skipped[i])
+				continue;
+		}
+		indexSize += PACK_ENTRY_SIZE + strlen(name);
+		++numEntries;
+	}
+	uint8_t* header = (uint8_t*)calloc(PACK_HEADER_SIZE + indexSize, 1);
+	memcpy(header, PACK_MAGIC, PACK_MAGIC_SIZE);
+	arcmPut32(header + PACK_MAGIC_SIZE, (uint32_t)numEntries);
+	arcmPut32(header + PACK_MAGIC_SIZE + 4, (uint32_t)indexSize);
+	bool success = base >= 0 && fwrite(header, 1, PACK_HEADER_SIZE + indexSize, f) == PACK_HEADER_SIZE + indexSize;
+
+	uint64_t offset = PACK_HEADER_SIZE + indexSize;
+	uint8_t* pos = header + PACK_HEADER_SIZE;
+	for(size_t i=0; i<archiveNumEntries && success; ++i) {
+		ArchiveEntry* entry = &archiveEntries[i];
+		if(skipped[i])
+			continue;
+		const size_t nameLen = strlen(entry->name);
+		if((!entry->data && !ArchiveLoad(entry)) || entry->size > UINT32_MAX || nameLen > UINT16_MAX) {
+			fprintf(stderr, "packing \"%s\" failed\n", entry->name);
+			success = false;
+			break;
+		}
+		uint8_t* packed = NULL;
+		size_t packedSize = 0;
+		if(compress && entry->size) {
+			packed = (uint8_t*)malloc(ArchiveCompressBound(entry->size));
+			packedSize = ArchiveCompress(entry->data, entry->size, packed);
+			if(packedSize >= entry->size - entry->size/16) // store entries barely shrinking
+				packedSize = 0;
+		}
+		const size_t dataSize = packedSize ? packedSize : entry->size+1;
+		success = fwrite(packedSize ? packed : entry->data, 1, dataSize, f) == dataSize;
+		free(packed);
+
+		arcmPut32(pos, (uint32_t)offset);
+		arcmPut32(pos+4, (uint32_t)(offset >> 32));
+		arcmPut32(pos+8, (uint32_t)entry->size);
+		arcmPut32(pos+12, (uint32_t)packedSize);
+		pos[16] = nameLen & 0xff;
+		pos[17] = nameLen >> 8;
+		memcpy(pos + PACK_ENTRY_SIZE, entry->name, nameLen);
+		pos += PACK_ENTRY_SIZE + nameLen;
+		offset += dataSize;
+		ArchiveUnload(entry);
+	}
+	if(success)
+		success = fseek(f, base, SEEK_SET) == 0
+			&& fwrite(header, 1, PACK_HEADER_SIZE + indexSize, f) == PACK_HEADER_SIZE + indexSize
+			&& fseek(f, 0, SEEK_END) == 0;
+	free(header);
+	free(skipped);
+	return success;
+}
+
+bool arcmArchivePack(const char* dirName, const char* packName, bool compress) {
+	if(!arcmArchiveOpen(dirName) || packData) {
+		arcmArchiveClose();
+		return false;
+	}
+	FILE* f = fopen(packName, "wb");
+	bool success = f && ArchiveWritePack(f, compress, false);
+	if(f && fclose(f) != 0)
+		success = false;
+	if(!success)
+		remove(packName);
+	arcmArchiveClose();
+	return success;
+}
+
+/// @return path of the running executable, to be freed by caller
+static char* ArchiveExePath(const char* exeName) {
+#ifdef __linux__
+	char path[4096];
+	const ssize_t len = readlink("/proc/self/exe", path, sizeof(path)-1);
+	if(len > 0) {
+		path[len] = 0;
+		return strdup(path);
+	}
+#endif
+	return strdup(exeName);
+}
+
+/// reads the trailer of a bundle
+/** @return false if the file has no bundle appended */
+static bool ArchiveBundleTrailer(const char* path, uint64_t* packOffset, char** scriptName) {
+	FILE* f = fopen(path, "rb");
+	if(!f)
+		return false;
+	uint8_t trailer[BUNDLE_TRAILER_SIZE];
+	bool found = fseek(f, -BUNDLE_TRAILER_SIZE, SEEK_END) == 0
+		&& fread(trailer, 1, BUNDLE_TRAILER_SIZE, f) == BUNDLE_TRAILER_SIZE
+		&& memcmp(trailer + 12, BUNDLE_MAGIC, BUNDLE_MAGIC_SIZE) == 0;
+	if(found) {
+		*packOffset = arcmGet32(trailer) | ((uint64_t)arcmGet32(trailer+4) << 32);
+		const uint32_t nameLen = arcmGet32(trailer+8);
+		*scriptName = nameLen < 4096 ? (char*)malloc(nameLen+1) : NULL;
+		found = *scriptName && fseek(f, -(long)(BUNDLE_TRAILER_SIZE + nameLen), SEEK_END) == 0
+			&& fread(*scriptName, 1, nameLen, f) == nameLen;
+		if(found)
+			(*scriptName)[nameLen] = 0;
+		else
+			free(*scriptName);
+	}
+	fclose(f);
+	return found;
+}
+
+const char* arcmArchiveOpenBundle(const char* exeName) {
+	arcmArchiveClose();
+	char* path = ArchiveExePath(exeName);
+	uint64_t packOffset;
+	char* scriptName;
+	if(!ArchiveBundleTrailer(path, &packOffset, &scriptName)) {
+		free(path);
+		return NULL;
+	}
+	archivePath = path;
+	if(!ArchiveOpenPack(path, packOffset)) {
+		free(scriptName);
+		arcmArchiveClose();
+		return NULL;
+	}
+	ArchiveBuildTable();
+	bundleScript = scriptName;
+	return bundleScript;
+}
+
+bool arcmArchiveBundle(const char* exeName, const char* dirName, const char* scriptName, const char* bundleName,
+	const char* scriptSuffix, bool (*compile)(const char* scriptName, const char* fileName))
+{
+	// scripts are shipped as bytecode only. It is compiled to a temporary file next to the bundle and
+	// kept as an in-memory entry <name>.bc, replacing any bytecode of the same name in the directory.
+	if(!arcmArchiveOpen(dirName) || packData) {
+		arcmArchiveClose();
+		return false;
+	}
+	bool success = true;
+	const size_t numSources = archiveNumEntries;
+	char* tmpName = (char*)malloc(strlen(bundleName) + 8);
+	sprintf(tmpName, "%s.bc.tmp", bundleName);
+	for(size_t i=0; i<numSources && success; ++i) {
+		const char* name = archiveEntries[i].name;
+		const char* suffix = strrchr(name, '.');
+		if(!suffix || strcmp(suffix+1, scriptSuffix) != 0)
+			continue;
+		size_t size = 0;
+		uint8_t* bytecode = compile(name, tmpName) ? ArchiveReadFile(tmpName, 0, &size) : NULL;
+		remove(tmpName);
+		if(!bytecode) {
+			fprintf(stderr, "compiling \"%s\" failed.\n", name);
+			success = false;
+			break;
+		}
+		char* bcName = (char*)malloc(strlen(name) + 4);
+		strcat(strcpy(bcName, name), ".bc");
+		ArchiveEntry* entry = ArchiveFind(bcName);
+		if(entry)
+			ArchiveUnload(entry);
+		else
+			entry = ArchiveAdd(bcName, 0);
+		entry->data = bytecode;
+		entry->size = size;
+		free(bcName);
+	}
+	free(tmpName);
+	// indexes the bytecode entries added
+	qsort(archiveEntries, archiveNumEntries, sizeof(ArchiveEntry), ArchiveCompareEntries);
+	free(archiveTable);
+	ArchiveBuildTable();
+
+	// the executable itself, without any bundle appended to it, followed by the pack and trailer
+	char* exePath = ArchiveExePath(exeName);
+	uint64_t exeSize = 0;
+	char* exeScript = NULL;
+	if(ArchiveBundleTrailer(exePath, &exeSize, &exeScript))
+		free(exeScript);
+	else
+		exeSize = UINT64_MAX;
+	FILE* exe = success ? fopen(exePath, "rb") : NULL;
+	FILE* f = exe ? fopen(bundleName, "wb") : NULL;
+	success = f != NULL;
+	char buf[16384];
+	for(uint64_t copied = 0; success && copied < exeSize; ) {
+		const size_t n = fread(buf, 1, exeSize - copied < sizeof(buf) ? (size_t)(exeSize - copied) : sizeof(buf), exe);
+		if(!n)
+			break;
+		success = fwrite(buf, 1, n, f) == n;
+		copied += n;
+	}
+	const long packOffset = f ? ftell(f) : -1;
+	success = success && packOffset >= 0 && ArchiveWritePack(f, true, true);
+	if(success) {
+		const uint32_t nameLen = (uint32_t)strlen(scriptName);
+		uint8_t trailer[BUNDLE_TRAILER_SIZE];
+		arcmPut32(trailer, (uint32_t)packOffset);
+		arcmPut32(trailer+4, (uint32_t)((uint64_t)packOffset >> 32));
+		arcmPut32(trailer+8, nameLen);
+		memcpy(trailer+12, BUNDLE_MAGIC, BUNDLE_MAGIC_SIZE);
+		success = fwrite(scriptName, 1, nameLen, f) == nameLen
+			&& fwrite(trailer, 1, BUNDLE_TRAILER_SIZE, f) == BUNDLE_TRAILER_SIZE;
+	}
+	if(f && fclose(f) != 0)
+		success = false;
+	if(exe)
+		fclose(exe);
+	if(f && !success)
+		remove(bundleName);
+#if ARCHIVE_MMAP
+	if(success)
+		chmod(bundleName, 0755);
+#endif
+	free(exePath);
+	arcmArchiveClose();
+	return success;
+}
+
+//--- archive access -----------------------------------------------
+
+bool arcmArchiveOpen(const char* path) {
+	arcmArchiveClose();
+	struct stat st;
+	if(stat(path, &st) != 0)
+		return false;
+	archivePath = strdup(path);
+	if(S_ISDIR(st.st_mode)) {
+		ArchiveReadDir("", 0);
+		qsort(archiveEntries, archiveNumEntries, sizeof(ArchiveEntry), ArchiveCompareEntries);
+	}
+	else if(!ArchiveOpenPack(path, 0)) {
+		arcmArchiveClose();
+		return false;
+	}
+	ArchiveBuildTable();
+	return true;
+}
+
+bool arcmArchivePacked() {
+	return packData != NULL;
+}
+
+bool arcmArchiveContains(const char* name) {
+	return ArchiveFind(name) != NULL;
+}
+
+const char* arcmArchiveEntry(size_t index) {
+	return index < archiveNumEntries ? archiveEntries[index].name : NULL;
+}
+
+const void* arcmArchiveView(const char* name, size_t* size) {
+	ArchiveEntry* entry = ArchiveFind(name);
+	if(!entry || entry->packedSize || (!entry->data && !ArchiveLoad(entry)))
+		return NULL;
+	if(size)
+		*size = entry->size;
+	return entry->data;
+}
+
+void* arcmArchiveRead(const char* name, size_t* size) {
+	ArchiveEntry* entry = ArchiveFind(name);
+	// the size of directory entries is updated on loading, pack entries were checked on opening
+	if(!entry || (!entry->packedSize && !entry->data && !ArchiveLoad(entry)))
+		return NULL;
+	uint8_t* data = (uint8_t*)malloc(entry->size+1);
+	if(!data) {
+		fprintf(stderr, "reading \"%s\" failed, out of memory\n", entry->name);
+		return NULL;
+	}
+	if(!entry->packedSize)
+		memcpy(data, entry->data, entry->size);
+	else if(ArchiveDecompress(packData + entry->offset, entry->packedSize, data, entry->size))
+		archiveInflatedBytes += entry->size;
+	else {
+		fprintf(stderr, "decompressing \"%s\" failed\n", entry->name);
+		free(data);
+		return NULL;
+	}
+	data[entry->size] = 0;
+	if(size)
+		*size = entry->size;
+	return data;
+}
+
+double arcmArchiveStats(const char* name) {
+	if(!strcmp(name, "archiveEntries"))
+		return (double)archiveNumEntries;
+	if(!strcmp(name, "archiveMapped"))
+		return (double)archiveMappedBytes;
+	if(!strcmp(name, "archiveInflated"))
+		return (double)archiveInflatedBytes;
+	return NAN;
+}
+
+void arcmArchiveClose() {
+	for(size_t i=0; i<archiveNumEntries; ++i) {
+		ArchiveUnload(&archiveEntries[i]);
+		free(archiveEntries[i].name);
+	}
+#if ARCHIVE_MMAP
+	if(packMapping)
+		munmap(packMapping, packMappingSize);
+	else
+#endif
+	free((void*)packData);
+	free(bundleScript);
+	free(archiveEntries);
+	free(archiveTable);
+	free(archivePath);
+	archiveEntries = NULL;
+	archiveTable = NULL;
+	archivePath = NULL;
+	packData = NULL;
+	packMapping = NULL;
+	bundleScript = NULL;
+	archiveNumEntries = archiveCapacity = archiveTableSize = archiveMappedBytes = archiveInflatedBytes = packSize = packMappingSize = 0;
+}
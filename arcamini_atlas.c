@@ -0,0 +1,215 @@
+#include "arcamini.h"
+
+#include "graphics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+//--- texture atlas ------------------------------------------------
+// Images are sorted by height and packed by a skyline bottom-left packer into square RGBA pages.
+// Each image gets a border of 1 pixel replicating its edges, so that bilinear filtering does not
+// bleed neighboring images into it. Images are returned as tiles of their page.
+
+/// maximum edge length of an atlas page, larger images are uploaded separately
+#define ATLAS_MAX_SIZE 2048
+#define ATLAS_MIN_SIZE 256
+#define ATLAS_BORDER 1
+
+typedef struct {
+	size_t index; ///< position in the list of requested images
+	unsigned char* pixels; ///< RGBA
+	int width, height;
+	int x, y, page; ///< position of the top left pixel within its page, excluding the border
+} AtlasImage;
+
+typedef struct {
+	int x, y, width;
+} AtlasSegment;
+
+typedef struct {
+	AtlasSegment* segments;
+	int numSegments;
+	int size;
+} AtlasSkyline;
+
+static void AtlasSkylineReset(AtlasSkyline* sky, int size) {
+	sky->size = size;
+	sky->numSegments = 1;
+	sky->segments[0].x = sky->segments[0].y = 0;
+	sky->segments[0].width = size;
+}
+
+/// @return the lowest y at which a rectangle of width w fits at segment i, or -1 if it does not fit
+static int AtlasSkylineFit(const AtlasSkyline* sky, int i, int w) {
+	const int x = sky->segments[i].x;
+	if(x + w > sky->size)
+		return -1;
+	int y = 0;
+	for(int remaining = w; remaining > 0; ++i) {
+		if(sky->segments[i].y > y)
+			y = sky->segments[i].y;
+		remaining -= sky->segments[i].width;
+	}
+	return y;
+}
+
+/// places a w x h rectangle on the skyline
+/** @return false if it does not fit */
+static bool AtlasSkylinePlace(AtlasSkyline* sky, int w, int h, int* px, int* py) {
+	int best = -1, bestY = sky->size, bestX = 0;
+	for(int i=0; i<sky->numSegments; ++i) {
+		const int y = AtlasSkylineFit(sky, i, w);
+		if(y >= 0 && y + h <= sky->size && y < bestY) {
+			best = i;
+			bestY = y;
+			bestX = sky->segments[i].x;
+		}
+	}
+	if(best < 0)
+		return false;
+
+	// replace the covered segments by a new one on top of the rectangle
+	int last = best, right = bestX + w;
+	while(last < sky->numSegments && sky->segments[last].x + sky->segments[last].width <= right)
+		++last;
+	if(last < sky->numSegments && sky->segments[last].x < right) { // partially covered
+		sky->segments[last].width -= right - sky->segments[last].x;
+		sky->segments[last].x = right;
+	}
+	const int removed = last - best;
+	memmove(&sky->segments[best+1], &sky->segments[last], (sky->numSegments - last) * sizeof(AtlasSegment));
+	sky->numSegments += 1 - removed;
+	sky->segments[best].x = bestX;
+	sky->segments[best].y = bestY + h;
+	sky->segments[best].width = w;
+
+	// merge neighbors of equal height
+	for(int i = sky->numSegments-1; i > 0; --i) {
+		if(sky->segments[i-1].y == sky->segments[i].y) {
+			sky->segments[i-1].width += sky->segments[i].width;
+			memmove(&sky->segments[i], &sky->segments[i+1], (sky->numSegments - i - 1) * sizeof(AtlasSegment));
+			--sky->numSegments;
+		}
+	}
+	*px = bestX;
+	*py = bestY;
+	return true;
+}
+
+static int AtlasCompareHeight(const void* a, const void* b) {
+	const AtlasImage* imgA = (const AtlasImage*)a, * imgB = (const AtlasImage*)b;
+	if(imgA->height != imgB->height)
+		return imgB->height - imgA->height;
+	return imgB->width - imgA->width;
+}
+
+/// converts decoded pixels to RGBA in place, if necessary
+static unsigned char* AtlasToRGBA(unsigned char* pixels, int w, int h, int d) {
+	if(d == 4)
+		return pixels;
+	if(d != 3) {
+		free(pixels);
+		return NULL;
+	}
+	unsigned char* rgba = (unsigned char*)realloc(pixels, (size_t)w * h * 4);
+	for(size_t i = (size_t)w * h; i-- > 0; ) {
+		rgba[i*4+3] = 0xff;
+		memmove(&rgba[i*4], &rgba[i*3], 3);
+	}
+	return rgba;
+}
+
+/// copies an image and its replicated edges into a page
+static void AtlasBlit(unsigned char* page, int pageSize, const AtlasImage* img) {
+	const size_t rowSize = (size_t)img->width * 4;
+	for(int y = -ATLAS_BORDER; y < img->height + ATLAS_BORDER; ++y) {
+		const int srcY = y < 0 ? 0 : y >= img->height ? img->height-1 : y;
+		const unsigned char* src = &img->pixels[srcY * rowSize];
+		unsigned char* dest = &page[((size_t)(img->y + y) * pageSize + img->x) * 4];
+		memcpy(dest, src, rowSize);
+		for(int b = 1; b <= ATLAS_BORDER; ++b) {
+			memcpy(dest - b*4, src, 4);
+			memcpy(dest + rowSize + (b-1)*4, src + rowSize - 4, 4);
+		}
+	}
+}
+
+size_t arcmResourceCreateAtlas(const char** names, size_t numNames, float scale,
+	float centerX, float centerY, int filtering, uint32_t* handles)
+{
+	AtlasImage* images = (AtlasImage*)calloc(numNames ? numNames : 1, sizeof(AtlasImage));
+	size_t numImages = 0, area = 0;
+	int maxEdge = 0;
+	memset(handles, 0, numNames * sizeof(uint32_t));
+	gfxTextureFiltering(filtering);
+	for(size_t i=0; i<numNames; ++i) {
+		AtlasImage* img = &images[numImages];
+		int d = 0;
+		img->pixels = arcmResourceDecodeImage(names[i], scale, &img->width, &img->height, &d);
+		if(img->pixels)
+			img->pixels = AtlasToRGBA(img->pixels, img->width, img->height, d);
+		if(!img->pixels) {
+			fprintf(stderr, "atlas image \"%s\" could not be loaded\n", names[i]);
+			continue;
+		}
+		img->index = i;
+		const int w = img->width + 2*ATLAS_BORDER, h = img->height + 2*ATLAS_BORDER;
+		if(w > ATLAS_MAX_SIZE || h > ATLAS_MAX_SIZE) { // does not fit into any page
+			handles[i] = gfxImageUpload(img->pixels, img->width, img->height, 4, 0xff);
+			gfxImageSetCenter(handles[i], centerX, centerY);
+			free(img->pixels);
+			continue;
+		}
+		area += (size_t)w * h;
+		if(w > maxEdge)
+			maxEdge = w;
+		if(h > maxEdge)
+			maxEdge = h;
+		++numImages;
+	}
+	qsort(images, numImages, sizeof(AtlasImage), AtlasCompareHeight);
+
+	// smallest page size likely to hold all images, packers rarely exceed 90% utilization
+	int pageSize = ATLAS_MIN_SIZE;
+	while(pageSize < maxEdge || (pageSize < ATLAS_MAX_SIZE && (size_t)pageSize * pageSize * 9 < area * 10))
+		pageSize *= 2;
+
+	AtlasSkyline sky;
+	sky.segments = (AtlasSegment*)malloc((pageSize + 1) * sizeof(AtlasSegment));
+	AtlasSkylineReset(&sky, pageSize);
+	size_t numPages = numImages ? 1 : 0;
+	for(size_t i=0; i<numImages; ++i) {
+		AtlasImage* img = &images[i];
+		const int w = img->width + 2*ATLAS_BORDER, h = img->height + 2*ATLAS_BORDER;
+		if(!AtlasSkylinePlace(&sky, w, h, &img->x, &img->y)) {
+			++numPages;
+			AtlasSkylineReset(&sky, pageSize);
+			AtlasSkylinePlace(&sky, w, h, &img->x, &img->y);
+		}
+		img->x += ATLAS_BORDER;
+		img->y += ATLAS_BORDER;
+		img->page = (int)numPages - 1;
+	}
+	free(sky.segments);
+
+	unsigned char* page = numPages ? (unsigned char*)malloc((size_t)pageSize * pageSize * 4) : NULL;
+	for(size_t p = 0, i = 0; p < numPages; ++p) {
+		memset(page, 0, (size_t)pageSize * pageSize * 4);
+		const size_t first = i;
+		for(; i < numImages && images[i].page == (int)p; ++i)
+			AtlasBlit(page, pageSize, &images[i]);
+		const uint32_t pageHandle = gfxImageUpload(page, pageSize, pageSize, 4, 0xff);
+		for(size_t j = first; pageHandle && j < i; ++j) {
+			const AtlasImage* img = &images[j];
+			handles[img->index] = gfxImageTile(pageHandle, img->x, img->y, img->width, img->height);
+			gfxImageSetCenter(handles[img->index], centerX, centerY);
+		}
+	}
+	free(page);
+	for(size_t i=0; i<numImages; ++i)
+		free(images[i].pixels);
+	free(images);
+	return numPages;
+}
@@ -0,0 +1,191 @@
+#include "arcamini.h"
+
+#include "audio.h"
+#include "SDL.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/stat.h>
+
+#if defined __WIN32__ || defined WIN32
+#define AUDIOCACHE_MMAP 0
+#else
+#define AUDIOCACHE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+//--- decoded audio cache ------------------------------------------
+// Decoding MP3 files takes a considerable part of startup for games with many sound effects, so their
+// decoded samples are kept in a cache directory, named by a 64 bit FNV-1a hash of the encoded file and
+// the device sample rate. WAV files are only converted, not decoded, and are not cached. A cache file
+// consists of AUDIOCACHE_MAGIC, the little endian uint64 hash, uint32 sample rate, number of frames,
+// number of channels, offset, sample format, and a uint32 checksum of the samples, followed by the
+// interleaved samples. Files not matching their hash, sample rate, size, format, or checksum are ignored.
+// Samples are stored as float by default, so cached samples are bit-identical to freshly decoded ones.
+// Building with AUDIOCACHE_INT16=1 halves the size of cache files at the price of a lossy conversion:
+// samples are clamped to [-1, 1] and quantized to 16 bit, so warm starts play slightly different audio.
+
+#define AUDIOCACHE_MAGIC "arcmpcm1"
+#define AUDIOCACHE_MAGIC_SIZE 8
+#define AUDIOCACHE_HEADER_SIZE (AUDIOCACHE_MAGIC_SIZE + 8 + 6*4)
+#ifndef AUDIOCACHE_INT16
+/// stores samples as int16 instead of float, halving the size of cache files, but lossy
+#define AUDIOCACHE_INT16 0
+#endif
+
+typedef enum { AUDIOCACHE_FLOAT32 = 0, AUDIOCACHE_S16 = 1 } AudioCacheFormat;
+/// sample format of cache files written and accepted by this build
+#define AUDIOCACHE_FORMAT (AUDIOCACHE_INT16 ? AUDIOCACHE_S16 : AUDIOCACHE_FLOAT32)
+
+static char* audioCachePath = NULL;
+
+static char* AudioCacheFileName(uint64_t hash, const char* suffix) {
+	char* fname = (char*)malloc(strlen(audioCachePath) + 16 + strlen(suffix) + 1);
+	sprintf(fname, "%s%08x%08x%s", audioCachePath, (uint32_t)(hash >> 32), (uint32_t)hash, suffix);
+	return fname;
+}
+
+/// converts the samples of a cache file, which are little endian like its header
+static float* AudioCacheConvert(const uint8_t* src, AudioCacheFormat format, size_t count) {
+	float* samples = (float*)malloc(count * sizeof(float));
+	if(!samples)
+		return NULL;
+	if(format == AUDIOCACHE_S16)
+		for(size_t i=0; i<count; ++i, src += 2)
+			samples[i] = (int16_t)(src[0] | (src[1] << 8)) * (1.0f / 32767.0f);
+	else
+		for(size_t i=0; i<count; ++i, src += 4) {
+			const uint32_t bits = arcmGet32(src);
+			memcpy(&samples[i], &bits, sizeof(float));
+		}
+	return samples;
+}
+
+static float* AudioCacheParse(const uint8_t* file, size_t size, uint64_t hash, uint32_t sampleRate,
+	uint32_t* numSamples, uint8_t* numChannels, uint32_t* offset)
+{
+	if(size < AUDIOCACHE_HEADER_SIZE || memcmp(file, AUDIOCACHE_MAGIC, AUDIOCACHE_MAGIC_SIZE) != 0
+		|| arcmGet32(file+8) != (uint32_t)hash || arcmGet32(file+12) != (uint32_t)(hash >> 32))
+		return NULL;
+	const uint8_t* fields = file + AUDIOCACHE_MAGIC_SIZE + 8;
+	const uint32_t frames = arcmGet32(fields+4), channels = arcmGet32(fields+8);
+	const AudioCacheFormat format = (AudioCacheFormat)arcmGet32(fields+16);
+	const size_t count = (size_t)frames * channels;
+	const size_t dataSize = count * (format == AUDIOCACHE_S16 ? 2 : 4);
+	if(arcmGet32(fields) != sampleRate || format != AUDIOCACHE_FORMAT
+		|| !count || (channels != 1 && channels != 2) || size - AUDIOCACHE_HEADER_SIZE != dataSize
+		|| (uint32_t)arcmHash(file + AUDIOCACHE_HEADER_SIZE, dataSize, ARCM_HASH_SEED) != arcmGet32(fields+20))
+		return NULL;
+	float* samples = AudioCacheConvert(file + AUDIOCACHE_HEADER_SIZE, format, count);
+	if(samples) {
+		*numSamples = frames;
+		*numChannels = (uint8_t)channels;
+		*offset = arcmGet32(fields+12);
+	}
+	return samples;
+}
+
+static float* AudioCacheRead(uint64_t hash, uint32_t sampleRate, uint32_t* numSamples, uint8_t* numChannels, uint32_t* offset) {
+	char* fname = AudioCacheFileName(hash, ".pcm");
+	float* samples = NULL;
+#if AUDIOCACHE_MMAP
+	int fd = open(fname, O_RDONLY);
+	free(fname);
+	if(fd < 0)
+		return NULL;
+	struct stat st;
+	if(fstat(fd, &st) == 0 && st.st_size > 0) {
+		void* file = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(file != MAP_FAILED) {
+			samples = AudioCacheParse((const uint8_t*)file, (size_t)st.st_size, hash, sampleRate, numSamples, numChannels, offset);
+			munmap(file, (size_t)st.st_size);
+		}
+	}
+	close(fd);
+#else
+	FILE* f = fopen(fname, "rb");
+	free(fname);
+	if(!f)
+		return NULL;
+	struct stat st;
+	uint8_t* file = fstat(fileno(f), &st) == 0 && st.st_size > 0 ? (uint8_t*)malloc((size_t)st.st_size) : NULL;
+	if(file && fread(file, 1, (size_t)st.st_size, f) == (size_t)st.st_size)
+		samples = AudioCacheParse(file, (size_t)st.st_size, hash, sampleRate, numSamples, numChannels, offset);
+	free(file);
+	fclose(f);
+#endif
+	return samples;
+}
+
+static void AudioCacheWrite(uint64_t hash, uint32_t sampleRate, const float* samples, uint32_t numSamples, uint8_t numChannels, uint32_t offset) {
+	const size_t count = (size_t)numSamples * numChannels;
+	const AudioCacheFormat format = AUDIOCACHE_FORMAT;
+	const size_t dataSize = count * (format == AUDIOCACHE_S16 ? 2 : 4);
+	uint8_t* data = (uint8_t*)malloc(dataSize);
+	if(!data)
+		return;
+	for(size_t i=0; i<count; ++i) {
+		if(format == AUDIOCACHE_S16) {
+			const float value = samples[i] < -1.0f ? -1.0f : samples[i] > 1.0f ? 1.0f : samples[i];
+			const int16_t s16 = (int16_t)(value * 32767.0f + (value < 0.0f ? -0.5f : 0.5f));
+			data[2*i] = (uint16_t)s16 & 0xff;
+			data[2*i+1] = (uint16_t)s16 >> 8;
+		}
+		else {
+			uint32_t bits;
+			memcpy(&bits, &samples[i], sizeof(float));
+			arcmPut32(data + 4*i, bits);
+		}
+	}
+
+	uint8_t header[AUDIOCACHE_HEADER_SIZE];
+	memcpy(header, AUDIOCACHE_MAGIC, AUDIOCACHE_MAGIC_SIZE);
+	arcmPut32(header+8, (uint32_t)hash);
+	arcmPut32(header+12, (uint32_t)(hash >> 32));
+	arcmPut32(header+16, sampleRate);
+	arcmPut32(header+20, numSamples);
+	arcmPut32(header+24, numChannels);
+	arcmPut32(header+28, offset);
+	arcmPut32(header+32, format);
+	arcmPut32(header+36, (uint32_t)arcmHash(data, dataSize, ARCM_HASH_SEED));
+
+	char* fname = AudioCacheFileName(hash, ".pcm");
+	arcmWriteFileAtomic(fname, header, AUDIOCACHE_HEADER_SIZE, data, dataSize);
+	free(fname);
+	free(data);
+}
+
+float* arcmAudioDecode(const void* data, size_t numBytes, uint32_t* numSamples, uint8_t* numChannels, uint32_t* offset) {
+	const bool cached = audioCachePath && (numBytes < 4 || memcmp(data, "RIFF", 4) != 0);
+	const uint32_t sampleRate = AudioSampleRate();
+	uint64_t hash = 0;
+	if(cached) {
+		hash = arcmHash(data, numBytes, ARCM_HASH_SEED);
+		hash = arcmHash(&sampleRate, sizeof(sampleRate), hash);
+		float* samples = AudioCacheRead(hash, sampleRate, numSamples, numChannels, offset);
+		if(samples)
+			return samples;
+	}
+	// decoders only read their input
+	float* samples = AudioRead((void*)data, (uint32_t)numBytes, numSamples, numChannels, offset);
+	if(samples && cached && *numSamples)
+		AudioCacheWrite(hash, sampleRate, samples, *numSamples, *numChannels, *offset);
+	return samples;
+}
+
+void arcmAudioCacheInit(const char* appName) {
+	char* prefPath = SDL_GetPrefPath(appName, "audiocache");
+	if(prefPath) {
+		audioCachePath = strdup(prefPath);
+		SDL_free(prefPath);
+	}
+}
+
+void arcmAudioCacheClose() {
+	free(audioCachePath);
+	audioCachePath = NULL;
+}
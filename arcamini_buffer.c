@@ -0,0 +1,131 @@
+#include "arcamini.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+//--- typed buffers ------------------------------------------------
+// Lua and pocketpy have no typed arrays, so bulk data like pixels, samples, or sprite positions would
+// have to be passed as tables or lists of boxed numbers, converted element by element by each binding.
+// Buffers are fixed-size contiguous arrays allocated by the VM as userdata, this header followed by the
+// elements. Bindings accepting bulk data use their elements in place, and scripts process them in
+// bulk by the element-wise operations below. Integer elements round and saturate, like Uint8ClampedArray.
+
+static const char* bufferTypeNames[] = { "float32", "uint32", "uint8" };
+static const size_t bufferElementSizes[] = { sizeof(float), sizeof(uint32_t), sizeof(uint8_t) };
+static const double bufferMaxValues[] = { INFINITY, 4294967295.0, 255.0 };
+
+int arcmBufferTypeId(const char* name) {
+	for(int i=0; i<3; ++i)
+		if(strcmp(name, bufferTypeNames[i]) == 0)
+			return i;
+	return -1;
+}
+
+const char* arcmBufferTypeName(ArcmBufferType type) {
+	return bufferTypeNames[type];
+}
+
+size_t arcmBufferElementSize(ArcmBufferType type) {
+	return bufferElementSizes[type];
+}
+
+size_t arcmBufferSize(ArcmBufferType type, size_t count) {
+	if(count > UINT32_MAX || count > (SIZE_MAX - sizeof(ArcmBuffer)) / bufferElementSizes[type])
+		return 0;
+	return sizeof(ArcmBuffer) + count * bufferElementSizes[type];
+}
+
+void arcmBufferInit(ArcmBuffer* buf, ArcmBufferType type, size_t count) {
+	buf->type = type;
+	buf->count = (uint32_t)count;
+	memset(arcmBufferData(buf), 0, count * bufferElementSizes[type]);
+}
+
+double arcmBufferGet(const ArcmBuffer* buf, size_t index) {
+	switch(buf->type) {
+	case ARCM_BUFFER_FLOAT32: return ((const float*)arcmBufferData(buf))[index];
+	case ARCM_BUFFER_UINT32: return ((const uint32_t*)arcmBufferData(buf))[index];
+	default: return ((const uint8_t*)arcmBufferData(buf))[index];
+	}
+}
+
+void arcmBufferSet(ArcmBuffer* buf, size_t index, double value) {
+	if(buf->type == ARCM_BUFFER_FLOAT32) {
+		((float*)arcmBufferData(buf))[index] = (float)value;
+		return;
+	}
+	value = value >= 0.0 ? floor(value + 0.5) : 0.0; // NaN saturates to 0 as well
+	if(value > bufferMaxValues[buf->type])
+		value = bufferMaxValues[buf->type];
+	if(buf->type == ARCM_BUFFER_UINT32)
+		((uint32_t*)arcmBufferData(buf))[index] = (uint32_t)value;
+	else
+		((uint8_t*)arcmBufferData(buf))[index] = (uint8_t)value;
+}
+
+void arcmBufferFill(ArcmBuffer* buf, double value, size_t first, size_t count) {
+	if(!count)
+		return;
+	arcmBufferSet(buf, first, value);
+	const size_t elemSize = bufferElementSizes[buf->type];
+	uint8_t* data = (uint8_t*)arcmBufferData(buf) + first * elemSize;
+	for(size_t i=1; i<count; ++i)
+		memcpy(data + i * elemSize, data, elemSize);
+}
+
+void arcmBufferSlice(ArcmBuffer* dst, const ArcmBuffer* src, size_t first) {
+	const size_t elemSize = bufferElementSizes[src->type];
+	memcpy(arcmBufferData(dst), (const uint8_t*)arcmBufferData(src) + first * elemSize, dst->count * elemSize);
+}
+
+static inline double BufferOp(ArcmBufferOp op, double a, double b) {
+	switch(op) {
+	case ARCM_BUFFER_ADD: return a + b;
+	case ARCM_BUFFER_MUL: return a * b;
+	case ARCM_BUFFER_MIN: return b < a ? b : a;
+	default: return b > a ? b : a;
+	}
+}
+
+bool arcmBufferApply(ArcmBuffer* buf, ArcmBufferOp op, const ArcmBuffer* src, double scalar) {
+	if(src && src->count != buf->count)
+		return false;
+	const size_t n = buf->count;
+	// float buffers, the common case of audio samples and coordinates, are processed without conversions
+	if(buf->type == ARCM_BUFFER_FLOAT32 && (!src || src->type == ARCM_BUFFER_FLOAT32)) {
+		float* a = (float*)arcmBufferData(buf);
+		const float* b = src ? (const float*)arcmBufferData(src) : NULL;
+		const float s = (float)scalar;
+		if(op == ARCM_BUFFER_ADD && b)
+			for(size_t i=0; i<n; ++i)
+				a[i] += b[i] * s;
+		else if(op == ARCM_BUFFER_ADD)
+			for(size_t i=0; i<n; ++i)
+				a[i] += s;
+		else if(op == ARCM_BUFFER_MUL && b)
+			for(size_t i=0; i<n; ++i)
+				a[i] *= b[i];
+		else if(op == ARCM_BUFFER_MUL)
+			for(size_t i=0; i<n; ++i)
+				a[i] *= s;
+		else for(size_t i=0; i<n; ++i)
+			a[i] = (float)BufferOp(op, a[i], b ? b[i] : s);
+		return true;
+	}
+	for(size_t i=0; i<n; ++i) {
+		double operand = scalar;
+		if(src)
+			operand = op == ARCM_BUFFER_ADD ? arcmBufferGet(src, i) * scalar : arcmBufferGet(src, i);
+		arcmBufferSet(buf, i, BufferOp(op, arcmBufferGet(buf, i), operand));
+	}
+	return true;
+}
+
+double arcmBufferSum(const ArcmBuffer* buf) {
+	double sum = 0.0;
+	for(size_t i=0; i<buf->count; ++i)
+		sum += arcmBufferGet(buf, i);
+	return sum;
+}
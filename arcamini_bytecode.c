@@ -0,0 +1,232 @@
+#include "arcamini.h"
+
+#include "SDL.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+//--- bytecode cache -----------------------------------------------
+// Compiled scripts are kept in a cache directory, named by a 64 bit FNV-1a hash of the VM's bytecode
+// format, the script name, and its source. Scripts may also be shipped as bytecode only, as
+// <name>.bc files in the resource archive. Both consist of BYTECODE_MAGIC, the NUL-padded format
+// identifier, the little endian uint64 source hash (0 for shipped bytecode), uint32 bytecode size,
+// and uint32 checksum, followed by the bytecode. Files not matching these are ignored.
+
+#define BYTECODE_MAGIC "arcmbc1\n"
+#define BYTECODE_MAGIC_SIZE 8
+#define BYTECODE_FORMAT_SIZE 16
+#define BYTECODE_HEADER_SIZE (BYTECODE_MAGIC_SIZE + BYTECODE_FORMAT_SIZE + 8 + 4 + 4)
+
+static char* bytecodePath = NULL;
+
+/// a script's bytecode looked up ahead by arcmBytecodePrefetch
+static struct {
+	char* name; ///< NULL if none
+	uint64_t hash;
+	char format[BYTECODE_FORMAT_SIZE+1];
+	void* data;
+	size_t size;
+} bytecodePrefetched;
+
+static uint64_t BytecodeKey(const char* name, const char* source, const char* format) {
+	uint64_t hash = arcmHash(format, strlen(format)+1, ARCM_HASH_SEED);
+	hash = arcmHash(name, strlen(name)+1, hash);
+	hash = arcmHash(source, strlen(source), hash);
+	return hash ? hash : 1; // 0 denotes shipped bytecode
+}
+
+static void BytecodeHeader(uint8_t* header, const char* format, uint64_t hash, const void* bytecode, size_t size) {
+	memset(header, 0, BYTECODE_HEADER_SIZE);
+	memcpy(header, BYTECODE_MAGIC, BYTECODE_MAGIC_SIZE);
+	strncpy((char*)header + BYTECODE_MAGIC_SIZE, format, BYTECODE_FORMAT_SIZE);
+	uint8_t* pos = header + BYTECODE_MAGIC_SIZE + BYTECODE_FORMAT_SIZE;
+	arcmPut32(pos, (uint32_t)hash);
+	arcmPut32(pos+4, (uint32_t)(hash >> 32));
+	arcmPut32(pos+8, (uint32_t)size);
+	arcmPut32(pos+12, (uint32_t)arcmHash(bytecode, size, ARCM_HASH_SEED));
+}
+
+/// validates a cache or shipped file and moves its bytecode to the start of the buffer
+/** @return bytecode size, or 0 if invalid */
+static size_t BytecodeValidate(uint8_t* data, size_t numBytes, const char* format, uint64_t hash) {
+	if(numBytes < BYTECODE_HEADER_SIZE || memcmp(data, BYTECODE_MAGIC, BYTECODE_MAGIC_SIZE) != 0
+		|| strncmp((const char*)data + BYTECODE_MAGIC_SIZE, format, BYTECODE_FORMAT_SIZE) != 0)
+		return 0;
+	const uint8_t* pos = data + BYTECODE_MAGIC_SIZE + BYTECODE_FORMAT_SIZE;
+	const size_t size = arcmGet32(pos+8);
+	if(arcmGet32(pos) != (uint32_t)hash || arcmGet32(pos+4) != (uint32_t)(hash >> 32)
+		|| size > numBytes - BYTECODE_HEADER_SIZE
+		|| (uint32_t)arcmHash(data + BYTECODE_HEADER_SIZE, size, ARCM_HASH_SEED) != arcmGet32(pos+12))
+		return 0;
+	memmove(data, data + BYTECODE_HEADER_SIZE, size);
+	return size;
+}
+
+static char* BytecodeFileName(uint64_t hash, const char* suffix) {
+	char* fname = (char*)malloc(strlen(bytecodePath) + 16 + strlen(suffix) + 1);
+	sprintf(fname, "%s%08x%08x%s", bytecodePath, (uint32_t)(hash >> 32), (uint32_t)hash, suffix);
+	return fname;
+}
+
+void* arcmBytecodeLoad(const char* name, const char* source, const char* format, size_t* size) {
+	size_t numBytes = 0;
+	uint8_t* data = NULL;
+	const uint64_t hash = source ? BytecodeKey(name, source, format) : 0;
+	if(bytecodePrefetched.name && bytecodePrefetched.hash == hash && strcmp(bytecodePrefetched.name, name) == 0
+		&& strncmp(bytecodePrefetched.format, format, BYTECODE_FORMAT_SIZE) == 0) {
+		data = (uint8_t*)malloc(bytecodePrefetched.size ? bytecodePrefetched.size : 1);
+		memcpy(data, bytecodePrefetched.data, bytecodePrefetched.size);
+		*size = bytecodePrefetched.size;
+		return data;
+	}
+	if(source) {
+		if(!bytecodePath)
+			return NULL;
+		char* fname = BytecodeFileName(hash, ".bc");
+		FILE* f = fopen(fname, "rb");
+		free(fname);
+		if(!f)
+			return NULL;
+		fseek(f, 0, SEEK_END);
+		const long fileSize = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		if(fileSize > 0) {
+			data = (uint8_t*)malloc(fileSize);
+			numBytes = fread(data, 1, fileSize, f);
+		}
+		fclose(f);
+	}
+	else { // shipped without source
+		char* bcName = (char*)malloc(strlen(name) + 4);
+		strcat(strcpy(bcName, name), ".bc");
+		void* copy;
+		const void* view = arcmResourceBinary(bcName, &numBytes, &copy);
+		free(bcName);
+		if(view && !copy) { // validated in place
+			copy = malloc(numBytes ? numBytes : 1);
+			memcpy(copy, view, numBytes);
+		}
+		data = (uint8_t*)copy;
+	}
+	if(!data)
+		return NULL;
+	*size = BytecodeValidate(data, numBytes, format, hash);
+	if(!*size) {
+		free(data);
+		return NULL;
+	}
+	return data;
+}
+
+void arcmBytecodeStore(const char* name, const char* source, const char* format, const void* bytecode, size_t size) {
+	if(!bytecodePath)
+		return;
+	const uint64_t hash = BytecodeKey(name, source, format);
+	uint8_t header[BYTECODE_HEADER_SIZE];
+	BytecodeHeader(header, format, hash, bytecode, size);
+	char* fname = BytecodeFileName(hash, ".bc");
+	arcmWriteFileAtomic(fname, header, BYTECODE_HEADER_SIZE, bytecode, size);
+	free(fname);
+}
+
+bool arcmBytecodeShip(const char* fileName, const char* format, const void* bytecode, size_t size) {
+	uint8_t header[BYTECODE_HEADER_SIZE];
+	BytecodeHeader(header, format, 0, bytecode, size);
+	return arcmWriteFileAtomic(fileName, header, BYTECODE_HEADER_SIZE, bytecode, size);
+}
+
+bool arcmBytecodeShipped(const char* name, const char* format) {
+	size_t size;
+	void* bytecode = arcmBytecodeLoad(name, NULL, format, &size);
+	free(bytecode);
+	return bytecode != NULL;
+}
+
+void arcmBytecodePrefetch(const char* name, const char* source, const char* format) {
+	size_t size;
+	void* data = arcmBytecodeLoad(name, source, format, &size);
+	if(!data)
+		return;
+	free(bytecodePrefetched.name);
+	free(bytecodePrefetched.data);
+	bytecodePrefetched.name = strdup(name);
+	bytecodePrefetched.hash = source ? BytecodeKey(name, source, format) : 0;
+	strncpy(bytecodePrefetched.format, format, BYTECODE_FORMAT_SIZE);
+	bytecodePrefetched.data = data;
+	bytecodePrefetched.size = size;
+}
+
+void arcmBytecodeCacheInit(const char* appName) {
+	char* prefPath = SDL_GetPrefPath(appName, "bytecode");
+	if(prefPath) {
+		bytecodePath = strdup(prefPath);
+		SDL_free(prefPath);
+	}
+}
+
+void arcmBytecodeCacheClose() {
+	free(bytecodePath);
+	bytecodePath = NULL;
+	free(bytecodePrefetched.name);
+	free(bytecodePrefetched.data);
+	memset(&bytecodePrefetched, 0, sizeof(bytecodePrefetched));
+}
+
+//--- scene cache --------------------------------------------------
+// Compiled scenes are kept in memory, so that switching back and forth between scenes only needs to
+// load their bytecode, which re-runs a scene's top-level code on each visit. Entries are evicted in
+// least recently used order.
+
+#define SCENE_CACHE_CAPACITY 8
+
+typedef struct {
+	char* name; ///< NULL for an unused slot
+	void* bytecode;
+	size_t size;
+	uint64_t lastUse;
+} SceneCacheEntry;
+
+static SceneCacheEntry sceneCache[SCENE_CACHE_CAPACITY];
+static uint64_t sceneCacheClock = 0;
+
+const void* arcmSceneCacheLoad(const char* name, size_t* size) {
+	for(size_t i=0; i<SCENE_CACHE_CAPACITY; ++i) {
+		SceneCacheEntry* entry = &sceneCache[i];
+		if(entry->name && strcmp(entry->name, name) == 0) {
+			entry->lastUse = ++sceneCacheClock;
+			*size = entry->size;
+			return entry->bytecode;
+		}
+	}
+	return NULL;
+}
+
+void arcmSceneCacheStore(const char* name, const void* bytecode, size_t size) {
+	SceneCacheEntry* slot = NULL; // replaced entry, preferably unused or else least recently used
+	for(size_t i=0; i<SCENE_CACHE_CAPACITY; ++i) {
+		SceneCacheEntry* entry = &sceneCache[i];
+		if(entry->name && strcmp(entry->name, name) == 0) {
+			slot = entry;
+			break;
+		}
+		if(!slot || (slot->name && (!entry->name || entry->lastUse < slot->lastUse)))
+			slot = entry;
+	}
+	free(slot->name);
+	free(slot->bytecode);
+	slot->name = strdup(name);
+	slot->bytecode = malloc(size ? size : 1);
+	memcpy(slot->bytecode, bytecode, size);
+	slot->size = size;
+	slot->lastUse = ++sceneCacheClock;
+}
+
+void arcmSceneCacheClear() {
+	for(size_t i=0; i<SCENE_CACHE_CAPACITY; ++i) {
+		free(sceneCache[i].name);
+		free(sceneCache[i].bytecode);
+	}
+	memset(sceneCache, 0, sizeof(sceneCache));
+}
@@ -0,0 +1,363 @@
+#include "arcamini.h"
+
+#include "graphics.h"
+#include "resources.h"
+#include "audio.h"
+#include "SDL.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// image decoder exported by arcajs, as used by ResourceGetImage
+extern unsigned char* readImageData(const unsigned char* data, size_t numBytes, int* w, int* h, int* d);
+
+//--- asynchronous resource loading --------------------------------
+// Resources are read and decoded by a pool of worker threads. Only the upload to graphics or audio
+// memory takes place on the main thread, when arcmResourceUploadPending is called at frame start.
+// Completed jobs are released then, only their resource handle is kept. If no worker thread can
+// be started, resources are loaded synchronously by arcmResourceLoadAsync instead.
+
+/// maximum time in seconds spent per frame for uploading decoded resources, at least one is uploaded
+#define LOADER_UPLOAD_BUDGET 0.004
+#define LOADER_MAX_WORKERS 4
+
+typedef enum { LOAD_QUEUED = 0, LOAD_DECODING, LOAD_DECODED, LOAD_READY, LOAD_FAILED } LoadState;
+
+typedef struct {
+	char* name;
+	uint32_t id; ///< handle of the pending load, index+1 in loadHandles
+	ResourceTypeId type;
+	float param, centerX, centerY;
+	int filtering;
+	LoadState state;
+	void* data; ///< decoded pixels, PCM samples, or raw font data
+	size_t size;
+	int width, height, depth; ///< images only
+	uint32_t numSamples, offset; ///< audio only
+	uint8_t numChannels;
+	uint32_t handle;
+} LoadJob;
+
+/// jobs not completed yet, in the order of their requests
+static LoadJob** loadJobs = NULL;
+static size_t loadNumJobs = 0, loadCapacity = 0;
+/// index of the next job to be decoded
+static size_t loadNextDecode = 0;
+/// resource handle per pending load, 0 until completed or if loading failed
+static uint32_t* loadHandles = NULL;
+static size_t loadNumHandles = 0, loadHandleCapacity = 0;
+/// number of loads requested and completed since the loader was idle the last time
+static size_t loadRequested = 0, loadCompleted = 0;
+
+static SDL_Thread* loadWorkers[LOADER_MAX_WORKERS];
+static int loadNumWorkers = 0;
+static SDL_mutex* loadMutex = NULL;
+static SDL_cond* loadCond = NULL;
+static bool loadQuit = false;
+/// set if no worker thread could be started
+static bool loadSynchronous = false;
+/// serializes archive access, which is not thread-safe
+static SDL_mutex* archiveMutex = NULL;
+
+void arcmResourceArchiveLock(bool lock) {
+	if(!archiveMutex)
+		return;
+	if(lock)
+		SDL_LockMutex(archiveMutex);
+	else
+		SDL_UnlockMutex(archiveMutex);
+}
+
+unsigned char* arcmResourceDecodeImage(const char* name, float scale, int* w, int* h, int* d) {
+	if(strcmp(ResourceSuffix(name), "svg")==0) {
+		char* copy;
+		const char* svg = arcmResourceText(name, &copy);
+		unsigned char* pixels = svg ? arcmSVGRasterize(svg, scale, w, h, d) : NULL;
+		free(copy);
+		return pixels;
+	}
+	size_t numBytes = 0;
+	void* copy;
+	const void* bytes = arcmResourceBinary(name, &numBytes, &copy);
+	unsigned char* pixels = bytes ? readImageData((const unsigned char*)bytes, numBytes, w, h, d) : NULL;
+	free(copy);
+	return pixels;
+}
+
+static void LoaderDecode(LoadJob* job) {
+	if(job->type == RESOURCE_IMAGE) {
+		job->data = arcmResourceDecodeImage(job->name, job->param, &job->width, &job->height, &job->depth);
+		return;
+	}
+	size_t numBytes = 0;
+	void* copy;
+	const void* bytes = arcmResourceBinary(job->name, &numBytes, &copy);
+	if(!bytes)
+		return;
+
+	switch(job->type) {
+	case RESOURCE_AUDIO:
+		job->data = arcmAudioDecode(bytes, numBytes, &job->numSamples, &job->numChannels, &job->offset);
+		break;
+	case RESOURCE_FONT: // glyphs are rasterized by gfxFontUpload on the main thread
+		if(!copy) {
+			copy = malloc(numBytes);
+			memcpy(copy, bytes, numBytes);
+		}
+		job->data = copy;
+		job->size = numBytes;
+		copy = NULL;
+		break;
+	default:
+		break;
+	}
+	free(copy);
+}
+
+/// finishes a job. Called with loadMutex held (if any).
+static void LoaderComplete(LoadJob* job, LoadState state) {
+	if(state == LOAD_FAILED)
+		fprintf(stderr, "loading resource \"%s\" failed\n", job->name);
+	job->state = state;
+	free(job->name);
+	job->name = NULL;
+	loadHandles[job->id-1] = state == LOAD_READY ? job->handle : 0;
+	++loadCompleted;
+}
+
+static int LoaderWorker(void* udata) {
+	(void)udata;
+	SDL_LockMutex(loadMutex);
+	while(!loadQuit) {
+		if(loadNextDecode == loadNumJobs) {
+			SDL_CondWait(loadCond, loadMutex);
+			continue;
+		}
+		LoadJob* job = loadJobs[loadNextDecode++];
+		job->state = LOAD_DECODING;
+		SDL_UnlockMutex(loadMutex);
+		LoaderDecode(job);
+		SDL_LockMutex(loadMutex);
+		if(job->data)
+			job->state = LOAD_DECODED;
+		else
+			LoaderComplete(job, LOAD_FAILED);
+	}
+	SDL_UnlockMutex(loadMutex);
+	return 0;
+}
+
+static bool LoaderInit() {
+	loadMutex = SDL_CreateMutex();
+	loadCond = SDL_CreateCond();
+	archiveMutex = SDL_CreateMutex();
+	loadQuit = false;
+	if(loadMutex && loadCond && archiveMutex) {
+		int numWorkers = SDL_GetCPUCount() - 1;
+		if(numWorkers < 1)
+			numWorkers = 1;
+		if(numWorkers > LOADER_MAX_WORKERS)
+			numWorkers = LOADER_MAX_WORKERS;
+		for(loadNumWorkers = 0; loadNumWorkers < numWorkers; ++loadNumWorkers)
+			if(!(loadWorkers[loadNumWorkers] = SDL_CreateThread(LoaderWorker, "arcmLoader", NULL)))
+				break;
+	}
+	if(loadNumWorkers > 0) // runs with fewer workers if not all could be started
+		return true;
+	if(loadCond)
+		SDL_DestroyCond(loadCond);
+	if(loadMutex)
+		SDL_DestroyMutex(loadMutex);
+	if(archiveMutex)
+		SDL_DestroyMutex(archiveMutex);
+	loadCond = NULL;
+	loadMutex = archiveMutex = NULL;
+	return false;
+}
+
+/// registers a new load. Called with loadMutex held (if any).
+/// @return handle of the pending load
+static uint32_t LoaderRequest() {
+	if(loadNumHandles == loadHandleCapacity) {
+		loadHandleCapacity = loadHandleCapacity ? loadHandleCapacity*2 : 64;
+		loadHandles = (uint32_t*)realloc(loadHandles, loadHandleCapacity*sizeof(uint32_t));
+	}
+	loadHandles[loadNumHandles++] = 0;
+	if(loadCompleted == loadRequested)
+		loadCompleted = loadRequested = 0;
+	++loadRequested;
+	return (uint32_t)loadNumHandles;
+}
+
+static void LoaderUpload(LoadJob* job);
+
+uint32_t arcmResourceLoadAsync(const char* name, float param, float centerX, float centerY, int filtering) {
+	const ResourceTypeId type = ResourceType(name);
+	if(type != RESOURCE_IMAGE && type != RESOURCE_AUDIO && type != RESOURCE_FONT)
+		return 0;
+	if(!loadMutex && !loadSynchronous && !LoaderInit()) {
+		fprintf(stderr, "resource loader threads could not be started, loading synchronously\n");
+		loadSynchronous = true;
+	}
+	LoadJob* job = (LoadJob*)calloc(1, sizeof(LoadJob));
+	job->name = strdup(name);
+	job->type = type;
+	job->param = param > 0.0f ? param : type == RESOURCE_FONT ? 16.0f : 1.0f;
+	job->centerX = centerX;
+	job->centerY = centerY;
+	job->filtering = filtering;
+	if(loadSynchronous) {
+		const uint32_t pending = job->id = LoaderRequest();
+		LoaderDecode(job);
+		if(job->data)
+			LoaderUpload(job);
+		LoaderComplete(job, job->handle ? LOAD_READY : LOAD_FAILED);
+		free(job);
+		return pending;
+	}
+
+	SDL_LockMutex(loadMutex);
+	if(loadNumJobs == loadCapacity) {
+		loadCapacity = loadCapacity ? loadCapacity*2 : 64;
+		loadJobs = (LoadJob**)realloc(loadJobs, loadCapacity*sizeof(LoadJob*));
+	}
+	loadJobs[loadNumJobs++] = job;
+	const uint32_t pending = job->id = LoaderRequest();
+	SDL_CondSignal(loadCond);
+	SDL_UnlockMutex(loadMutex);
+	return pending;
+}
+
+/// uploads a decoded resource. Called on the main thread.
+static void LoaderUpload(LoadJob* job) {
+	switch(job->type) {
+	case RESOURCE_IMAGE:
+		gfxTextureFiltering(job->filtering);
+		job->handle = gfxImageUpload((const unsigned char*)job->data, job->width, job->height, job->depth, 0xff);
+		if(job->handle)
+			gfxImageSetCenter(job->handle, job->centerX, job->centerY);
+		free(job->data);
+		break;
+	case RESOURCE_AUDIO: // takes ownership of the samples
+		job->handle = arcmAudioUploadPCM((float*)job->data, job->numSamples, job->numChannels, job->offset);
+		break;
+	case RESOURCE_FONT:
+		job->handle = gfxFontUpload(job->data, job->size, job->param);
+		free(job->data);
+		break;
+	default:
+		free(job->data);
+		break;
+	}
+	job->data = NULL;
+}
+
+uint32_t arcmResourceLoadMapped(const char* name, float param, float centerX, float centerY, int filtering) {
+	arcmResourceArchiveLock(true);
+	const bool mapped = arcmArchiveContains(name);
+	arcmResourceArchiveLock(false);
+	const ResourceTypeId type = ResourceType(name);
+	if(!mapped || (type != RESOURCE_IMAGE && type != RESOURCE_AUDIO && type != RESOURCE_FONT))
+		return 0;
+	LoadJob job;
+	memset(&job, 0, sizeof(job));
+	job.name = (char*)name;
+	job.type = type;
+	job.param = param > 0.0f ? param : type == RESOURCE_FONT ? 16.0f : 1.0f;
+	job.centerX = centerX;
+	job.centerY = centerY;
+	job.filtering = filtering;
+	LoaderDecode(&job);
+	if(job.data)
+		LoaderUpload(&job);
+	return job.handle;
+}
+
+void arcmResourceUploadPending() {
+	if(!loadMutex)
+		return;
+	const double budgetEnd = (double)SDL_GetPerformanceCounter() / SDL_GetPerformanceFrequency() + LOADER_UPLOAD_BUDGET;
+	bool uploaded = false;
+	SDL_LockMutex(loadMutex);
+	for(size_t i = 0; i < loadNumJobs; ++i) {
+		LoadJob* job = loadJobs[i];
+		if(job->state != LOAD_DECODED)
+			continue;
+		if(uploaded && (double)SDL_GetPerformanceCounter() / SDL_GetPerformanceFrequency() > budgetEnd)
+			break;
+		SDL_UnlockMutex(loadMutex);
+		LoaderUpload(job);
+		SDL_LockMutex(loadMutex);
+		uploaded = true;
+		LoaderComplete(job, job->handle ? LOAD_READY : LOAD_FAILED);
+	}
+	// release completed jobs, which have all been handed to a worker before
+	size_t numJobs = 0;
+	for(size_t i = 0; i < loadNumJobs; ++i) {
+		if(loadJobs[i]->state >= LOAD_READY)
+			free(loadJobs[i]);
+		else
+			loadJobs[numJobs++] = loadJobs[i];
+	}
+	loadNextDecode -= loadNumJobs - numJobs;
+	loadNumJobs = numJobs;
+	SDL_UnlockMutex(loadMutex);
+}
+
+bool arcmResourceLoaded(uint32_t pending, uint32_t* handle) {
+	bool done = true; // also for unknown loads
+	uint32_t result = 0;
+	if(loadMutex)
+		SDL_LockMutex(loadMutex);
+	if(pending && pending <= loadNumHandles) {
+		for(size_t i = 0; i < loadNumJobs && done; ++i)
+			if(loadJobs[i]->id == pending)
+				done = loadJobs[i]->state >= LOAD_READY;
+		result = loadHandles[pending-1];
+	}
+	if(loadMutex)
+		SDL_UnlockMutex(loadMutex);
+	if(done && handle)
+		*handle = result;
+	return done;
+}
+
+float arcmResourceLoadProgress() {
+	if(!loadMutex)
+		return 1.0f;
+	SDL_LockMutex(loadMutex);
+	const float progress = loadRequested ? (float)loadCompleted / loadRequested : 1.0f;
+	SDL_UnlockMutex(loadMutex);
+	return progress;
+}
+
+void arcmResourceLoaderClose() {
+	if(loadMutex) {
+		SDL_LockMutex(loadMutex);
+		loadQuit = true;
+		SDL_CondBroadcast(loadCond);
+		SDL_UnlockMutex(loadMutex);
+		for(int i=0; i<loadNumWorkers; ++i)
+			SDL_WaitThread(loadWorkers[i], NULL);
+		loadNumWorkers = 0;
+		SDL_DestroyCond(loadCond);
+		SDL_DestroyMutex(loadMutex);
+		SDL_DestroyMutex(archiveMutex);
+		loadCond = NULL;
+		loadMutex = archiveMutex = NULL;
+	}
+	for(size_t i=0; i<loadNumJobs; ++i) { // decoded but not yet uploaded data
+		free(loadJobs[i]->data);
+		free(loadJobs[i]->name);
+		free(loadJobs[i]);
+	}
+	free(loadJobs);
+	loadJobs = NULL;
+	free(loadHandles);
+	loadHandles = NULL;
+	loadNumJobs = loadCapacity = loadNextDecode = loadRequested = loadCompleted = 0;
+	loadNumHandles = loadHandleCapacity = 0;
+	loadSynchronous = false;
+}
@@ -0,0 +1,161 @@
+#include "arcamini.h"
+
+#include "graphics.h"
+#include "resources.h"
+#include "window.h"
+#include "value.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+//--- manifest -----------------------------------------------------
+// Games describe themselves by a manifest.json shared with the browser runtime. Directories holding
+// several games have a manifest*.json per game, the one listing the script being run in its scripts
+// applies. Native hosts read the window size, display mode, and number of audio tracks from it, and an
+// optional preload list of resources decoded by the resource loader before the script is entered.
+// Preload entries are either file names, or objects with a name and the parameters the script passes
+// to resource.getImage (scale, centerX, centerY, filtering) or resource.getFont (size).
+
+static Value* manifest = NULL;
+
+typedef struct {
+	char* name;
+	ResourceTypeId type;
+	float param, centerX, centerY;
+	int filtering;
+	uint32_t pending, handle;
+} PreloadEntry;
+
+static PreloadEntry* preloadEntries = NULL;
+static size_t preloadNumEntries = 0;
+
+/// @return the parsed manifest if it is a map listing scriptName in its scripts or if scriptName is NULL
+static Value* ManifestRead(const char* name, const char* scriptName) {
+	char* copy;
+	const char* text = arcmResourceText(name, &copy);
+	Value* value = text ? Value_parse(text) : NULL;
+	free(copy);
+	if(!value || value->type != VALUE_MAP) {
+		if(value)
+			Value_delete(value, true);
+		return NULL;
+	}
+	if(!scriptName)
+		return value;
+	const Value* scripts = Value_get(value, "scripts");
+	for(unsigned i=0; scripts && Value_at(scripts, i); ++i) {
+		const Value* script = Value_at(scripts, i);
+		if(script->type == VALUE_STRING && strcmp(script->str, scriptName) == 0)
+			return value;
+	}
+	Value_delete(value, true);
+	return NULL;
+}
+
+bool arcmManifestOpen(const char* scriptName) {
+	arcmManifestClose();
+	manifest = ManifestRead("manifest.json", scriptName);
+	for(size_t i=0; !manifest && arcmArchiveEntry(i); ++i) { // only mapped archives can be listed
+		const char* name = arcmArchiveEntry(i);
+		const size_t len = strlen(name);
+		if(strncmp(name, "manifest", 8) == 0 && len > 13 && strcmp(name + len - 5, ".json") == 0 && !strchr(name, '/'))
+			manifest = ManifestRead(name, scriptName);
+	}
+	if(!manifest) // a single game's manifest may list a script of another language only
+		manifest = ManifestRead("manifest.json", NULL);
+	return manifest != NULL;
+}
+
+int arcmManifestInt(const char* key, int defaultValue) {
+	return manifest ? (int)Value_geti(manifest, key, defaultValue) : defaultValue;
+}
+
+const char* arcmManifestString(const char* key, const char* defaultValue) {
+	const Value* value = manifest ? Value_get(manifest, key) : NULL;
+	return value && value->type == VALUE_STRING ? value->str : defaultValue;
+}
+
+static void PreloadDrawProgress(float progress) {
+	const float w = WindowWidth() * 0.5f, h = 8.0f;
+	const float x = WindowWidth() * 0.25f, y = (WindowHeight() - h) * 0.5f;
+	gfxBeginFrame(WindowGetClearColor());
+	gfxColor(0xffffffff);
+	gfxLineWidth(1.0f);
+	gfxDrawRect(x - 2.0f, y - 2.0f, w + 4.0f, h + 4.0f);
+	gfxFillRect(x, y, w * progress, h);
+	gfxEndFrame();
+}
+
+bool arcmManifestPreload() {
+	const Value* list = manifest ? Value_get(manifest, "preload") : NULL;
+	size_t numEntries = 0;
+	while(Value_at(list, numEntries))
+		++numEntries;
+	if(!numEntries)
+		return true;
+	preloadEntries = (PreloadEntry*)calloc(numEntries, sizeof(PreloadEntry));
+	for(unsigned i=0; i<numEntries; ++i) {
+		const Value* item = Value_at(list, i);
+		const char* name = item->type == VALUE_STRING ? item->str : Value_gets(item, "name", NULL);
+		if(!name) {
+			fprintf(stderr, "manifest preload entry %u has no name\n", i);
+			continue;
+		}
+		PreloadEntry* entry = &preloadEntries[preloadNumEntries++];
+		entry->name = strdup(name);
+		entry->type = ResourceType(name);
+		const bool isFont = entry->type == RESOURCE_FONT; // parameters default as in the bindings
+		entry->param = (float)Value_getf(item, isFont ? "size" : "scale", isFont ? 16.0 : 1.0);
+		entry->centerX = (float)Value_getf(item, "centerX", 0.0);
+		entry->centerY = (float)Value_getf(item, "centerY", 0.0);
+		entry->filtering = (int)Value_geti(item, "filtering", 1);
+		entry->pending = arcmResourceLoadAsync(name, entry->param, entry->centerX, entry->centerY, entry->filtering);
+	}
+
+	// decoding proceeds on the loader threads, uploads at the start of each progress frame
+	bool open = true;
+	for(size_t numLoaded = 0; ; ) {
+		arcmResourceUploadPending();
+		while(numLoaded < preloadNumEntries
+			&& arcmResourceLoaded(preloadEntries[numLoaded].pending, &preloadEntries[numLoaded].handle))
+			++numLoaded;
+		if(numLoaded == preloadNumEntries)
+			break;
+		PreloadDrawProgress((float)numLoaded / preloadNumEntries);
+		if(WindowUpdate() != 0 || !WindowIsOpen()) {
+			open = false;
+			break;
+		}
+	}
+	// the script is entered anyway, it may still load these resources itself
+	for(size_t i=0; open && i<preloadNumEntries; ++i)
+		if(!preloadEntries[i].handle)
+			fprintf(stderr, preloadEntries[i].pending ? "preloading \"%s\" failed\n"
+				: "preloading \"%s\" failed, it is neither an image, audio sample, nor font\n", preloadEntries[i].name);
+	return open;
+}
+
+uint32_t arcmManifestPreloaded(const char* name, float param, float centerX, float centerY, int filtering) {
+	for(size_t i=0; i<preloadNumEntries; ++i) {
+		const PreloadEntry* entry = &preloadEntries[i];
+		if(!entry->handle || strcmp(entry->name, name) != 0)
+			continue;
+		if(entry->type == RESOURCE_AUDIO || (entry->type == RESOURCE_FONT && entry->param == param)
+			|| (entry->param == param && entry->centerX == centerX && entry->centerY == centerY && entry->filtering == filtering))
+			return entry->handle;
+	}
+	return 0;
+}
+
+void arcmManifestClose() {
+	for(size_t i=0; i<preloadNumEntries; ++i)
+		free(preloadEntries[i].name);
+	free(preloadEntries);
+	preloadEntries = NULL;
+	preloadNumEntries = 0;
+	if(manifest)
+		Value_delete(manifest, true);
+	manifest = NULL;
+}
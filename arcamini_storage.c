@@ -0,0 +1,550 @@
+#include "arcamini.h"
+
+#include "value.h"
+#include "SDL.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#if defined __WIN32__ || defined WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+//--- Storage ------------------------------------------------------
+// Storage items are kept in an open addressing hash table and persisted in an append-only log.
+// The log starts with STORAGE_MAGIC, followed by records of 4 little endian uint32 values
+// (key size, value size, value type, checksum of key and value) and the key and value bytes.
+// A later record supersedes earlier ones of the same key. Incomplete or corrupt records at the
+// end of the log, e.g., due to a crash while appending, are ignored when loading.
+
+#define STORAGE_MAGIC "arcmkv1\n"
+#define STORAGE_MAGIC_SIZE 8
+#define STORAGE_HEADER_SIZE 16
+/// storage changes are written behind by a worker thread, at most this long after the first change
+#define STORAGE_FLUSH_DELAY 250
+/// values larger than this are read when accessed first instead of when opening the storage
+#define STORAGE_LAZY_SIZE 1024
+/// the log is rewritten when it exceeds this size and more than half of it is superseded
+#define STORAGE_COMPACT_SIZE (64*1024)
+
+enum { STORAGE_STRING = 0, STORAGE_BINARY = 1, STORAGE_REMOVED = 2 };
+
+typedef struct {
+	char* key; ///< NULL for an unused slot
+	uint32_t hash;
+	uint32_t type;
+	uint32_t size;
+	uint32_t checksum;
+	long offset; ///< log file offset of the value, only meaningful for values not loaded yet
+	uint8_t* data; ///< NULL if not loaded yet, otherwise NUL-terminated for convenience
+} StorageEntry;
+
+static char * storageFileName = NULL;
+/// JSON file of earlier versions the items were imported from, removed once they have been written
+static char * storageLegacyFileName = NULL;
+static StorageEntry* storageEntries = NULL;
+static size_t storageCapacity = 0, storageCount = 0;
+static long storageLogSize = 0, storageLiveSize = 0;
+static FILE* storageReader = NULL;
+static uint8_t* storagePending = NULL;
+static size_t storagePendingSize = 0, storagePendingCapacity = 0;
+
+static SDL_Thread* storageThread = NULL;
+static SDL_mutex* storageMutex = NULL;
+static SDL_cond* storageCond = NULL;
+static bool storageDirty = false, storageSaving = false, storageFlushNow = false, storageQuit = false;
+static bool storageSaveSuccess = true, storageNeedsCompaction = false;
+static Uint32 storageDirtySince = 0;
+static size_t storageFlushes = 0, storageCompactions = 0;
+
+/// FNV-1a, used both for hashing keys and as record checksum
+static uint32_t StorageHash(const void* data, size_t size, uint32_t hash) {
+	for(size_t i=0; i<size; ++i)
+		hash = (hash ^ ((const uint8_t*)data)[i]) * 16777619u;
+	return hash;
+}
+#define STORAGE_HASH_SEED 2166136261u
+
+static long StorageRecordSize(const StorageEntry* entry) {
+	return STORAGE_HEADER_SIZE + (long)strlen(entry->key) + entry->size;
+}
+
+static StorageEntry* StorageFind(const char* key, uint32_t hash) {
+	if(!storageCapacity)
+		return NULL;
+	for(size_t i = hash & (storageCapacity-1); ; i = (i+1) & (storageCapacity-1)) {
+		StorageEntry* entry = &storageEntries[i];
+		if(!entry->key || (entry->hash == hash && strcmp(entry->key, key)==0))
+			return entry;
+	}
+}
+
+static StorageEntry* StorageInsert(const char* key, uint32_t hash) {
+	if((storageCount+1)*4 > storageCapacity*3) {
+		StorageEntry* entries = storageEntries;
+		const size_t capacity = storageCapacity;
+		storageCapacity = capacity ? capacity*2 : 64;
+		storageEntries = (StorageEntry*)calloc(storageCapacity, sizeof(StorageEntry));
+		for(size_t i=0; i<capacity; ++i)
+			if(entries[i].key)
+				*StorageFind(entries[i].key, entries[i].hash) = entries[i];
+		free(entries);
+	}
+	StorageEntry* entry = StorageFind(key, hash);
+	if(!entry->key) {
+		entry->key = strdup(key);
+		entry->hash = hash;
+		entry->type = STORAGE_REMOVED;
+		++storageCount;
+	}
+	return entry;
+}
+
+/// updates the index for a record. Takes ownership of data.
+static void StorageUpdate(const char* key, uint32_t type, const uint8_t* value, uint8_t* data, uint32_t size, uint32_t checksum, long offset) {
+	StorageEntry* entry = StorageInsert(key, StorageHash(key, strlen(key), STORAGE_HASH_SEED));
+	if(entry->type != STORAGE_REMOVED)
+		storageLiveSize -= StorageRecordSize(entry);
+	free(entry->data);
+	entry->type = type;
+	entry->size = size;
+	entry->checksum = checksum;
+	entry->offset = offset;
+	entry->data = data;
+	if(!data && value && type != STORAGE_REMOVED) {
+		entry->data = (uint8_t*)malloc(size+1);
+		memcpy(entry->data, value, size);
+		entry->data[size] = 0;
+	}
+	if(type != STORAGE_REMOVED)
+		storageLiveSize += StorageRecordSize(entry);
+}
+
+/// reads the index and all small values from the log
+static bool StorageLoad() {
+	FILE* f = fopen(storageFileName, "rb");
+	if (!f)
+		return false;
+	fseek(f, 0, SEEK_END);
+	const long length = ftell(f);
+	rewind(f);
+
+	char magic[STORAGE_MAGIC_SIZE];
+	if(fread(magic, 1, STORAGE_MAGIC_SIZE, f)!=STORAGE_MAGIC_SIZE || memcmp(magic, STORAGE_MAGIC, STORAGE_MAGIC_SIZE)!=0) {
+		fprintf(stderr, "localStorage file %s is invalid\n", storageFileName);
+		fclose(f);
+		return false;
+	}
+	long pos = STORAGE_MAGIC_SIZE;
+	char* key = NULL;
+	uint8_t header[STORAGE_HEADER_SIZE];
+	while(pos < length) {
+		if(fread(header, 1, STORAGE_HEADER_SIZE, f)!=STORAGE_HEADER_SIZE)
+			break;
+		const uint32_t keySize = arcmGet32(header), size = arcmGet32(header+4);
+		const uint32_t type = arcmGet32(header+8), checksum = arcmGet32(header+12);
+		const long valuePos = pos + STORAGE_HEADER_SIZE + keySize;
+		if(type > STORAGE_REMOVED || valuePos + (long)size > length || valuePos < pos)
+			break;
+		key = (char*)realloc(key, keySize+1);
+		if(fread(key, 1, keySize, f)!=keySize)
+			break;
+		key[keySize] = 0;
+		uint8_t* data = NULL;
+		if(size <= STORAGE_LAZY_SIZE) {
+			data = (uint8_t*)malloc(size+1);
+			if(fread(data, 1, size, f)!=size || StorageHash(data, size, StorageHash(key, keySize, STORAGE_HASH_SEED))!=checksum) {
+				free(data);
+				break;
+			}
+			data[size] = 0;
+		}
+		else
+			fseek(f, valuePos + size, SEEK_SET);
+		StorageUpdate(key, type, NULL, data, size, checksum, valuePos);
+		pos = valuePos + size;
+	}
+	free(key);
+	fclose(f);
+	storageLogSize = pos;
+	if(pos < length) { // drop the corrupt tail when writing next time
+		fprintf(stderr, "localStorage file %s is truncated at offset %li\n", storageFileName, pos);
+		storageNeedsCompaction = true;
+	}
+	storageReader = fopen(storageFileName, "rb");
+	return true;
+}
+
+/// reads a value that was not loaded when opening the storage. Called with storageMutex held (if any).
+/// @return NUL-terminated value to be freed by the caller, or NULL if the record is corrupt
+static uint8_t* StorageReadValue(const StorageEntry* entry) {
+	uint8_t* data = (uint8_t*)malloc(entry->size+1);
+	if(!storageReader || fseek(storageReader, entry->offset, SEEK_SET)!=0
+		|| fread(data, 1, entry->size, storageReader)!=entry->size
+		|| StorageHash(data, entry->size, StorageHash(entry->key, strlen(entry->key), STORAGE_HASH_SEED))!=entry->checksum)
+	{
+		fprintf(stderr, "localStorage item %s is corrupt\n", entry->key);
+		free(data);
+		return NULL;
+	}
+	data[entry->size] = 0;
+	return data;
+}
+
+/// appends a record to the pending changes
+static void StorageAppendRecord(const char* key, uint32_t type, const void* value, uint32_t size, uint32_t checksum) {
+	const size_t keySize = strlen(key), recordSize = STORAGE_HEADER_SIZE + keySize + size;
+	if(storagePendingSize + recordSize > storagePendingCapacity) {
+		storagePendingCapacity = storagePendingSize + recordSize + 4096;
+		storagePending = (uint8_t*)realloc(storagePending, storagePendingCapacity);
+	}
+	uint8_t* record = storagePending + storagePendingSize;
+	arcmPut32(record, (uint32_t)keySize);
+	arcmPut32(record+4, size);
+	arcmPut32(record+8, type);
+	arcmPut32(record+12, checksum);
+	memcpy(record + STORAGE_HEADER_SIZE, key, keySize);
+	if(size)
+		memcpy(record + STORAGE_HEADER_SIZE + keySize, value, size);
+	storagePendingSize += recordSize;
+	storageLogSize += recordSize;
+}
+
+/// updates an item in the index and the pending changes of the log
+static void StorageSet(const char* key, uint32_t type, const void* value, size_t size) {
+	const uint32_t checksum = StorageHash(value, size, StorageHash(key, strlen(key), STORAGE_HASH_SEED));
+	StorageUpdate(key, type, (const uint8_t*)value, NULL, (uint32_t)size, checksum, -1);
+	if(storageFileName)
+		StorageAppendRecord(key, type, value, (uint32_t)size, checksum);
+}
+
+static bool StorageSync(FILE* f) {
+	bool success = fflush(f) == 0;
+#if defined __WIN32__ || defined WIN32
+	success = success && _commit(_fileno(f)) == 0;
+#else
+	success = success && fsync(fileno(f)) == 0;
+#endif
+	return (fclose(f) == 0) && success;
+}
+
+/// appends pending changes to the log. Called with storageMutex held (if any), which is
+/// released while writing.
+static bool StorageAppend() {
+	if(!storagePendingSize)
+		return true;
+	uint8_t* pending = storagePending;
+	const size_t pendingSize = storagePendingSize;
+	storagePending = NULL;
+	storagePendingSize = storagePendingCapacity = 0;
+
+	storageSaving = true;
+	if(storageMutex)
+		SDL_UnlockMutex(storageMutex);
+	FILE* f = fopen(storageFileName, "ab");
+	bool success = f && fwrite(pending, 1, pendingSize, f)==pendingSize;
+	success = f && StorageSync(f) && success;
+	free(pending);
+	if(storageMutex)
+		SDL_LockMutex(storageMutex);
+	storageSaving = false;
+
+	if(!storageReader)
+		storageReader = fopen(storageFileName, "rb");
+	if(!success) // the tail of the log may be inconsistent now, rewrite it as a whole
+		storageNeedsCompaction = true;
+	return success;
+}
+
+/// rewrites the log with the current items only and atomically replaces the storage file.
+/// Called with storageMutex held (if any).
+static bool StorageCompact() {
+	char* tmpFileName = (char*)malloc(strlen(storageFileName)+5);
+	strcat(strcpy(tmpFileName, storageFileName), ".tmp");
+	FILE* f = fopen(tmpFileName, "wb");
+	if (!f) {
+		free(tmpFileName);
+		return false;
+	}
+	long* offsets = (long*)malloc((storageCapacity+1)*sizeof(long));
+	long pos = STORAGE_MAGIC_SIZE;
+	bool success = fwrite(STORAGE_MAGIC, 1, STORAGE_MAGIC_SIZE, f)==STORAGE_MAGIC_SIZE;
+	for(size_t i=0; i<storageCapacity && success; ++i) {
+		StorageEntry* entry = &storageEntries[i];
+		if(!entry->key || entry->type == STORAGE_REMOVED)
+			continue;
+		// copy values not loaded yet without keeping them in memory
+		const uint8_t* data = entry->data ? entry->data : StorageReadValue(entry);
+		if(!data) {
+			storageLiveSize -= StorageRecordSize(entry);
+			entry->type = STORAGE_REMOVED;
+			continue;
+		}
+		const size_t keySize = strlen(entry->key);
+		uint8_t header[STORAGE_HEADER_SIZE];
+		arcmPut32(header, (uint32_t)keySize);
+		arcmPut32(header+4, entry->size);
+		arcmPut32(header+8, entry->type);
+		arcmPut32(header+12, entry->checksum);
+		success = fwrite(header, 1, STORAGE_HEADER_SIZE, f)==STORAGE_HEADER_SIZE
+			&& fwrite(entry->key, 1, keySize, f)==keySize
+			&& fwrite(data, 1, entry->size, f)==entry->size;
+		if(data != entry->data)
+			free((void*)data);
+		offsets[i] = pos + STORAGE_HEADER_SIZE + keySize;
+		pos = offsets[i] + entry->size;
+	}
+	success = StorageSync(f) && success;
+	if(success) {
+		if(storageReader)
+			fclose(storageReader);
+		storageReader = NULL;
+#if defined __WIN32__ || defined WIN32
+		success = MoveFileExA(tmpFileName, storageFileName, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+		success = rename(tmpFileName, storageFileName) == 0;
+#endif
+	}
+	if(success) {
+		for(size_t i=0; i<storageCapacity; ++i)
+			if(storageEntries[i].key && storageEntries[i].type != STORAGE_REMOVED)
+				storageEntries[i].offset = offsets[i];
+		free(storagePending);
+		storagePending = NULL;
+		storagePendingSize = storagePendingCapacity = 0;
+		storageLogSize = storageLiveSize = pos;
+		storageNeedsCompaction = false;
+		++storageCompactions;
+	}
+	else
+		remove(tmpFileName);
+	if(!storageReader)
+		storageReader = fopen(storageFileName, "rb");
+	free(offsets);
+	free(tmpFileName);
+	return success;
+}
+
+/// writes pending changes. Called with storageMutex held (if any).
+static bool StorageSave() {
+	storageDirty = storageFlushNow = false;
+	bool success;
+	if(storageNeedsCompaction || (storageLogSize > STORAGE_COMPACT_SIZE && storageLiveSize*2 < storageLogSize))
+		success = StorageCompact();
+	else
+		success = StorageAppend();
+	if(!success)
+		fprintf(stderr, "localStorage file %s could not be written\n", storageFileName);
+	else if(storageLegacyFileName) {
+		remove(storageLegacyFileName);
+		free(storageLegacyFileName);
+		storageLegacyFileName = NULL;
+	}
+	storageSaveSuccess = success;
+	++storageFlushes;
+	return success;
+}
+
+static int StorageWorker(void* udata) {
+	(void)udata;
+	SDL_LockMutex(storageMutex);
+	while(storageDirty || !storageQuit) {
+		if(!storageDirty)
+			SDL_CondWait(storageCond, storageMutex);
+		else {
+			const Uint32 elapsed = SDL_GetTicks() - storageDirtySince;
+			if(!storageFlushNow && !storageQuit && elapsed < STORAGE_FLUSH_DELAY)
+				SDL_CondWaitTimeout(storageCond, storageMutex, STORAGE_FLUSH_DELAY - elapsed);
+			else {
+				StorageSave();
+				SDL_CondBroadcast(storageCond);
+			}
+		}
+	}
+	SDL_UnlockMutex(storageMutex);
+	return 0;
+}
+
+/// imports the string items of a JSON storage file written by earlier versions. The JSON file
+/// is kept until the imported items have been saved.
+static bool StorageMigrate(const char* jsonFileName) {
+	char* text = NULL;
+	FILE* f = fopen(jsonFileName, "r");
+	if (!f)
+		return false;
+	fseek(f, 0, SEEK_END);
+	const long length = ftell(f);
+	rewind(f);
+	text = (char*)malloc(length + 1);
+	text[fread(text, 1, length, f)] = '\0';
+	fclose(f);
+
+	Value* data = Value_parse(text);
+	free(text);
+	if(!data)
+		return false;
+	if(data->type == VALUE_MAP)
+		for(const Value* key = data->child; key && key->next; key = key->next->next)
+			if(key->next->type == VALUE_STRING)
+				StorageSet(key->str, STORAGE_STRING, key->next->str, strlen(key->next->str));
+	Value_delete(data, true);
+	return true;
+}
+
+void arcmStorageInit(const char* appName, const char* scriptBaseName) {
+	const char* storagePath = SDL_GetPrefPath(appName, "arcaqjs");
+	storageFileName = (char*)malloc(strlen(storagePath)+strlen(scriptBaseName)+6);
+	storageFileName[0]=0;
+	strcat(strcat(strcat(storageFileName, storagePath), scriptBaseName),".json");
+	SDL_free((void*)storagePath);
+
+	char* jsonFileName = strdup(storageFileName);
+	strcpy(storageFileName + strlen(storageFileName) - 5, ".kv");
+	storageLogSize = storageLiveSize = STORAGE_MAGIC_SIZE;
+	storageQuit = storageDirty = false;
+	if(!StorageLoad()) {
+		storageNeedsCompaction = true; // write a fresh log on first change
+		if(StorageMigrate(jsonFileName)) { // written behind like any change
+			storageLegacyFileName = jsonFileName;
+			jsonFileName = NULL;
+			storageDirtySince = SDL_GetTicks();
+			storageDirty = true;
+		}
+	}
+	free(jsonFileName);
+
+	storageMutex = SDL_CreateMutex();
+	storageCond = SDL_CreateCond();
+	if(storageMutex && storageCond)
+		storageThread = SDL_CreateThread(StorageWorker, "arcmStorage", NULL);
+	if(!storageThread) { // fall back to synchronous saving
+		if(storageCond)
+			SDL_DestroyCond(storageCond);
+		if(storageMutex)
+			SDL_DestroyMutex(storageMutex);
+		storageCond = NULL;
+		storageMutex = NULL;
+	}
+}
+
+void arcmStorageClose() {
+	if(storageThread) {
+		SDL_LockMutex(storageMutex);
+		storageQuit = true;
+		SDL_CondBroadcast(storageCond);
+		SDL_UnlockMutex(storageMutex);
+		SDL_WaitThread(storageThread, NULL);
+		SDL_DestroyCond(storageCond);
+		SDL_DestroyMutex(storageMutex);
+		storageThread = NULL;
+		storageCond = NULL;
+		storageMutex = NULL;
+	}
+	else if(storageDirty)
+		StorageSave();
+	if(storageReader)
+		fclose(storageReader);
+	storageReader = NULL;
+	for(size_t i=0; i<storageCapacity; ++i) {
+		free(storageEntries[i].key);
+		free(storageEntries[i].data);
+	}
+	free(storageEntries);
+	storageEntries = NULL;
+	storageCapacity = storageCount = 0;
+	free(storagePending);
+	storagePending = NULL;
+	storagePendingSize = storagePendingCapacity = 0;
+	free(storageFileName);
+	storageFileName = NULL;
+	free(storageLegacyFileName);
+	storageLegacyFileName = NULL;
+}
+
+const void* arcmResourceGetStorageValue(const char* key, size_t* size, bool* isBinary) {
+	// a compaction by the worker updates the entries, values are only replaced by this thread
+	if(storageMutex)
+		SDL_LockMutex(storageMutex);
+	StorageEntry* entry = StorageFind(key, StorageHash(key, strlen(key), STORAGE_HASH_SEED));
+	const uint8_t* data = NULL;
+	if(entry && entry->key && entry->type != STORAGE_REMOVED) {
+		if(!entry->data)
+			entry->data = StorageReadValue(entry);
+		data = entry->data;
+	}
+	if(data && size)
+		*size = entry->size;
+	if(data && isBinary)
+		*isBinary = entry->type == STORAGE_BINARY;
+	if(storageMutex)
+		SDL_UnlockMutex(storageMutex);
+	return data;
+}
+
+void arcmResourceSetStorageValue(const char* key, const void* value, size_t size, bool isBinary) {
+	if(storageMutex)
+		SDL_LockMutex(storageMutex);
+	if(!value) {
+		const StorageEntry* entry = StorageFind(key, StorageHash(key, strlen(key), STORAGE_HASH_SEED));
+		if(!entry || !entry->key || entry->type == STORAGE_REMOVED) {
+			if(storageMutex)
+				SDL_UnlockMutex(storageMutex);
+			return;
+		}
+	}
+	StorageSet(key, !value ? STORAGE_REMOVED : isBinary ? STORAGE_BINARY : STORAGE_STRING, value, value ? size : 0);
+	if(!storageFileName) {
+		if(storageMutex)
+			SDL_UnlockMutex(storageMutex);
+		return;
+	}
+	if(!storageDirty)
+		storageDirtySince = SDL_GetTicks();
+	storageDirty = true;
+	if(storageMutex) {
+		SDL_CondBroadcast(storageCond);
+		SDL_UnlockMutex(storageMutex);
+	}
+	else
+		StorageSave();
+}
+
+const char* arcmResourceGetStorageItem(const char* key) {
+	return (const char*)arcmResourceGetStorageValue(key, NULL, NULL);
+}
+
+void arcmResourceSetStorageItem(const char* key, const char* value) {
+	arcmResourceSetStorageValue(key, value, value ? strlen(value) : 0, false);
+}
+
+bool arcmResourceFlushStorage() {
+	if(!storageFileName)
+		return false;
+	if(!storageMutex)
+		return !storageDirty || StorageSave();
+	SDL_LockMutex(storageMutex);
+	if(storageDirty) {
+		storageFlushNow = true;
+		SDL_CondBroadcast(storageCond);
+	}
+	while(storageDirty || storageSaving)
+		SDL_CondWait(storageCond, storageMutex);
+	const bool success = storageSaveSuccess;
+	SDL_UnlockMutex(storageMutex);
+	return success;
+}
+
+double arcmStorageStats(const char* name) {
+	if(!strcmp(name, "storageFlushes"))
+		return (double)storageFlushes;
+	if(!strcmp(name, "storageCompactions"))
+		return (double)storageCompactions;
+	if(!strcmp(name, "storageSize"))
+		return (double)storageLogSize;
+	return NAN;
+}
@@ -0,0 +1,274 @@
+#include "arcamini.h"
+
+#include "audio.h"
+#include "resources.h"
+#include "SDL.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// MP3 decoder exported by arcajs (dr_mp3 0.5), as used by AudioRead. arcajs ships no dr_mp3 header,
+// the decoder state is therefore opaque storage of the exact size drmp3_init_memory() clears.
+typedef struct { uint32_t outputChannels, outputSampleRate; } drmp3_config;
+typedef struct { _Alignas(8) unsigned char state[0x5310]; } drmp3;
+_Static_assert(sizeof(drmp3) == 0x5310, "drmp3 must match sizeof(drmp3) of the dr_mp3 build in libarcajs");
+extern uint32_t drmp3_init_memory(drmp3* mp3, const void* data, size_t numBytes, const drmp3_config* config, const void* allocationCallbacks);
+extern uint64_t drmp3_read_pcm_frames_f32(drmp3* mp3, uint64_t framesToRead, float* out);
+extern uint32_t drmp3_seek_to_pcm_frame(drmp3* mp3, uint64_t frameIndex);
+extern void drmp3_uninit(drmp3* mp3);
+
+//--- audio streaming ----------------------------------------------
+// Music is decoded incrementally while it plays instead of being decoded to memory as a whole. Each
+// stream owns a queue track, which a single background thread keeps filled with chunks of decoded
+// frames a fixed time ahead of playback. The mixer releases chunks once played, so only the chunks
+// ahead are held in memory. Loops are decoded seamlessly by rewinding the source within a chunk.
+// Stream tracks are regular tracks, stopping or fading them out by arcmAudioVolume ends the stream.
+
+/// number of frames decoded per chunk
+#define STREAM_CHUNK_FRAMES 4096
+/// time in seconds of decoded frames kept queued ahead of playback
+#define STREAM_AHEAD 0.5
+/// interval in milliseconds between refills of all streams
+#define STREAM_INTERVAL 20
+
+typedef struct MusicStream {
+	uint32_t track;
+	uint8_t numChannels;
+	bool loop;
+	const uint8_t* data; ///< encoded file, a view into the mapped archive or owned copy
+	size_t numBytes;
+	void* copy;
+	drmp3* mp3;
+	SDL_AudioStream* wav; ///< converts WAV frames to float at the device sample rate
+	size_t wavBegin, wavEnd, wavPos;
+	uint32_t wavFrameBytes;
+	struct MusicStream* next;
+} MusicStream;
+
+static MusicStream* streams = NULL;
+static SDL_Thread* streamThread = NULL;
+static SDL_mutex* streamMutex = NULL;
+static SDL_cond* streamCond = NULL;
+static bool streamQuit = false;
+static float streamChunk[STREAM_CHUNK_FRAMES*2];
+
+static uint32_t StreamRead16(const uint8_t* p) { return p[0] | (p[1]<<8); }
+static uint32_t StreamRead32(const uint8_t* p) { return p[0] | (p[1]<<8) | (p[2]<<16) | ((uint32_t)p[3]<<24); }
+
+static bool StreamOpenMP3(MusicStream* s) {
+	s->mp3 = malloc(sizeof(drmp3));
+	if(!s->mp3)
+		return false;
+	// stereo output is requested, the decoder's own channel count is private to its state
+	const drmp3_config config = { 2, AudioSampleRate() };
+	if(!drmp3_init_memory(s->mp3, s->data, s->numBytes, &config, NULL)) {
+		free(s->mp3);
+		s->mp3 = NULL;
+		return false;
+	}
+	s->numChannels = 2;
+	return true;
+}
+
+/// reads the format and data chunks of a RIFF WAVE file, PCM 8/16/32 bit integer or 32 bit float
+static bool StreamOpenWAV(MusicStream* s) {
+	const uint8_t* data = s->data;
+	if(s->numBytes < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data+8, "WAVE", 4) != 0)
+		return false;
+	uint32_t format = 0, numChannels = 0, sampleRate = 0, bits = 0;
+	for(size_t pos = 12; pos + 8 <= s->numBytes; ) {
+		const uint32_t size = StreamRead32(data+pos+4);
+		const uint8_t* chunk = data+pos+8;
+		if(memcmp(data+pos, "fmt ", 4) == 0 && size >= 16 && pos + 24 <= s->numBytes) {
+			format = StreamRead16(chunk);
+			numChannels = StreamRead16(chunk+2);
+			sampleRate = StreamRead32(chunk+4);
+			bits = StreamRead16(chunk+14);
+			if(format == 0xfffe && size >= 26 && pos + 34 <= s->numBytes) // WAVE_FORMAT_EXTENSIBLE
+				format = StreamRead16(chunk+24);
+		}
+		else if(memcmp(data+pos, "data", 4) == 0) {
+			s->wavBegin = pos + 8;
+			s->wavEnd = s->numBytes - s->wavBegin < size ? s->numBytes : s->wavBegin + size;
+			break;
+		}
+		pos += 8 + (size_t)size + (size & 1);
+	}
+	const SDL_AudioFormat sourceFormat = format == 3 && bits == 32 ? AUDIO_F32LSB : format != 1 ? 0
+		: bits == 8 ? AUDIO_U8 : bits == 16 ? AUDIO_S16LSB : bits == 32 ? AUDIO_S32LSB : 0;
+	s->wavFrameBytes = numChannels * bits / 8;
+	if(!sourceFormat || !sampleRate || (numChannels != 1 && numChannels != 2) || s->wavEnd < s->wavBegin + s->wavFrameBytes)
+		return false;
+	s->wav = SDL_NewAudioStream(sourceFormat, numChannels, sampleRate, AUDIO_F32SYS, numChannels, AudioSampleRate());
+	s->numChannels = numChannels;
+	s->wavPos = s->wavBegin;
+	return s->wav != NULL;
+}
+
+/// decodes up to numFrames frames, rewinding looped streams at their end
+/** @return number of decoded frames, 0 at the end of the stream */
+static uint32_t StreamDecode(MusicStream* s, float* out, uint32_t numFrames) {
+	uint32_t numDecoded = 0;
+	if(s->mp3) {
+		bool rewound = false;
+		while(numDecoded < numFrames) {
+			const uint32_t n = (uint32_t)drmp3_read_pcm_frames_f32(s->mp3, numFrames - numDecoded, out + numDecoded * s->numChannels);
+			numDecoded += n;
+			if(n)
+				rewound = false;
+			else if(!s->loop || rewound || !drmp3_seek_to_pcm_frame(s->mp3, 0))
+				break;
+			else
+				rewound = true;
+		}
+		return numDecoded;
+	}
+
+	// looped WAV data is fed continuously into the converter, so that loops are resampled seamlessly
+	const int frameBytes = s->numChannels * sizeof(float);
+	while(SDL_AudioStreamAvailable(s->wav) < (int)numFrames * frameBytes) {
+		if(s->wavPos + s->wavFrameBytes > s->wavEnd) {
+			if(!s->loop) {
+				SDL_AudioStreamFlush(s->wav);
+				break;
+			}
+			s->wavPos = s->wavBegin;
+		}
+		size_t numBytes = s->wavEnd - s->wavPos;
+		if(numBytes > STREAM_CHUNK_FRAMES * s->wavFrameBytes)
+			numBytes = STREAM_CHUNK_FRAMES * s->wavFrameBytes;
+		numBytes -= numBytes % s->wavFrameBytes;
+		if(SDL_AudioStreamPut(s->wav, s->data + s->wavPos, (int)numBytes) != 0)
+			break;
+		s->wavPos += numBytes;
+	}
+	const int numBytes = SDL_AudioStreamGet(s->wav, out, numFrames * frameBytes);
+	return numBytes > 0 ? numBytes / frameBytes : 0;
+}
+
+static void StreamDelete(MusicStream* s) {
+	if(s->mp3) {
+		drmp3_uninit(s->mp3);
+		free(s->mp3);
+	}
+	if(s->wav)
+		SDL_FreeAudioStream(s->wav);
+	free(s->copy);
+	free(s);
+}
+
+/// keeps a stream's queue filled STREAM_AHEAD seconds ahead of playback
+/** @return false if the stream ended or its track was stopped or has been reused */
+static bool StreamRefill(MusicStream* s, uint32_t numAhead) {
+	if(!AudioPlaying(s->track))
+		return false;
+	uint32_t numQueued = AudioPush(s->track, NULL, 0);
+	while(numQueued < numAhead) {
+		const uint32_t numFrames = StreamDecode(s, streamChunk, STREAM_CHUNK_FRAMES);
+		if(!numFrames) { // end of a stream not looped, lasts as long as queued frames play
+			if(numQueued)
+				return true;
+			AudioStop(s->track); // the mixer keeps tracks of emptied queues busy
+			return false;
+		}
+		numQueued = AudioPush(s->track, streamChunk, numFrames);
+		if(!numQueued)
+			return false;
+	}
+	return true;
+}
+
+static int StreamWorker(void* udata) {
+	(void)udata;
+	const uint32_t numAhead = (uint32_t)(AudioSampleRate() * STREAM_AHEAD);
+	SDL_LockMutex(streamMutex);
+	while(!streamQuit) {
+		for(MusicStream** prev = &streams; *prev; ) {
+			MusicStream* s = *prev;
+			if(StreamRefill(s, numAhead))
+				prev = &s->next;
+			else {
+				*prev = s->next;
+				StreamDelete(s);
+			}
+		}
+		SDL_CondWaitTimeout(streamCond, streamMutex, STREAM_INTERVAL);
+	}
+	SDL_UnlockMutex(streamMutex);
+	return 0;
+}
+
+uint32_t arcmAudioStream(const char* name, float volume, bool loop) {
+	if(!streamMutex) {
+		streamMutex = SDL_CreateMutex();
+		streamCond = SDL_CreateCond();
+		streamQuit = false;
+		if(!streamMutex || !streamCond || !(streamThread = SDL_CreateThread(StreamWorker, "arcmStream", NULL))) {
+			fprintf(stderr, "audio stream thread could not be started\n");
+			arcmAudioStreamClose();
+			return UINT32_MAX;
+		}
+	}
+
+	if(ResourceType(name) != RESOURCE_AUDIO)
+		return UINT32_MAX;
+	MusicStream* s = (MusicStream*)calloc(1, sizeof(MusicStream));
+	s->loop = loop;
+	s->data = (const uint8_t*)arcmResourceBinary(name, &s->numBytes, &s->copy);
+	if(!s->data || !(StreamOpenWAV(s) || StreamOpenMP3(s))) {
+		if(s->data)
+			fprintf(stderr, "audio stream \"%s\" could not be decoded\n", name);
+		StreamDelete(s);
+		return UINT32_MAX;
+	}
+
+	// the first chunk is queued right away, so that playback starts immediately
+	SDL_LockMutex(streamMutex);
+	const uint32_t numFrames = StreamDecode(s, streamChunk, STREAM_CHUNK_FRAMES);
+	s->track = numFrames ? AudioQueue(s->numChannels, volume, 0.0f, 0.0f) : UINT32_MAX;
+	if(s->track == UINT32_MAX) {
+		SDL_UnlockMutex(streamMutex);
+		StreamDelete(s);
+		return UINT32_MAX;
+	}
+	AudioPush(s->track, streamChunk, numFrames);
+	for(MusicStream** prev = &streams; *prev; ) { // of a stream whose track ended and got reused
+		MusicStream* other = *prev;
+		if(other->track != s->track)
+			prev = &other->next;
+		else {
+			*prev = other->next;
+			StreamDelete(other);
+		}
+	}
+	s->next = streams;
+	streams = s;
+	SDL_CondSignal(streamCond);
+	SDL_UnlockMutex(streamMutex);
+	return s->track;
+}
+
+void arcmAudioStreamClose() {
+	if(!streamMutex)
+		return;
+	if(streamThread) {
+		SDL_LockMutex(streamMutex);
+		streamQuit = true;
+		SDL_CondSignal(streamCond);
+		SDL_UnlockMutex(streamMutex);
+		SDL_WaitThread(streamThread, NULL);
+		streamThread = NULL;
+	}
+	while(streams) {
+		MusicStream* s = streams;
+		streams = s->next;
+		AudioStop(s->track);
+		StreamDelete(s);
+	}
+	SDL_DestroyCond(streamCond);
+	SDL_DestroyMutex(streamMutex);
+	streamCond = NULL;
+	streamMutex = NULL;
+}
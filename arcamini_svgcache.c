@@ -0,0 +1,202 @@
+#include "arcamini.h"
+
+#include "graphics.h"
+#include "SDL.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// SVG rasterizer exported by arcajs, as used by gfxSVGUpload
+extern unsigned char* svgRasterize(char* svg, float scale, int* w, int* h, int* d);
+
+//--- SVG raster cache ---------------------------------------------
+// SVG images are identified by a 64 bit FNV-1a hash of their text and scale. Images uploaded in
+// this session are looked up in an open addressing hash table, images with an equal hash but a
+// different center share the texture of the first one. Rasterized pixels are additionally kept in
+// a cache directory, so that later sessions only need to upload them. A cache file consists of
+// SVGCACHE_MAGIC, the little endian uint64 hash, uint32 width, height, depth, a uint32 checksum of
+// the pixels, followed by the pixels. Files not matching their hash or checksum are ignored.
+
+#define SVGCACHE_MAGIC "arcmsvg1"
+#define SVGCACHE_MAGIC_SIZE 8
+#define SVGCACHE_HEADER_SIZE (SVGCACHE_MAGIC_SIZE + 8 + 4*4)
+
+typedef struct {
+	uint64_t hash; ///< 0 for an unused slot
+	float centerX, centerY;
+	int filtering;
+	uint32_t handle;
+} SVGCacheEntry;
+
+static SVGCacheEntry* svgCacheEntries = NULL;
+static size_t svgCacheCapacity = 0, svgCacheCount = 0;
+static char* svgCachePath = NULL;
+
+static char* SVGCacheFileName(uint64_t hash, const char* suffix) {
+	char* fname = (char*)malloc(strlen(svgCachePath) + 16 + strlen(suffix) + 1);
+	sprintf(fname, "%s%08x%08x%s", svgCachePath, (uint32_t)(hash >> 32), (uint32_t)hash, suffix);
+	return fname;
+}
+
+static unsigned char* SVGCacheRead(uint64_t hash, int* w, int* h, int* d) {
+	char* fname = SVGCacheFileName(hash, ".rgba");
+	FILE* f = fopen(fname, "rb");
+	free(fname);
+	if(!f)
+		return NULL;
+	uint8_t header[SVGCACHE_HEADER_SIZE];
+	unsigned char* pixels = NULL;
+	const long fileSize = fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;
+	if(fileSize >= SVGCACHE_HEADER_SIZE && fseek(f, 0, SEEK_SET) == 0
+		&& fread(header, 1, SVGCACHE_HEADER_SIZE, f) == SVGCACHE_HEADER_SIZE
+		&& memcmp(header, SVGCACHE_MAGIC, SVGCACHE_MAGIC_SIZE) == 0
+		&& arcmGet32(header+8) == (uint32_t)hash && arcmGet32(header+12) == (uint32_t)(hash >> 32))
+	{
+		const uint8_t* dims = header + SVGCACHE_MAGIC_SIZE + 8;
+		const uint32_t width = arcmGet32(dims), height = arcmGet32(dims+4), depth = arcmGet32(dims+8);
+		// dimensions of a truncated or corrupt file must not determine the allocation
+		const size_t size = (size_t)fileSize - SVGCACHE_HEADER_SIZE;
+		if((depth == 3 || depth == 4) && width && height && size % depth == 0
+			&& (uint64_t)width * height == size / depth)
+		{
+			pixels = (unsigned char*)malloc(size);
+			if(pixels && (fread(pixels, 1, size, f) != size
+				|| (uint32_t)arcmHash(pixels, size, ARCM_HASH_SEED) != arcmGet32(dims+12)))
+			{
+				free(pixels);
+				pixels = NULL;
+			}
+			*w = (int)width;
+			*h = (int)height;
+			*d = (int)depth;
+		}
+	}
+	fclose(f);
+	return pixels;
+}
+
+static void SVGCacheWrite(uint64_t hash, const unsigned char* pixels, int w, int h, int d) {
+	const size_t size = (size_t)w * h * d;
+	uint8_t header[SVGCACHE_HEADER_SIZE];
+	memcpy(header, SVGCACHE_MAGIC, SVGCACHE_MAGIC_SIZE);
+	arcmPut32(header+8, (uint32_t)hash);
+	arcmPut32(header+12, (uint32_t)(hash >> 32));
+	arcmPut32(header+16, (uint32_t)w);
+	arcmPut32(header+20, (uint32_t)h);
+	arcmPut32(header+24, (uint32_t)d);
+	arcmPut32(header+28, (uint32_t)arcmHash(pixels, size, ARCM_HASH_SEED));
+
+	char* fname = SVGCacheFileName(hash, ".rgba");
+	arcmWriteFileAtomic(fname, header, SVGCACHE_HEADER_SIZE, pixels, size);
+	free(fname);
+}
+
+static uint64_t SVGCacheKey(const char* svg, float scale) {
+	uint64_t hash = arcmHash(svg, strlen(svg), ARCM_HASH_SEED);
+	hash = arcmHash(&scale, sizeof(scale), hash);
+	return hash ? hash : 1; // 0 is reserved for unused slots
+}
+
+static unsigned char* SVGCacheRasterize(const char* svg, uint64_t hash, float scale, int* w, int* h, int* d) {
+	unsigned char* pixels = svgCachePath ? SVGCacheRead(hash, w, h, d) : NULL;
+	if(pixels)
+		return pixels;
+	char* svgCopy = strdup(svg); // the parser modifies its input
+	pixels = svgRasterize(svgCopy, scale, w, h, d);
+	free(svgCopy);
+	if(pixels && svgCachePath)
+		SVGCacheWrite(hash, pixels, *w, *h, *d);
+	return pixels;
+}
+
+unsigned char* arcmSVGRasterize(const char* svg, float scale, int* w, int* h, int* d) {
+	return SVGCacheRasterize(svg, SVGCacheKey(svg, scale), scale, w, h, d);
+}
+
+static SVGCacheEntry* SVGCacheFind(uint64_t hash, float centerX, float centerY, int filtering, uint32_t* sibling) {
+	*sibling = 0;
+	if(!svgCacheCapacity)
+		return NULL;
+	for(size_t i = hash & (svgCacheCapacity-1); ; i = (i+1) & (svgCacheCapacity-1)) {
+		SVGCacheEntry* entry = &svgCacheEntries[i];
+		if(!entry->hash)
+			return NULL;
+		if(entry->hash != hash || entry->filtering != filtering)
+			continue;
+		if(entry->centerX == centerX && entry->centerY == centerY)
+			return entry;
+		*sibling = entry->handle;
+	}
+}
+
+static void SVGCacheInsert(uint64_t hash, float centerX, float centerY, int filtering, uint32_t handle) {
+	if((svgCacheCount+1)*2 > svgCacheCapacity) {
+		SVGCacheEntry* entries = svgCacheEntries;
+		const size_t capacity = svgCacheCapacity;
+		svgCacheCapacity = capacity ? capacity*2 : 64;
+		svgCacheEntries = (SVGCacheEntry*)calloc(svgCacheCapacity, sizeof(SVGCacheEntry));
+		svgCacheCount = 0;
+		for(size_t i=0; i<capacity; ++i)
+			if(entries[i].hash)
+				SVGCacheInsert(entries[i].hash, entries[i].centerX, entries[i].centerY, entries[i].filtering, entries[i].handle);
+		free(entries);
+	}
+	size_t i = hash & (svgCacheCapacity-1);
+	while(svgCacheEntries[i].hash)
+		i = (i+1) & (svgCacheCapacity-1);
+	SVGCacheEntry* entry = &svgCacheEntries[i];
+	entry->hash = hash;
+	entry->centerX = centerX;
+	entry->centerY = centerY;
+	entry->filtering = filtering;
+	entry->handle = handle;
+	++svgCacheCount;
+}
+
+uint32_t arcmSVGCacheImage(const char* svg, float scale, float centerX, float centerY, int filtering) {
+	const uint64_t hash = SVGCacheKey(svg, scale);
+	uint32_t sibling;
+	const SVGCacheEntry* entry = SVGCacheFind(hash, centerX, centerY, filtering, &sibling);
+	if(entry)
+		return entry->handle;
+
+	uint32_t handle = 0;
+	if(sibling) { // same pixels, different center
+		int w = 0, h = 0;
+		gfxImageDimensions(sibling, &w, &h);
+		handle = gfxImageTile(sibling, 0, 0, w, h);
+	}
+	else {
+		int w, h, d;
+		unsigned char* pixels = SVGCacheRasterize(svg, hash, scale, &w, &h, &d);
+		if(!pixels)
+			return 0;
+		if(filtering >= 0)
+			gfxTextureFiltering(filtering);
+		handle = gfxImageUpload(pixels, w, h, d, 0xff);
+		free(pixels);
+	}
+	if(!handle)
+		return 0;
+	gfxImageSetCenter(handle, centerX, centerY);
+	SVGCacheInsert(hash, centerX, centerY, filtering, handle);
+	return handle;
+}
+
+void arcmSVGCacheInit(const char* appName) {
+	char* prefPath = SDL_GetPrefPath(appName, "svgcache");
+	if(prefPath) {
+		svgCachePath = strdup(prefPath);
+		SDL_free(prefPath);
+	}
+}
+
+void arcmSVGCacheClose() {
+	free(svgCacheEntries);
+	svgCacheEntries = NULL;
+	svgCacheCapacity = svgCacheCount = 0;
+	free(svgCachePath);
+	svgCachePath = NULL;
+}
@@ -0,0 +1,221 @@
+#include "arcamini.h"
+
+#include "audio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <math.h>
+
+//--- sound effect synthesis ---------------------------------------
+// Sound effects are described by an oscillator, a frequency sliding exponentially from freq to freqEnd
+// with optional vibrato, and an attack/decay/sustain/release envelope, like the envelope() of arcajs.
+// Samples are rendered in passes over the whole buffer: a phase accumulator, which is inherently
+// sequential, then the waveform and the envelope segments, which are branch-free loops the compiler
+// vectorizes. Uploaded samples are kept in an open addressing hash table keyed by a 64 bit FNV-1a hash
+// of their parameters, so that requesting the same effect again only costs a lookup.
+
+/// maximum duration of a synthesized sound in seconds
+#define SYNTH_MAX_DURATION 10.0f
+
+static const char* const synthWaveNames[] = { "square", "sine", "triangle", "sawtooth", "noise", NULL };
+static const char* const synthParamNames[] = { "freq", "freqEnd", "duty", "vibrato", "vibratoFreq",
+	"attack", "decay", "sustain", "sustainLevel", "release", "volume", NULL };
+static const size_t synthParamOffsets[] = { offsetof(ArcmSynthParams, freq), offsetof(ArcmSynthParams, freqEnd),
+	offsetof(ArcmSynthParams, duty), offsetof(ArcmSynthParams, vibrato), offsetof(ArcmSynthParams, vibratoFreq),
+	offsetof(ArcmSynthParams, attack), offsetof(ArcmSynthParams, decay), offsetof(ArcmSynthParams, sustain),
+	offsetof(ArcmSynthParams, sustainLevel), offsetof(ArcmSynthParams, release), offsetof(ArcmSynthParams, volume) };
+
+typedef struct {
+	uint64_t hash; ///< 0 for an unused slot
+	uint32_t sample;
+} SynthCacheEntry;
+
+static SynthCacheEntry* synthCacheEntries = NULL;
+static size_t synthCacheCapacity = 0, synthCacheCount = 0;
+
+void arcmSynthDefaults(ArcmSynthParams* params) {
+	memset(params, 0, sizeof(ArcmSynthParams));
+	params->wave = ARCM_SYNTH_SQUARE;
+	params->freq = 440.0f;
+	params->freqEnd = -1.0f; // equal to freq
+	params->duty = 0.5f;
+	params->vibratoFreq = 6.0f;
+	params->sustain = 0.1f;
+	params->sustainLevel = 1.0f;
+	params->volume = 1.0f;
+}
+
+const char* arcmSynthParamName(unsigned index) {
+	return index < sizeof(synthParamNames)/sizeof(synthParamNames[0]) ? synthParamNames[index] : NULL;
+}
+
+bool arcmSynthParam(ArcmSynthParams* params, const char* name, float value) {
+	for(unsigned i=0; synthParamNames[i]; ++i)
+		if(strcmp(synthParamNames[i], name) == 0) {
+			*(float*)((char*)params + synthParamOffsets[i]) = value;
+			return true;
+		}
+	return false;
+}
+
+bool arcmSynthWave(ArcmSynthParams* params, const char* name) {
+	for(int i=0; synthWaveNames[i]; ++i)
+		if(strcmp(synthWaveNames[i], name) == 0) {
+			params->wave = i;
+			return true;
+		}
+	return false;
+}
+
+static float SynthClamp(float value, float minValue, float maxValue) {
+	return value < minValue ? minValue : value > maxValue ? maxValue : value;
+}
+
+/// clamps parameters to their valid range, so that equal sounds get equal hashes
+static void SynthNormalize(ArcmSynthParams* params) {
+	if(params->wave < 0 || params->wave > ARCM_SYNTH_NOISE)
+		params->wave = ARCM_SYNTH_SQUARE;
+	params->freq = SynthClamp(params->freq, 1.0f, 22050.0f);
+	params->freqEnd = params->freqEnd < 0.0f ? params->freq : SynthClamp(params->freqEnd, 1.0f, 22050.0f);
+	params->duty = SynthClamp(params->duty, 0.0f, 1.0f);
+	params->vibrato = SynthClamp(params->vibrato, 0.0f, 1.0f);
+	params->vibratoFreq = SynthClamp(params->vibratoFreq, 0.0f, 100.0f);
+	params->sustainLevel = SynthClamp(params->sustainLevel, 0.0f, 1.0f);
+	params->volume = SynthClamp(params->volume, 0.0f, 1.0f);
+	float* times[] = { &params->attack, &params->decay, &params->sustain, &params->release };
+	for(int i=0; i<4; ++i)
+		*times[i] = SynthClamp(*times[i], 0.0f, SYNTH_MAX_DURATION);
+}
+
+/// multiplies samples by a linear ramp from v0 to v1
+static void SynthRamp(float* samples, uint32_t count, float v0, float v1) {
+	const float step = count ? (v1 - v0) / count : 0.0f;
+	for(uint32_t i=0; i<count; ++i)
+		samples[i] *= v0 + step * i;
+}
+
+float* arcmSynthRender(const ArcmSynthParams* params, uint32_t* numSamples) {
+	ArcmSynthParams p = *params;
+	SynthNormalize(&p);
+	const uint32_t sampleRate = AudioSampleRate() ? AudioSampleRate() : 44100;
+	const uint32_t segments[] = { (uint32_t)(p.attack * sampleRate), (uint32_t)(p.decay * sampleRate),
+		(uint32_t)(p.sustain * sampleRate), (uint32_t)(p.release * sampleRate) };
+	const uint32_t count = segments[0] + segments[1] + segments[2] + segments[3];
+	*numSamples = count;
+	float* samples = count ? (float*)malloc(count * sizeof(float)) : NULL;
+	if(!samples)
+		return NULL;
+
+	// phase accumulation with an exponential frequency slide and a sine LFO rotated by complex multiplication
+	const double slide = pow(p.freqEnd / p.freq, 1.0 / count);
+	const double lfoAngle = 6.283185307179586 * p.vibratoFreq / sampleRate;
+	const double lfoCos = cos(lfoAngle), lfoSin = sin(lfoAngle);
+	double freq = p.freq, phase = 0.0, lfoX = 1.0, lfoY = 0.0;
+	uint32_t noise = 0x2545f491u;
+	float noiseValue = 0.0f;
+	for(uint32_t i=0; i<count; ++i) {
+		phase += freq * (1.0 + p.vibrato * lfoY) / sampleRate;
+		if(phase >= 1.0) {
+			phase -= floor(phase);
+			noise ^= noise << 13;
+			noise ^= noise >> 17;
+			noise ^= noise << 5;
+			noiseValue = (float)(noise >> 8) * (2.0f / 16777216.0f) - 1.0f;
+		}
+		samples[i] = p.wave == ARCM_SYNTH_NOISE ? noiseValue : (float)phase;
+		freq *= slide;
+		const double x = lfoX * lfoCos - lfoY * lfoSin;
+		lfoY = lfoX * lfoSin + lfoY * lfoCos;
+		lfoX = x;
+	}
+
+	const float duty = p.duty, volume = p.volume;
+	switch(p.wave) {
+	case ARCM_SYNTH_SQUARE:
+		for(uint32_t i=0; i<count; ++i)
+			samples[i] = samples[i] < duty ? volume : -volume;
+		break;
+	case ARCM_SYNTH_SINE: // parabolic approximation, accurate to 0.1%
+		for(uint32_t i=0; i<count; ++i) {
+			const float x = 1.0f - 2.0f * samples[i];
+			const float y = 4.0f * x * (1.0f - fabsf(x));
+			samples[i] = volume * (0.225f * (y * fabsf(y) - y) + y);
+		}
+		break;
+	case ARCM_SYNTH_TRIANGLE:
+		for(uint32_t i=0; i<count; ++i)
+			samples[i] = volume * (1.0f - 4.0f * fabsf(samples[i] - 0.5f));
+		break;
+	case ARCM_SYNTH_SAWTOOTH:
+		for(uint32_t i=0; i<count; ++i)
+			samples[i] = volume * (2.0f * samples[i] - 1.0f);
+		break;
+	default:
+		for(uint32_t i=0; i<count; ++i)
+			samples[i] *= volume;
+		break;
+	}
+
+	float* pos = samples;
+	SynthRamp(pos, segments[0], 0.0f, 1.0f);
+	pos += segments[0];
+	SynthRamp(pos, segments[1], 1.0f, p.sustainLevel);
+	pos += segments[1];
+	SynthRamp(pos, segments[2], p.sustainLevel, p.sustainLevel);
+	pos += segments[2];
+	SynthRamp(pos, segments[3], p.sustainLevel, 0.0f);
+	return samples;
+}
+
+static uint64_t SynthHash(const ArcmSynthParams* params) {
+	const uint64_t hash = arcmHash(params, sizeof(ArcmSynthParams), ARCM_HASH_SEED);
+	return hash ? hash : 1; // 0 is reserved for unused slots
+}
+
+static void SynthCacheInsert(uint64_t hash, uint32_t sample) {
+	if((synthCacheCount+1)*2 > synthCacheCapacity) {
+		SynthCacheEntry* entries = synthCacheEntries;
+		const size_t capacity = synthCacheCapacity;
+		synthCacheCapacity = capacity ? capacity*2 : 64;
+		synthCacheEntries = (SynthCacheEntry*)calloc(synthCacheCapacity, sizeof(SynthCacheEntry));
+		synthCacheCount = 0;
+		for(size_t i=0; i<capacity; ++i)
+			if(entries[i].hash)
+				SynthCacheInsert(entries[i].hash, entries[i].sample);
+		free(entries);
+	}
+	size_t i = hash & (synthCacheCapacity-1);
+	while(synthCacheEntries[i].hash)
+		i = (i+1) & (synthCacheCapacity-1);
+	synthCacheEntries[i].hash = hash;
+	synthCacheEntries[i].sample = sample;
+	++synthCacheCount;
+}
+
+uint32_t arcmAudioSynth(const ArcmSynthParams* params) {
+	ArcmSynthParams p = *params;
+	SynthNormalize(&p);
+	const uint64_t hash = SynthHash(&p);
+	for(size_t i = synthCacheCapacity ? hash & (synthCacheCapacity-1) : 0;
+		synthCacheCapacity && synthCacheEntries[i].hash; i = (i+1) & (synthCacheCapacity-1))
+		if(synthCacheEntries[i].hash == hash)
+			return synthCacheEntries[i].sample;
+
+	uint32_t numSamples;
+	float* samples = arcmSynthRender(&p, &numSamples);
+	if(!samples)
+		return 0;
+	const uint32_t sample = arcmAudioUploadPCM(samples, numSamples, 1, 0); // takes ownership of the samples
+	if(sample)
+		SynthCacheInsert(hash, sample);
+	return sample;
+}
+
+void arcmSynthCacheClose() {
+	free(synthCacheEntries);
+	synthCacheEntries = NULL;
+	synthCacheCapacity = synthCacheCount = 0;
+}
@@ -0,0 +1,49 @@
+#include "arcamini.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+//--- helpers shared by the arcamini modules -----------------------
+// Hashing and byte order of the cache, pack, and storage file formats, and writing cache files. Does not
+// depend on SDL, as arcapack links the archive module only.
+
+uint64_t arcmHash(const void* data, size_t size, uint64_t hash) {
+	for(size_t i=0; i<size; ++i)
+		hash = (hash ^ ((const uint8_t*)data)[i]) * 1099511628211ull;
+	return hash;
+}
+
+void arcmPut32(uint8_t* dest, uint32_t value) {
+	for(int i=0; i<4; ++i, value >>= 8)
+		dest[i] = value & 0xff;
+}
+
+uint32_t arcmGet32(const uint8_t* src) {
+	return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+bool arcmWriteFileAtomic(const char* fileName, const void* header, size_t headerSize, const void* data, size_t size) {
+	// background loader threads may write concurrently, each to a temporary file of its own
+	static atomic_uint tmpCounter;
+	const size_t len = strlen(fileName);
+	char* tmpName = (char*)malloc(len + 16);
+	if(!tmpName)
+		return false;
+	snprintf(tmpName, len + 16, "%s.%x.tmp", fileName, atomic_fetch_add(&tmpCounter, 1u));
+	FILE* f = fopen(tmpName, "wb");
+	bool success = f && fwrite(header, 1, headerSize, f) == headerSize
+		&& fwrite(data, 1, size, f) == size;
+	if(f && fclose(f) != 0)
+		success = false;
+	if(success) {
+		remove(fileName); // rename does not replace existing files on Windows
+		success = rename(tmpName, fileName) == 0;
+	}
+	if(!success)
+		remove(tmpName);
+	free(tmpName);
+	return success;
+}
@@ -0,0 +1,132 @@
+// arcapack - writes directories to pack archives and compares loading resources from both
+#include "arcamini.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#if !(defined __WIN32__ || defined WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static double now() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+/// drops a file from the page cache where supported, so that loading it is measured as on a cold start
+static void evict(const char* path) {
+#ifdef POSIX_FADV_DONTNEED
+	int fd = open(path, O_RDONLY);
+	if(fd < 0)
+		return;
+	fdatasync(fd);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	close(fd);
+#else
+	(void)path;
+#endif
+}
+
+static void evictArchive(const char* dirName, const char* packName) {
+	if(!arcmArchiveOpen(dirName))
+		return;
+	for(size_t i=0; arcmArchiveEntry(i); ++i) {
+		char* path = (char*)malloc(strlen(dirName) + strlen(arcmArchiveEntry(i)) + 2);
+		sprintf(path, "%s/%s", dirName, arcmArchiveEntry(i));
+		evict(path);
+		free(path);
+	}
+	arcmArchiveClose();
+	evict(packName);
+}
+
+/// opens an archive and reads all of its files, as a game loading its resources would
+/** @return seconds taken */
+static double load(const char* archiveName, size_t* numFiles, size_t* numBytes, uint32_t* checksum) {
+	const double start = now();
+	if(!arcmArchiveOpen(archiveName))
+		return -1.0;
+	*numBytes = 0;
+	*checksum = 0;
+	for(*numFiles=0; arcmArchiveEntry(*numFiles); ++*numFiles) {
+		const char* name = arcmArchiveEntry(*numFiles);
+		size_t size = 0;
+		void* copy = NULL;
+		const uint8_t* data = (const uint8_t*)arcmArchiveView(name, &size);
+		if(!data)
+			data = copy = arcmArchiveRead(name, &size);
+		for(size_t j=0; data && j<size; j+=64) // touch every cache line, as a decoder would
+			*checksum = *checksum * 31 + data[j];
+		*numBytes += size;
+		free(copy);
+	}
+	arcmArchiveClose();
+	return now() - start;
+}
+
+static int benchmark(const char* dirName, const char* packName, int runs) {
+	const char* archives[] = { dirName, packName };
+	double best[2] = { 1.0e9, 1.0e9 }, total[2] = { 0.0, 0.0 };
+	size_t numFiles[2] = { 0, 0 }, numBytes[2] = { 0, 0 };
+	uint32_t checksum[2] = { 0, 0 };
+	for(int run=0; run<runs; ++run) {
+		for(int i=0; i<2; ++i) {
+			evictArchive(dirName, packName);
+			const double t = load(archives[i], &numFiles[i], &numBytes[i], &checksum[i]);
+			if(t < 0.0) {
+				fprintf(stderr, "opening archive \"%s\" failed.\n", archives[i]);
+				return -1;
+			}
+			total[i] += t;
+			if(t < best[i])
+				best[i] = t;
+		}
+	}
+	if(numFiles[0] != numFiles[1] || numBytes[0] != numBytes[1] || checksum[0] != checksum[1]) {
+		fprintf(stderr, "contents of \"%s\" and \"%s\" differ.\n", dirName, packName);
+		return -1;
+	}
+	printf("%zu bytes in %zu files, %d cold runs\n", numBytes[0], numFiles[0], runs);
+	for(int i=0; i<2; ++i)
+		printf("%-10s best %8.3f ms  mean %8.3f ms  %s\n", i ? "pack" : "directory",
+			best[i] * 1000.0, total[i] / runs * 1000.0, archives[i]);
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	const char* usage = "usage: %s [-0] directory pack  writes a directory to a pack archive, -0 stores files uncompressed\n"
+		"       %s -b directory pack [runs]  compares loading all files of a directory and its pack\n";
+	bool compress = true, bench = false;
+	int argn;
+	for(argn=1; argn<argc && argv[argn][0]=='-'; ++argn) {
+		if(strcmp(argv[argn],"-0")==0)
+			compress = false;
+		else if(strcmp(argv[argn],"-b")==0)
+			bench = true;
+		else {
+			fprintf(stderr, "Unknown option: %s\n", argv[argn]);
+			return 99;
+		}
+	}
+	if(argc - argn < 2 || (!bench && argc - argn > 2) || argc - argn > 3) {
+		fprintf(stderr, usage, argv[0], argv[0]);
+		return 99;
+	}
+	const char* dirName = argv[argn], *packName = argv[argn+1];
+	if(bench)
+		return benchmark(dirName, packName, argc - argn > 2 ? atoi(argv[argn+2]) : 5);
+
+	if(!arcmArchivePack(dirName, packName, compress)) {
+		fprintf(stderr, "Packing \"%s\" into \"%s\" failed.\n", dirName, packName);
+		return -1;
+	}
+	arcmArchiveOpen(packName);
+	printf("%s -> %s (%zu files)\n", dirName, packName, (size_t)arcmArchiveStats("archiveEntries"));
+	arcmArchiveClose();
+	return 0;
+}
@@ -31,22 +31,44 @@ static void onDebugSession(int evt) {
 //------------------------------------------------------------------
 
 int main(int argc, char** argv) {
-	int winSzX = 640, winSzY = 480, windowFlags = WINDOW_VSYNC;
+	int winSzX = 0, winSzY = 0, windowFlags = WINDOW_VSYNC;
 	char* archiveName = NULL;
 	int debug_port = 0;
-	const char* usage = "usage: %s [-w width] [-h height] [-f(ullscreen)] [-d debug_port] script.py [arg1, arg2, ...]\n";
+	bool compileOnly = false;
+	const char* bundleName = NULL;
+	const char* usage = "usage: %s [-w width] [-h height] [-f(ullscreen)] [-d debug_port] [-l latch_mode] script.py [arg1, arg2, ...]\n"
+		"  -c script.py [module.py ...]  writes stripped bytecode of scripts as <name>.bc into their archive\n"
+		"  --bundle executable script.py  writes a single-file executable running the script, its archive\n"
+		"                                 appended and its scripts compiled to bytecode\n"
+		"  --startup-profile[=json]  reports the time taken by each startup stage until the first frame\n"
+		"  --trace=file.json  writes frame and audio mixer timing as a trace for chrome://tracing or Perfetto\n";
+	// executables with a bundle appended run its script, no script argument needed
+	const char* bundledScript = arcmArchiveOpenBundle(argv[0]);
+	const int lastArg = bundledScript ? argc : argc-1;
 	int argn;
-	for(argn=1; argn<argc-1; ++argn) {
+	for(argn=1; argn<lastArg; ++argn) {
 		if(strcmp(argv[argn],"-f")==0)
 			windowFlags |= WINDOW_FULLSCREEN;
-		else if(strcmp(argv[argn],"-w")==0 && argn+1<argc-1)
+		else if(strcmp(argv[argn],"-w")==0 && argn+1<lastArg)
 			winSzX = atoi(argv[++argn]);
-		else if(strcmp(argv[argn],"-h")==0 && argn+1<argc-1)
+		else if(strcmp(argv[argn],"-h")==0 && argn+1<lastArg)
 			winSzY = atoi(argv[++argn]);
-		else if(strcmp(argv[argn],"-d")==0 && argn+1<argc-1) {
+		else if(strcmp(argv[argn],"-l")==0 && argn+1<lastArg)
+			arcmWindowLateLatch(atoi(argv[++argn]));
+		else if(strcmp(argv[argn],"-d")==0 && argn+1<lastArg) {
 			debug_port = atoi(argv[++argn]);
 			debug = 1;
 		}
+		else if(strcmp(argv[argn],"-c")==0)
+			compileOnly = true;
+		else if(strcmp(argv[argn],"--bundle")==0 && argn+1<lastArg)
+			bundleName = argv[++argn];
+		else if(strncmp(argv[argn],"--startup-profile",17)==0 && (!argv[argn][17] || strcmp(argv[argn]+17,"=json")==0))
+			arcmStartupProfile(argv[argn][17] != 0);
+		else if(strncmp(argv[argn],"--trace=",8)==0 && argv[argn][8]) {
+			if(!arcmTraceOpen(argv[argn]+8))
+				fprintf(stderr, "Opening trace file \"%s\" failed.\n", argv[argn]+8);
+		}
 		else if(argv[argn][0] == '-') {
 			fprintf(stderr, "Unknown option: %s\n", argv[argn]);
 			return 99;
@@ -54,49 +76,91 @@ int main(int argc, char** argv) {
 		else break;
 	}
 
-	char* scriptName = argn < argc ? argv[argn] : NULL;
+	const bool bundled = bundledScript && !bundleName && !compileOnly;
+	char* scriptName = bundled ? (char*)bundledScript : argn < argc ? argv[argn] : NULL;
 	if(!scriptName || strcmp(ResourceSuffix(scriptName),"py")!=0) {
 		fprintf(stderr, usage, argv[0]);
 		return 99;
 	}
 
-	size_t pos = strlen(scriptName)-1;
-	while(pos>0) {
-		if(scriptName[pos]==PATHSEP)
-			break;
-		--pos;
-	}
-	if(!pos)
-		archiveName=".";
+	if(bundled)
+		--argn; // script arguments directly follow the options
 	else {
-		archiveName = scriptName;
-		archiveName[pos] = 0;
-		scriptName = &archiveName[pos+1];
-	}
+		arcmArchiveClose(); // of a bundled executable writing another bundle
+		size_t pos = strlen(scriptName)-1;
+		while(pos>0) {
+			if(scriptName[pos]==PATHSEP)
+				break;
+			--pos;
+		}
+		if(!pos)
+			archiveName=".";
+		else {
+			archiveName = scriptName;
+			archiveName[pos] = 0;
+			scriptName = &archiveName[pos+1];
+		}
 
-	if(!ResourceArchiveOpen(archiveName)) {
-		fprintf(stderr, "Opening archive \"%s\" failed.\n", archiveName);
-		return -1;
+		// directories are mapped in addition to arcajs reading them, packs are read by arcamini only
+		const bool mapped = arcmArchiveOpen(archiveName);
+		if(!(mapped && arcmArchivePacked()) && !ResourceArchiveOpen(archiveName)) {
+			fprintf(stderr, "Opening archive \"%s\" failed.\n", archiveName);
+			return -1;
+		}
 	}
-	char* script = ResourceGetText(scriptName);
-	if (!script) {
-		fprintf(stderr, "Opening script \"%s\" failed.\n", scriptName);
-		return -1;
+	arcmStartupStage("archive");
+	if(compileOnly) {
+		int result = 0;
+		for(int i=argn; i<argc; ++i) {
+			const char* name = i==argn ? scriptName : argv[i];
+			char* fileName = (char*)malloc(strlen(archiveName) + strlen(name) + 5);
+			sprintf(fileName, "%s%c%s.bc", archiveName, PATHSEP, name);
+			if(compileScript(name, fileName))
+				printf("%s -> %s\n", name, fileName);
+			else {
+				fprintf(stderr, "compiling \"%s\" failed.\n", name);
+				result = -1;
+			}
+			free(fileName);
+		}
+		arcmArchiveClose();
+		ResourceArchiveClose();
+		return result;
 	}
-
+	if(bundleName) {
+		const bool success = arcmArchiveBundle(argv[0], archiveName, scriptName, bundleName, "py", compileScript);
+		if(success)
+			printf("%s -> %s\n", archiveName, bundleName);
+		else
+			fprintf(stderr, "bundling \"%s\" failed.\n", archiveName);
+		ResourceArchiveClose();
+		return success ? 0 : -1;
+	}
+	// the manifest configures window and audio, options take precedence
+	arcmManifestOpen(scriptName);
+	if(!winSzX)
+		winSzX = arcmManifestInt("window_width", 640);
+	if(!winSzY)
+		winSzY = arcmManifestInt("window_height", 480);
+	if(strcmp(arcmManifestString("display", ""), "fullscreen")==0)
+		windowFlags |= WINDOW_FULLSCREEN;
+	arcmStartupStage("manifest");
+
+	// audio, storage, and reading the script proceed on worker threads while the window opens
 	srand(time(NULL));
-	AudioOpen(44100, 8);
-	AudioSetVolume(0.5);
+	char* scriptBaseName = ResourceBaseName(scriptName);
+	arcmStartupBegin("arcapy", scriptBaseName, scriptName, scriptBytecodeFormat, arcmManifestInt("audio_tracks", 8));
 	if(WindowOpen(winSzX, winSzY, windowFlags)!=0) {
 		fprintf(stderr, "Setting video mode failed.\n");
+		arcmStartupJoin(NULL);
 		return -1;
 	}
+	arcmStartupStage("window open");
 	winSzX = WindowWidth();
 	winSzY = WindowHeight();
 	gfxInit(winSzX, winSzY, 1, WindowRenderer());
+	arcmStartupStage("graphics init");
 
-	char* scriptBaseName = ResourceBaseName(scriptName);
-	arcmStorageInit("arcapy", scriptBaseName);
 	for(char* pch = scriptBaseName; *pch; ++pch)
 		if(*pch=='_')
 			*pch=' ';
@@ -104,23 +168,32 @@ int main(int argc, char** argv) {
 	free(scriptBaseName);
 	WindowShowPointer(0);
 
+	// scripts shipped as bytecode only have no source
+	char* scriptCopy;
+	const char* script = arcmStartupJoin(&scriptCopy);
+	const bool preloaded = arcmManifestPreload();
+	arcmStartupStage("preload");
+
 	void* vm = initVM(script, scriptName);
-	free(script);
+	free(scriptCopy);
 	if(!vm) {
 		fprintf(stderr, "evaluating \"%s\" failed.\n", scriptName);
 		return -1;
 	}
+	arcmStartupStage("vm init and script evaluation");
 	pkpy_debug_init(debug_port, "breakpoint", onDebugSession);
 
-	for(size_t i=0; i<WindowNumControllers(); ++i)
-		WindowControllerOpen(i, 0);
+	// controllers are opened on first use when input is polled, as they get connected
 	WindowEventHandler(arcmDispatchInputEvents, vm);
 
-	if(dispatchLifecycleEventArgv("enter", argc-argn-1, argv+argn+1, vm)) {
+	const bool entered = preloaded && dispatchLifecycleEventArgv("enter", argc-argn-1, argv+argn+1, vm);
+	arcmStartupStage("enter");
+	if(entered) {
 		while(WindowIsOpen()) {
 			if (debug_port > 0)
 				pkpy_debug_poll();
-			if(!dispatchUpdateEvent(WindowDeltaT(), vm))
+			arcmResourceUploadPending();
+			if(!arcmWindowLatchInput(vm) || !dispatchUpdateEvent(WindowDeltaT(), vm))
 				break;
 
 			gfxBeginFrame(WindowGetClearColor());
@@ -129,6 +202,7 @@ int main(int argc, char** argv) {
 
 			if(WindowUpdate()!=0)
 				break;
+			arcmStartupPresented();
 		}
 		dispatchLifecycleEvent("leave", vm);
 	}
@@ -149,10 +223,19 @@ int main(int argc, char** argv) {
 	}
 	pkpy_debug_shutdown();
 	shutdownVM(vm);
+	arcmResourceLoaderClose();
+	arcmAudioStreamClose();
+	arcmManifestClose();
+	arcmSVGCacheClose();
+	arcmAudioCacheClose();
+	arcmBytecodeCacheClose();
+	arcmArchiveClose();
 	ResourceArchiveClose();
 	if(debug) {
 		printf(" audio..."); fflush(stdout);
 	}
+	arcmTraceClose();
+	arcmSynthCacheClose();
 	AudioClose();
 	arcmStorageClose();
 	if(debug) {
@@ -13,7 +13,11 @@ class Beeper {
         const key = `${Math.floor(freq)}_${Math.floor(duration * 1000)}_${Math.floor(timbre * 100)}`;
 
         let source = this.sources[key];
-        if (!source) {
+        if (!source && audio.synth) { // native runtimes
+            source = audio.synth({ wave: 'square', freq, duty: timbre, sustain: duration });
+            this.sources[key] = source;
+        }
+        else if (!source) {
             const sampleCount = Math.floor(duration * rate);
             const samples = new Float32Array(sampleCount);
             const p = Math.floor(rate / freq);
@@ -16,7 +16,10 @@ function Beeper:beep(freq, duration, vol, timbre, pan)
 
     -- Retrieve from cache if available
     local source = self.sources[key]
-    if not source then
+    if not source and audio.synth then -- native runtimes
+        source = audio.synth({wave='square', freq=freq, duty=timbre, sustain=duration})
+        self.sources[key] = source
+    elseif not source then
         local sampleCount = math.floor(duration * rate)
         local audioData = {}
 
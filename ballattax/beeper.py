@@ -10,7 +10,10 @@ class Beeper:
         rate = 44100
         key = f"{int(freq)}_{int(duration * 1000)}_{int(timbre * 100)}"
         source = self.sources.get(key)
-        if not source:
+        if not source and hasattr(audio, 'synth'): # native runtimes
+            source = audio.synth({'wave': 'square', 'freq': freq, 'duty': timbre, 'sustain': duration})
+            self.sources[key] = source
+        elif not source:
             sample_count = int(duration * rate)
             samples = [(1 if (i % int(rate / freq) < int(timbre * int(rate / freq))) else -1) for i in range(sample_count)]
             source = resource.createAudio(samples, 1)
@@ -3,26 +3,69 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /// creates and initializes a VM and returns its state
-/// @param script      Lua source code to evaluate
+/// @param script      source code to evaluate, or NULL for a script shipped as bytecode
 /// @param scriptName  filename (used in stack traces / error messages)
 /// @return void* or NULL if initialization failed
 extern void* initVM(const char* script, const char* scriptName);
 
+/// identifier of the VM's bytecode format, see arcmBytecodeLoad
+extern const char* const scriptBytecodeFormat;
+
 /// deinitializes a  VM
 /// @param state  vm handle returned by initVM
 extern void shutdownVM(void* vm);
 
+/// compiles a script from the resource archive to stripped bytecode to be shipped in its place,
+/// using a VM of its own
+/// @param scriptName  name of the script within the resource archive
+/// @param fileName    name of the bytecode file to write
+/// @return false in case of errors
+extern bool compileScript(const char* scriptName, const char* fileName);
+
+/// lifecycle callbacks a script may define. Bindings resolve them once per
+/// loaded scene instead of looking them up by name on every dispatch.
+typedef enum {
+	LIFECYCLE_ENTER = 0,
+	LIFECYCLE_INPUT,
+	LIFECYCLE_INPUT_BATCH,
+	LIFECYCLE_UPDATE,
+	LIFECYCLE_DRAW,
+	LIFECYCLE_LEAVE,
+	LIFECYCLE_NUM
+} LifecycleCallback;
+
+/// @return script-visible name of a lifecycle callback
+static inline const char* lifecycleName(LifecycleCallback cb) {
+	static const char* const names[LIFECYCLE_NUM] = { "enter", "input", "inputBatch", "update", "draw", "leave" };
+	return names[cb];
+}
+
+/// @return index of a lifecycle callback by name, or LIFECYCLE_NUM if evtName is not one of them
+static inline LifecycleCallback lifecycleCallback(const char* evtName) {
+	int cb = 0;
+	while(cb < LIFECYCLE_NUM && strcmp(evtName, lifecycleName((LifecycleCallback)cb))!=0)
+		++cb;
+	return (LifecycleCallback)cb;
+}
+
 /// dispatch main loop events to handler functions, if they exist
 bool dispatchLifecycleEvent(const char* evtName, void* callback);
 bool dispatchLifecycleEventArgv(const char* evtName, int argc, char** argv, void* callback);
-void dispatchAxisEvent(size_t id, uint8_t axis, float value, void* callback);
-void dispatchButtonEvent(size_t id, uint8_t button, float value, void* callback);
+/// input events carry the timestamp in seconds when they were polled as value2,
+/// counted since startup on the input clock of arcamini.c, not the update() frame clock
+void dispatchAxisEvent(size_t id, uint8_t axis, float value, double timestamp, void* callback);
+void dispatchButtonEvent(size_t id, uint8_t button, float value, double timestamp, void* callback);
+/// hands all input events of a frame to an inputBatch handler in a single call
+/// @param events  numEvents * ARCM_INPUT_EVENT_STRIDE packed values
+/// @return false if the script defines no inputBatch handler
+bool dispatchInputBatch(const double* events, size_t numEvents, void* callback);
 bool dispatchUpdateEvent(double deltaT, void* callback);
 void dispatchDrawEvent(void* callback);
 
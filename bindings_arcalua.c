@@ -25,6 +25,131 @@ static void handleException(lua_State *L) {
     WindowEmitClose();
 }
 
+// identifies bytecode of this Lua version in the bytecode cache
+#define LUA_BYTECODE_FORMAT "lua" LUA_VERSION_MAJOR "." LUA_VERSION_MINOR
+const char* const scriptBytecodeFormat = LUA_BYTECODE_FORMAT;
+
+typedef struct {
+    char* data;
+    size_t size, capacity;
+} BytecodeBuffer;
+
+static int writeBytecode(lua_State* L, const void* p, size_t sz, void* ud) {
+    BytecodeBuffer* buf = (BytecodeBuffer*)ud;
+    if(buf->size + sz > buf->capacity) {
+        buf->capacity = (buf->size + sz) * 2;
+        buf->data = (char*)realloc(buf->data, buf->capacity);
+    }
+    if(sz)
+        memcpy(buf->data + buf->size, p, sz);
+    buf->size += sz;
+    return 0;
+}
+
+/// loads a chunk from the bytecode cache, or compiles its source and caches the result.
+/// A NULL script loads a chunk shipped as bytecode. Scene bytecode is also kept in the scene cache.
+/** @return status as luaL_loadbuffer, leaving the chunk or an error message on the stack */
+static int loadChunk(lua_State* L, const char* script, const char* name, bool scene) {
+    size_t size;
+    char* bytecode = (char*)arcmBytecodeLoad(name, script, LUA_BYTECODE_FORMAT, &size);
+    if(bytecode) {
+        int status = luaL_loadbufferx(L, bytecode, size, name, "b");
+        if(scene && status == LUA_OK)
+            arcmSceneCacheStore(name, bytecode, size);
+        free(bytecode);
+        if(status == LUA_OK || !script)
+            return status;
+        lua_pop(L, 1); // outdated bytecode, recompile
+    }
+    if(!script) {
+        lua_pushfstring(L, "could not load %s", name);
+        return LUA_ERRFILE;
+    }
+    int status = luaL_loadbuffer(L, script, strlen(script), name);
+    if(status == LUA_OK) {
+        BytecodeBuffer buf = { NULL, 0, 0 };
+        if(lua_dump(L, writeBytecode, &buf, 0) == 0) {
+            arcmBytecodeStore(name, script, LUA_BYTECODE_FORMAT, buf.data, buf.size);
+            if(scene)
+                arcmSceneCacheStore(name, buf.data, buf.size);
+        }
+        free(buf.data);
+    }
+    return status;
+}
+
+/// loads the chunk of a scene, preferably from the scene cache. Running it
+/// again redefines the scene's globals, as if it were loaded anew.
+static int loadScene(lua_State* L, const char* script, const char* name) {
+    size_t size;
+    const char* bytecode = (const char*)arcmSceneCacheLoad(name, &size);
+    if(bytecode)
+        return luaL_loadbufferx(L, bytecode, size, name, "b");
+    return loadChunk(L, script, name, true);
+}
+
+// package.searchers entry preceding the file searcher, loads modules from the
+// resource archive via loadChunk, and thereby also modules shipped as bytecode
+static int lua_searchArchive(lua_State* L) {
+    const char* modname = luaL_checkstring(L, 1);
+    const char* path = luaL_gsub(L, modname, ".", "/");
+    static const char* const templates[] = { "%s.lua", "%s/init.lua" };
+    for(size_t i=0; i<sizeof(templates)/sizeof(templates[0]); ++i) {
+        const char* fname = lua_pushfstring(L, templates[i], path);
+        char* copy;
+        const char* script = arcmResourceText(fname, &copy);
+        if(!script && !arcmBytecodeShipped(fname, LUA_BYTECODE_FORMAT)) {
+            lua_pop(L, 1);
+            continue;
+        }
+        int status = loadChunk(L, script, fname, false);
+        free(copy);
+        if(status != LUA_OK)
+            return luaL_error(L, "error loading module '%s' from resource '%s':\n\t%s",
+                modname, fname, lua_tostring(L, -1));
+        lua_pushvalue(L, -2);
+        return 2; // loader and its resource name
+    }
+    lua_pushfstring(L, "no resource '%s.lua'", path);
+    return 1;
+}
+
+// Registry references to the global lifecycle functions, resolved once per
+// loaded scene instead of looked up by name on every dispatch. LUA_NOREF if
+// the script does not define a callback.
+static int lifecycle_refs[LIFECYCLE_NUM];
+// registry references to the gfx table and the event type arguments of input()
+static int ref_gfx = LUA_NOREF, ref_axis = LUA_NOREF, ref_button = LUA_NOREF;
+// registry reference to the onProgress handler of resource.load(), until it reported completion
+static int ref_load_progress = LUA_NOREF;
+
+static void resolveLifecycleCallbacks(lua_State *L) {
+    for(int i=0; i<LIFECYCLE_NUM; ++i) {
+        luaL_unref(L, LUA_REGISTRYINDEX, lifecycle_refs[i]);
+        if(lua_getglobal(L, lifecycleName((LifecycleCallback)i)) == LUA_TFUNCTION)
+            lifecycle_refs[i] = luaL_ref(L, LUA_REGISTRYINDEX);
+        else {
+            lua_pop(L, 1);
+            lifecycle_refs[i] = LUA_NOREF;
+        }
+    }
+}
+
+/// pushes the handler of evtName and returns true, or pushes nothing and returns false
+static bool pushLifecycleFunction(lua_State *L, const char* evtName) {
+    LifecycleCallback cb = lifecycleCallback(evtName);
+    if(cb < LIFECYCLE_NUM) {
+        if(lifecycle_refs[cb] == LUA_NOREF)
+            return false;
+        lua_rawgeti(L, LUA_REGISTRYINDEX, lifecycle_refs[cb]);
+        return true;
+    }
+    if(lua_getglobal(L, evtName) == LUA_TFUNCTION)
+        return true;
+    lua_pop(L, 1);
+    return false;
+}
+
 // --- Window Functions ---
 static int lua_WindowWidth(lua_State *L) {
     lua_pushinteger(L, WindowWidth());
@@ -42,6 +167,51 @@ static int lua_WindowClearColor(lua_State *L) {
     return 0;
 }
 
+static int lua_WindowAxisFilter(lua_State *L) {
+    float resolution = (float)luaL_optnumber(L, 1, 0.1);
+    float deadzone = (float)luaL_optnumber(L, 2, 0.0);
+    arcmWindowAxisFilter(resolution, deadzone);
+    return 0;
+}
+
+static int lua_WindowInputState(lua_State *L) {
+    size_t device = (size_t)luaL_checkinteger(L, 1);
+    uint32_t buttons;
+    float axes[16];
+    const int numAxes = arcmWindowInputState(device, &buttons, axes, 16);
+    lua_createtable(L, numAxes + 1, 0);
+    lua_pushinteger(L, buttons);
+    lua_rawseti(L, -2, 1);
+    for(int i=0; i<numAxes; ++i) {
+        lua_pushnumber(L, axes[i]);
+        lua_rawseti(L, -2, i + 2);
+    }
+    return 1;
+}
+
+static int lua_WindowPressed(lua_State *L) {
+    size_t device = (size_t)luaL_checkinteger(L, 1);
+    lua_Integer button = luaL_checkinteger(L, 2);
+    lua_pushboolean(L, button >= 0 && button < 256 && arcmWindowPressed(device, (uint8_t)button));
+    return 1;
+}
+
+static int lua_WindowReleased(lua_State *L) {
+    size_t device = (size_t)luaL_checkinteger(L, 1);
+    lua_Integer button = luaL_checkinteger(L, 2);
+    lua_pushboolean(L, button >= 0 && button < 256 && arcmWindowReleased(device, (uint8_t)button));
+    return 1;
+}
+
+static int lua_WindowStats(lua_State *L) {
+    double value = arcmWindowStats(luaL_checkstring(L, 1));
+    if(isnan(value))
+        lua_pushnil(L);
+    else
+        lua_pushnumber(L, value);
+    return 1;
+}
+
 static int lua_WindowSwitchScene(lua_State *L) {
     const char* fname = luaL_checkstring(L, 1);
     int argc = lua_gettop(L);
@@ -50,9 +220,15 @@ static int lua_WindowSwitchScene(lua_State *L) {
 		args[i-1] = lua_tostring(L, i+1);
 	}
 
-	char* script = ResourceGetText(fname);
-	if(!script)
+	// scenes visited or preloaded before are compiled already
+	size_t size;
+	bool cached = arcmSceneCacheLoad(fname, &size) != NULL;
+	char* copy = NULL;
+	const char* script = cached ? NULL : arcmResourceText(fname, &copy);
+	if(!cached && !script && !arcmBytecodeShipped(fname, LUA_BYTECODE_FORMAT)) {
+		free(args);
 		return luaL_error(L, "window.switchScene(%s): file not found", fname);
+	}
 
 	// call leave event on current script
 	dispatchLifecycleEvent("leave", L);
@@ -63,8 +239,9 @@ static int lua_WindowSwitchScene(lua_State *L) {
     lua_pushnil(L); lua_setglobal(L, "draw");
     lua_pushnil(L); lua_setglobal(L, "leave");
 
-    bool ok = luaL_loadbuffer(L, script, strlen(script), fname) == LUA_OK && lua_pcall(L, 0, 0, 0) == LUA_OK;
-    free(script);
+    bool ok = loadScene(L, script, fname) == LUA_OK && lua_pcall(L, 0, 0, 0) == LUA_OK;
+    free(copy);
+    resolveLifecycleCallbacks(L);
     if(!ok) {
         free(args);
         return luaL_error(L, "window.switchScene(%s) error: %s", fname, lua_tostring(L, -1));
@@ -75,11 +252,33 @@ static int lua_WindowSwitchScene(lua_State *L) {
     return 0;
 }
 
+static int lua_WindowPreloadScene(lua_State *L) {
+    const char* fname = luaL_checkstring(L, 1);
+    size_t size;
+    if(arcmSceneCacheLoad(fname, &size))
+        return 0;
+    char* copy;
+    const char* script = arcmResourceText(fname, &copy);
+    if(!script && !arcmBytecodeShipped(fname, LUA_BYTECODE_FORMAT))
+        return luaL_error(L, "window.preloadScene(%s): file not found", fname);
+    int status = loadChunk(L, script, fname, true);
+    free(copy);
+    if(status != LUA_OK)
+        return luaL_error(L, "window.preloadScene(%s) error: %s", fname, lua_tostring(L, -1));
+    return 0; // only the bytecode is kept, switchScene runs it
+}
+
 static const luaL_Reg window_funcs[] = {
     {"width", lua_WindowWidth},
     {"height", lua_WindowHeight},
     {"color", lua_WindowClearColor},
     {"switchScene", lua_WindowSwitchScene},
+    {"preloadScene", lua_WindowPreloadScene},
+    {"axisFilter", lua_WindowAxisFilter},
+    {"inputState", lua_WindowInputState},
+    {"pressed", lua_WindowPressed},
+    {"released", lua_WindowReleased},
+    {"stats", lua_WindowStats},
     {NULL, NULL}
 };
 
@@ -190,6 +389,194 @@ static const luaL_Reg gfx_funcs[] = {
     {NULL, NULL}
 };
 
+// --- Buffer Functions ---
+
+#define BUFFER_META "arcamini.buffer"
+
+static ArcmBuffer* lua_newbuffer(lua_State *L, ArcmBufferType type, lua_Integer count) {
+    const size_t size = count >= 0 ? arcmBufferSize(type, (size_t)count) : 0;
+    if (!size)
+        luaL_error(L, "buffer size %I out of range", count);
+    ArcmBuffer* buf = (ArcmBuffer*)lua_newuserdata(L, size);
+    arcmBufferInit(buf, type, (size_t)count);
+    luaL_setmetatable(L, BUFFER_META);
+    return buf;
+}
+
+static void lua_pushbufferelement(lua_State *L, const ArcmBuffer* buf, size_t index) {
+    const double value = arcmBufferGet(buf, index);
+    if (buf->type == ARCM_BUFFER_FLOAT32)
+        lua_pushnumber(L, value);
+    else
+        lua_pushinteger(L, (lua_Integer)value);
+}
+
+/// converts a 1-based inclusive range of optional arguments to a first index and count
+static size_t lua_bufferrange(lua_State *L, const ArcmBuffer* buf, int arg, size_t* first) {
+    lua_Integer i = luaL_optinteger(L, arg, 1), j = luaL_optinteger(L, arg + 1, buf->count);
+    if (i < 1)
+        i = 1;
+    if (j > (lua_Integer)buf->count)
+        j = buf->count;
+    *first = (size_t)(i - 1);
+    return j >= i ? (size_t)(j - i + 1) : 0;
+}
+
+// binding for buffer.new(type, sizeOrValues) creating a buffer of zeroes or of the values of a table
+static int lua_bufferNew(lua_State *L) {
+    const int type = arcmBufferTypeId(luaL_checkstring(L, 1));
+    if (type < 0)
+        return luaL_argerror(L, 1, "expects buffer type float32, uint32, or uint8");
+    if (!lua_istable(L, 2)) {
+        lua_newbuffer(L, (ArcmBufferType)type, luaL_checkinteger(L, 2));
+        return 1;
+    }
+    const lua_Integer count = (lua_Integer)lua_rawlen(L, 2);
+    ArcmBuffer* buf = lua_newbuffer(L, (ArcmBufferType)type, count);
+    for (lua_Integer i = 0; i < count; ++i) {
+        lua_rawgeti(L, 2, i + 1);
+        int isnum;
+        const lua_Number value = lua_tonumberx(L, -1, &isnum);
+        if (!isnum)
+            return luaL_error(L, "buffer.new() expects numeric values, got %s at position %I", luaL_typename(L, -1), i + 1);
+        arcmBufferSet(buf, (size_t)i, value);
+        lua_pop(L, 1);
+    }
+    return 1;
+}
+
+static int lua_bufferIndex(lua_State *L) {
+    const ArcmBuffer* buf = (const ArcmBuffer*)luaL_checkudata(L, 1, BUFFER_META);
+    if (lua_type(L, 2) == LUA_TSTRING) { // method lookup
+        lua_pushvalue(L, 2);
+        lua_rawget(L, lua_upvalueindex(1));
+        return 1;
+    }
+    const lua_Integer i = luaL_checkinteger(L, 2);
+    luaL_argcheck(L, i >= 1 && i <= (lua_Integer)buf->count, 2, "buffer index out of range");
+    lua_pushbufferelement(L, buf, (size_t)(i - 1));
+    return 1;
+}
+
+static int lua_bufferNewIndex(lua_State *L) {
+    ArcmBuffer* buf = (ArcmBuffer*)luaL_checkudata(L, 1, BUFFER_META);
+    const lua_Integer i = luaL_checkinteger(L, 2);
+    luaL_argcheck(L, i >= 1 && i <= (lua_Integer)buf->count, 2, "buffer index out of range");
+    arcmBufferSet(buf, (size_t)(i - 1), luaL_checknumber(L, 3));
+    return 0;
+}
+
+static int lua_bufferLen(lua_State *L) {
+    const ArcmBuffer* buf = (const ArcmBuffer*)luaL_checkudata(L, 1, BUFFER_META);
+    lua_pushinteger(L, buf->count);
+    return 1;
+}
+
+static int lua_bufferToString(lua_State *L) {
+    const ArcmBuffer* buf = (const ArcmBuffer*)luaL_checkudata(L, 1, BUFFER_META);
+    lua_pushfstring(L, "buffer(%s, %d)", arcmBufferTypeName((ArcmBufferType)buf->type), (int)buf->count);
+    return 1;
+}
+
+static int lua_bufferType(lua_State *L) {
+    const ArcmBuffer* buf = (const ArcmBuffer*)luaL_checkudata(L, 1, BUFFER_META);
+    lua_pushstring(L, arcmBufferTypeName((ArcmBufferType)buf->type));
+    return 1;
+}
+
+// binding for buffer:fill(value[, first, last])
+static int lua_bufferFill(lua_State *L) {
+    ArcmBuffer* buf = (ArcmBuffer*)luaL_checkudata(L, 1, BUFFER_META);
+    const double value = luaL_checknumber(L, 2);
+    size_t first;
+    const size_t count = lua_bufferrange(L, buf, 3, &first);
+    arcmBufferFill(buf, value, first, count);
+    lua_settop(L, 1);
+    return 1;
+}
+
+// binding for buffer:slice([first, last]) returning a copy of a range of elements
+static int lua_bufferSlice(lua_State *L) {
+    const ArcmBuffer* buf = (const ArcmBuffer*)luaL_checkudata(L, 1, BUFFER_META);
+    size_t first;
+    const size_t count = lua_bufferrange(L, buf, 2, &first);
+    ArcmBuffer* slice = lua_newbuffer(L, (ArcmBufferType)buf->type, (lua_Integer)count);
+    arcmBufferSlice(slice, buf, first);
+    return 1;
+}
+
+static int lua_bufferApply(lua_State *L, ArcmBufferOp op, const char* name) {
+    ArcmBuffer* buf = (ArcmBuffer*)luaL_checkudata(L, 1, BUFFER_META);
+    const ArcmBuffer* src = (const ArcmBuffer*)luaL_testudata(L, 2, BUFFER_META);
+    const double scalar = src ? luaL_optnumber(L, 3, 1.0) : luaL_checknumber(L, 2);
+    if (!arcmBufferApply(buf, op, src, scalar))
+        return luaL_error(L, "buffer:%s() expects a buffer of equal length", name);
+    lua_settop(L, 1);
+    return 1;
+}
+
+// binding for buffer:add(bufferOrNumber[, factor]), adding factor times the elements of another buffer
+static int lua_bufferAdd(lua_State *L) {
+    return lua_bufferApply(L, ARCM_BUFFER_ADD, "add");
+}
+
+static int lua_bufferMul(lua_State *L) {
+    return lua_bufferApply(L, ARCM_BUFFER_MUL, "mul");
+}
+
+// binding for buffer:clamp(min, max)
+static int lua_bufferClamp(lua_State *L) {
+    ArcmBuffer* buf = (ArcmBuffer*)luaL_checkudata(L, 1, BUFFER_META);
+    const double lo = luaL_checknumber(L, 2), hi = luaL_checknumber(L, 3);
+    arcmBufferApply(buf, ARCM_BUFFER_MAX, NULL, lo);
+    arcmBufferApply(buf, ARCM_BUFFER_MIN, NULL, hi);
+    lua_settop(L, 1);
+    return 1;
+}
+
+static int lua_bufferSum(lua_State *L) {
+    const ArcmBuffer* buf = (const ArcmBuffer*)luaL_checkudata(L, 1, BUFFER_META);
+    lua_pushnumber(L, arcmBufferSum(buf));
+    return 1;
+}
+
+static const luaL_Reg buffer_funcs[] = {
+    {"new", lua_bufferNew},
+    {NULL, NULL}
+};
+
+static const luaL_Reg buffer_methods[] = {
+    {"type", lua_bufferType},
+    {"fill", lua_bufferFill},
+    {"slice", lua_bufferSlice},
+    {"add", lua_bufferAdd},
+    {"mul", lua_bufferMul},
+    {"clamp", lua_bufferClamp},
+    {"sum", lua_bufferSum},
+    {NULL, NULL}
+};
+
+static const luaL_Reg buffer_meta[] = {
+    {"__newindex", lua_bufferNewIndex},
+    {"__len", lua_bufferLen},
+    {"__tostring", lua_bufferToString},
+    {NULL, NULL}
+};
+
+/// returns the bytes of a binary string or buffer argument, as passed by scripts for packed arrays
+/** Buffers are accepted if their elements are of the given type or uint8.
+    @return pointer valid while the argument is on the stack, or NULL if the argument is neither */
+static const void* lua_tobytes(lua_State *L, int idx, ArcmBufferType type, size_t* numBytes) {
+    const ArcmBuffer* buf = (const ArcmBuffer*)luaL_testudata(L, idx, BUFFER_META);
+    if (buf && (buf->type == type || buf->type == ARCM_BUFFER_UINT8)) {
+        *numBytes = buf->count * arcmBufferElementSize((ArcmBufferType)buf->type);
+        return arcmBufferData(buf);
+    }
+    if (lua_type(L, idx) != LUA_TSTRING)
+        return NULL;
+    return lua_tolstring(L, idx, numBytes);
+}
+
 // --- Resource Functions ---
 
 static int lua_resourceGetImage(lua_State *L) {
@@ -204,36 +591,34 @@ static int lua_resourceGetImage(lua_State *L) {
 }
 
 static int lua_resourceCreateImage(lua_State *L) {
-    // read uint32_t color data from an array:
-    const size_t numItems = lua_istable(L, 1) ? lua_rawlen(L, 1) : 0;
+    // packed color data is used in place, tables are converted to it
+    size_t numBytes = 0;
+    const void* bytes = lua_tobytes(L, 1, ARCM_BUFFER_UINT32, &numBytes);
+    const size_t numItems = bytes ? numBytes / sizeof(uint32_t) : lua_istable(L, 1) ? lua_rawlen(L, 1) : 0;
     if (numItems == 0)
-        return luaL_error(L, "resource.createImage() expects non-empty table for color data as first argument");
+        return luaL_error(L, "resource.createImage() expects non-empty table, uint32 buffer, or binary string for color data as first argument");
     int width = (int)luaL_checkinteger(L, 2);
     int height = (int)luaL_checkinteger(L, 3);
     if (width <= 0 || height <= 0 || width*height > numItems)
         return luaL_error(L, "resource.createImage() expects positive integers for width and height, and their product must not exceed the number of items");
-
-    uint32_t* data = (uint32_t*)malloc(numItems * sizeof(uint32_t));
-    if (!data)
-        return luaL_error(L, "resource.createImage() failed to allocate memory for color data");
-
-    for (size_t i = 0; i < numItems; i++) {
-        lua_pushinteger(L, i + 1);
-        lua_gettable(L, 1);
-        data[i] = (uint32_t)luaL_checkinteger(L, -1);
-        lua_pop(L, 1);
-        if(data[i] > 0xFFFFFFFF) {
-            free(data);
-            return luaL_error(L, "resource.createImage() expects color data to be 32-bit unsigned integers");
-        }
-    }
-
     float centerX = (float)luaL_optnumber(L, 4, 0.0f);
     float centerY = (float)luaL_optnumber(L, 5, 0.0f);
     int filtering = (int)luaL_optinteger(L, 6, 1);
 
-    size_t handle = arcmResourceCreateImage((uint8_t*)data, width, height, centerX, centerY, filtering);
-    free(data);
+    if (!bytes) { // garbage collected, so that errors do not leak it
+        uint32_t* data = (uint32_t*)lua_newuserdata(L, numItems * sizeof(uint32_t));
+        for (size_t i = 0; i < numItems; i++) {
+            int isnum;
+            lua_rawgeti(L, 1, (lua_Integer)i + 1);
+            const lua_Integer color = lua_tointegerx(L, -1, &isnum);
+            lua_pop(L, 1);
+            if (!isnum || color < 0 || color > 0xFFFFFFFF)
+                return luaL_error(L, "resource.createImage() expects color data to be 32-bit unsigned integers");
+            data[i] = (uint32_t)color;
+        }
+        bytes = data;
+    }
+    size_t handle = arcmResourceCreateImage((const uint8_t*)bytes, width, height, centerX, centerY, filtering);
     lua_pushinteger(L, handle);
 	return 1;
 }
@@ -273,29 +658,41 @@ static int lua_resourceGetTileGrid(lua_State *L) {
 
 static int lua_resourceGetAudio(lua_State *L) {
     const char* name = luaL_checkstring(L, 1);
-	size_t handle = ResourceGetAudio(name);
+	size_t handle = arcmResourceGetAudio(name);
     lua_pushinteger(L, handle);
 	return 1;
 }
 
 static int lua_resourceCreateAudio(lua_State *L) {
-    const size_t numSamples = lua_istable(L, 1) ? lua_rawlen(L, 1) : 0;
-    if (numSamples == 0)
-        return luaL_error(L, "resource.createAudio() expects non-empty table for audio data as first argument");
-
-    float* data = (float*)malloc(numSamples * sizeof(float));
+    // packed float samples are copied at once, tables are converted
+    size_t numBytes = 0;
+    const void* bytes = lua_tobytes(L, 1, ARCM_BUFFER_FLOAT32, &numBytes);
+    const size_t numSamples = bytes ? numBytes / sizeof(float) : lua_istable(L, 1) ? lua_rawlen(L, 1) : 0;
+    if (numSamples == 0 || numBytes % sizeof(float) != 0)
+        return luaL_error(L, "resource.createAudio() expects non-empty table, float32 buffer, or binary string of floats for audio data as first argument");
+    lua_Integer numChannels = luaL_optinteger(L, 2, 1);
+    if (numChannels < 1 || numChannels > 2)
+        return luaL_error(L, "resource.createAudio() expects numChannels to be 1 or 2");
+
+    float* data = (float*)malloc(numSamples * sizeof(float)); // owned by AudioUploadPCM
+    if (!data)
+        return luaL_error(L, "resource.createAudio() failed to allocate memory for audio data");
+    if (bytes)
+        memcpy(data, bytes, numSamples * sizeof(float));
     for (size_t i = 0; i < numSamples; i++) {
-        lua_pushinteger(L, i + 1);
-        lua_gettable(L, 1);
-        data[i] = (float)luaL_checknumber(L, -1);
-        lua_pop(L, 1);
-        if(data[i] < -1.0f || data[i] > 1.0f) {
+        int isnum = 1;
+        if (!bytes) {
+            lua_rawgeti(L, 1, (lua_Integer)i + 1);
+            data[i] = (float)lua_tonumberx(L, -1, &isnum);
+            lua_pop(L, 1);
+        }
+        if (!isnum || !(data[i] >= -1.0f && data[i] <= 1.0f)) {
             free(data);
             return luaL_error(L, "resource.createAudio() expects audio sample values between -1.0 and 1.0");
         }
     }
-    uint8_t numChannels = (uint8_t)luaL_optinteger(L, 2, 1);
-    size_t handle = AudioUploadPCM(data, numSamples, numChannels, 0);
+    // arcmAudioUploadPCM counts samples per channel
+    size_t handle = arcmAudioUploadPCM(data, (uint32_t)(numSamples / numChannels), (uint8_t)numChannels, 0);
     lua_pushinteger(L, handle);
 	return 1;
 }
@@ -303,11 +700,82 @@ static int lua_resourceCreateAudio(lua_State *L) {
 static int lua_resourceGetFont(lua_State *L) {
     const char* name = luaL_checkstring(L, 1);
     uint32_t fontSize = (uint32_t)luaL_optinteger(L, 2, 16);
-    size_t handle = ResourceGetFont(name, fontSize);
+    size_t handle = arcmResourceGetFont(name, fontSize);
     lua_pushinteger(L, handle);
     return 1;
 }
 
+static int lua_resourceCreateAtlas(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    float scale = (float)luaL_optnumber(L, 2, 1.0f);
+    float centerX = (float)luaL_optnumber(L, 3, 0.0f);
+    float centerY = (float)luaL_optnumber(L, 4, 0.0f);
+    int filtering = (int)luaL_optinteger(L, 5, 1);
+    const size_t len = lua_rawlen(L, 1);
+    // names remain referenced by the table argument during the call
+    const char** names = (const char**)lua_newuserdata(L, (len ? len : 1) * (sizeof(const char*) + sizeof(uint32_t)));
+    uint32_t* handles = (uint32_t*)(names + (len ? len : 1));
+    for(size_t i=0; i<len; ++i) {
+        lua_rawgeti(L, 1, (lua_Integer)i+1);
+        if(lua_type(L, -1) != LUA_TSTRING)
+            return luaL_error(L, "resource.createAtlas expects an array of image names");
+        names[i] = lua_tostring(L, -1);
+        lua_pop(L, 1);
+    }
+    arcmResourceCreateAtlas(names, len, scale, centerX, centerY, filtering, handles);
+    lua_createtable(L, (int)len, 0);
+    for(size_t i=0; i<len; ++i) {
+        lua_pushinteger(L, handles[i]);
+        lua_rawseti(L, -2, (lua_Integer)i+1);
+    }
+    return 1;
+}
+
+static int lua_resourceLoadAsync(lua_State *L) {
+    const char* name = luaL_checkstring(L, 1);
+    float param = (float)luaL_optnumber(L, 2, 0.0f);
+    float centerX = (float)luaL_optnumber(L, 3, 0.0f);
+    float centerY = (float)luaL_optnumber(L, 4, 0.0f);
+    int filtering = (int)luaL_optinteger(L, 5, 1);
+    lua_pushinteger(L, arcmResourceLoadAsync(name, param, centerX, centerY, filtering));
+    return 1;
+}
+
+static int lua_resourceLoad(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    if(!lua_isnoneornil(L, 2)) {
+        luaL_checktype(L, 2, LUA_TFUNCTION);
+        luaL_unref(L, LUA_REGISTRYINDEX, ref_load_progress);
+        lua_pushvalue(L, 2);
+        ref_load_progress = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+    const lua_Integer len = (lua_Integer)lua_rawlen(L, 1);
+    lua_createtable(L, (int)len, 0);
+    for(lua_Integer i=1; i<=len; ++i) {
+        lua_rawgeti(L, 1, i);
+        const char* name = luaL_checkstring(L, -1);
+        const uint32_t pending = arcmResourceLoadAsync(name, 0.0f, 0.0f, 0.0f, 1);
+        lua_pop(L, 1);
+        lua_pushinteger(L, pending);
+        lua_rawseti(L, -2, i);
+    }
+    return 1;
+}
+
+static int lua_resourceLoaded(lua_State *L) {
+    uint32_t pending = (uint32_t)luaL_checkinteger(L, 1), handle;
+    if(arcmResourceLoaded(pending, &handle))
+        lua_pushinteger(L, handle);
+    else
+        lua_pushnil(L);
+    return 1;
+}
+
+static int lua_resourceLoadProgress(lua_State *L) {
+    lua_pushnumber(L, arcmResourceLoadProgress());
+    return 1;
+}
+
 static int lua_resourceQueryImage(lua_State *L) {
     uint32_t image = (uint32_t)luaL_checkinteger(L, 1);
     const char* property = luaL_checkstring(L, 2);
@@ -341,17 +809,30 @@ static int lua_resourceQueryFont(lua_State *L) {
 
 static int lua_resourceSetStorageItem(lua_State *L) {
     const char* key = luaL_checkstring(L, 1);
-    const char* val = lua_tostring(L, 2);
-    arcmResourceSetStorageItem(key, val);
+    size_t size = 0;
+    const ArcmBuffer* buf = (const ArcmBuffer*)luaL_testudata(L, 2, BUFFER_META);
+    if (buf) { // stored as binary data of its elements
+        size = buf->count * arcmBufferElementSize((ArcmBufferType)buf->type);
+        arcmResourceSetStorageValue(key, arcmBufferData(buf), size, true);
+        return 0;
+    }
+    const char* val = lua_tolstring(L, 2, &size);
+    arcmResourceSetStorageValue(key, val, size, false);
 	return 0;
 }
 
+static int lua_resourceFlushStorage(lua_State *L) {
+    lua_pushboolean(L, arcmResourceFlushStorage());
+    return 1;
+}
+
 
 static int lua_resourceGetStorageItem(lua_State *L) {
 	const char* key = luaL_checkstring(L, 1);
-	const char* val = arcmResourceGetStorageItem(key);
+	size_t size;
+	const char* val = arcmResourceGetStorageValue(key, &size, NULL);
     if(val) {
-        lua_pushstring(L, val);
+        lua_pushlstring(L, val, size);
     } else {
         lua_pushnil(L);
     }
@@ -367,11 +848,17 @@ static const luaL_Reg resource_funcs[] = {
     {"getAudio", lua_resourceGetAudio},
     {"createAudio", lua_resourceCreateAudio},
     {"getFont", lua_resourceGetFont},
+    {"createAtlas", lua_resourceCreateAtlas},
+    {"loadAsync", lua_resourceLoadAsync},
+    {"load", lua_resourceLoad},
+    {"loaded", lua_resourceLoaded},
+    {"loadProgress", lua_resourceLoadProgress},
     {"queryImage", lua_resourceQueryImage},
     {"queryAudio", lua_resourceQueryAudio},
     {"queryFont", lua_resourceQueryFont},
     {"setStorageItem", lua_resourceSetStorageItem},
     {"getStorageItem", lua_resourceGetStorageItem},
+    {"flushStorage", lua_resourceFlushStorage},
     {NULL, NULL}
 };
 
@@ -382,11 +869,37 @@ static int lua_AudioReplay(lua_State *L) {
     float volume = (float)luaL_optnumber(L, 2, 1.0f);
     float balance = (float)luaL_optnumber(L, 3, 0.0f);
     float detune = (float)luaL_optnumber(L, 4, 0.0f);
-    uint32_t track = AudioReplay(sample, volume, balance, detune);
+    int priority = (int)luaL_optinteger(L, 5, 0);
+    uint32_t track = arcmAudioReplay(sample, volume, balance, detune, priority);
     lua_pushinteger(L, track);
     return 1;
 }
 
+static int lua_AudioReplayAt(lua_State *L) {
+    uint32_t sample = (uint32_t)luaL_checkinteger(L, 1);
+    double when = luaL_checknumber(L, 2);
+    float volume = (float)luaL_optnumber(L, 3, 1.0f);
+    float balance = (float)luaL_optnumber(L, 4, 0.0f);
+    float detune = (float)luaL_optnumber(L, 5, 0.0f);
+    lua_pushboolean(L, arcmAudioReplayAt(sample, when, volume, balance, detune));
+    return 1;
+}
+
+static int lua_AudioTime(lua_State *L) {
+    lua_pushnumber(L, arcmAudioTime());
+    return 1;
+}
+
+static int lua_AudioBufferSize(lua_State *L) {
+    lua_pushinteger(L, arcmAudioBufferSize());
+    return 1;
+}
+
+static int lua_AudioLatency(lua_State *L) {
+    lua_pushnumber(L, arcmAudioLatency());
+    return 1;
+}
+
 static int lua_AudioVolume(lua_State *L) {
     uint32_t track = (uint32_t)luaL_checkinteger(L, 1);
     float volume = (float)luaL_checknumber(L, 2);
@@ -395,9 +908,49 @@ static int lua_AudioVolume(lua_State *L) {
     return 0;
 }
 
+static int lua_AudioStream(lua_State *L) {
+    const char* name = luaL_checkstring(L, 1);
+    float volume = (float)luaL_optnumber(L, 2, 1.0f);
+    bool loop = lua_toboolean(L, 3);
+    uint32_t track = arcmAudioStream(name, volume, loop);
+    lua_pushinteger(L, track);
+    return 1;
+}
+
+static int lua_AudioSynth(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    ArcmSynthParams params;
+    arcmSynthDefaults(&params);
+    if (lua_getfield(L, 1, "wave") != LUA_TNIL) {
+        const char* wave = lua_tostring(L, -1);
+        if (!wave || !arcmSynthWave(&params, wave))
+            return luaL_error(L, "audio.synth: unknown wave '%s'", wave ? wave : luaL_typename(L, -1));
+    }
+    lua_pop(L, 1);
+    for (unsigned i = 0; arcmSynthParamName(i); ++i) {
+        const char* name = arcmSynthParamName(i);
+        if (lua_getfield(L, 1, name) != LUA_TNIL) {
+            int isnum;
+            lua_Number value = lua_tonumberx(L, -1, &isnum);
+            if (!isnum)
+                return luaL_error(L, "audio.synth: parameter '%s' expects a number", name);
+            arcmSynthParam(&params, name, (float)value);
+        }
+        lua_pop(L, 1);
+    }
+    lua_pushinteger(L, arcmAudioSynth(&params));
+    return 1;
+}
+
 static const luaL_Reg audio_funcs[] = {
     {"replay", lua_AudioReplay},
+    {"replayAt", lua_AudioReplayAt},
+    {"time", lua_AudioTime},
+    {"bufferSize", lua_AudioBufferSize},
+    {"latency", lua_AudioLatency},
     {"volume", lua_AudioVolume},
+    {"stream", lua_AudioStream},
+    {"synth", lua_AudioSynth},
     {NULL, NULL}
 };
 
@@ -409,13 +962,30 @@ void luaopen_arcalua(lua_State *L) {
 
     luaL_newlib(L, gfx_funcs);
     // do not expose to global but keep them in registry:
-    lua_setfield(L, LUA_REGISTRYINDEX, "arcalua_gfx");
+    ref_gfx = luaL_ref(L, LUA_REGISTRYINDEX);
+
+    lua_pushstring(L, "axis");
+    ref_axis = luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_pushstring(L, "button");
+    ref_button = luaL_ref(L, LUA_REGISTRYINDEX);
+    for(int i=0; i<LIFECYCLE_NUM; ++i)
+        lifecycle_refs[i] = LUA_NOREF;
+    ref_load_progress = LUA_NOREF;
 
     luaL_newlib(L, audio_funcs);
     lua_setglobal(L, "audio");
 
     luaL_newlib(L, resource_funcs);
     lua_setglobal(L, "resource");
+
+    luaL_newmetatable(L, BUFFER_META);
+    luaL_setfuncs(L, buffer_meta, 0);
+    luaL_newlib(L, buffer_methods);
+    lua_pushcclosure(L, lua_bufferIndex, 1);
+    lua_setfield(L, -2, "__index");
+    lua_pop(L, 1);
+    luaL_newlib(L, buffer_funcs);
+    lua_setglobal(L, "buffer");
 }
 
 // --- Initialization ---
@@ -436,14 +1006,23 @@ void* initVM(const char* script, const char* scriptName) {
     lua_pushfstring(L, ";%s/?.lua;%s/?/init.lua", archiveName, archiveName);
     lua_concat(L, 2);
     lua_setfield(L, -2, "path");
-    lua_pop(L, 1);
+    // look up modules in the resource archive first, see lua_searchArchive
+    lua_getfield(L, -1, "searchers");
+    for(lua_Integer i = luaL_len(L, -1); i >= 2; --i) {
+        lua_rawgeti(L, -1, i);
+        lua_rawseti(L, -2, i + 1);
+    }
+    lua_pushcfunction(L, lua_searchArchive);
+    lua_rawseti(L, -2, 2);
+    lua_pop(L, 2);
 
     // execute the passed Lua string
-    if (luaL_loadbuffer(L, script, strlen(script), scriptName) != LUA_OK || lua_pcall(L, 0, 0, 0) != LUA_OK) {
+    if (loadScene(L, script, scriptName) != LUA_OK || lua_pcall(L, 0, 0, 0) != LUA_OK) {
         fprintf(stderr, "Error executing script \"%s\": %s\n", scriptName, lua_tostring(L, -1));
         lua_close(L);
         return NULL;
     }
+    resolveLifecycleCallbacks(L);
     return (void*)L;
 }
 
@@ -451,6 +1030,28 @@ void shutdownVM(void* vm) {
     lua_State* L = (lua_State*)vm;
     if (L)
         lua_close(L);
+    arcmSceneCacheClear();
+}
+
+bool compileScript(const char* scriptName, const char* fileName) {
+    char* script = arcmResourceGetText(scriptName);
+    if (!script) {
+        fprintf(stderr, "could not read script %s\n", scriptName);
+        return false;
+    }
+    lua_State* L = luaL_newstate();
+    bool ok = luaL_loadbuffer(L, script, strlen(script), scriptName) == LUA_OK;
+    free(script);
+    if (!ok)
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+    else {
+        BytecodeBuffer buf = { NULL, 0, 0 };
+        ok = lua_dump(L, writeBytecode, &buf, 1) == 0
+            && arcmBytecodeShip(fileName, LUA_BYTECODE_FORMAT, buf.data, buf.size);
+        free(buf.data);
+    }
+    lua_close(L);
+    return ok;
 }
 
 // --- event dispatchers ---
@@ -458,7 +1059,7 @@ void shutdownVM(void* vm) {
 bool dispatchLifecycleEvent(const char* evtName, void* udata) {
     lua_State* L = (lua_State*)udata;
 
-    if(lua_getglobal(L, evtName) == LUA_TFUNCTION && lua_pcall(L, 0, 0, 0) != LUA_OK) {
+    if(pushLifecycleFunction(L, evtName) && lua_pcall(L, 0, 0, 0) != LUA_OK) {
         handleException(L);
         return false;
     }
@@ -468,7 +1069,7 @@ bool dispatchLifecycleEvent(const char* evtName, void* udata) {
 bool dispatchLifecycleEventArgv(const char* evtName, int argc, char** argv, void* udata) {
     lua_State* L = (lua_State*)udata;
 
-    if(lua_getglobal(L, evtName) != LUA_TFUNCTION)
+    if(!pushLifecycleFunction(L, evtName))
         return true;
 
     lua_newtable(L);
@@ -483,40 +1084,71 @@ bool dispatchLifecycleEventArgv(const char* evtName, int argc, char** argv, void
     return true;
 }
 
-void dispatchAxisEvent(size_t id, uint8_t axis, float value, void* udata) {
+void dispatchAxisEvent(size_t id, uint8_t axis, float value, double timestamp, void* udata) {
     lua_State* L = (lua_State*)udata;
-    if(lua_getglobal(L, "input") != LUA_TFUNCTION)
+    if(lifecycle_refs[LIFECYCLE_INPUT] == LUA_NOREF)
         return;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, lifecycle_refs[LIFECYCLE_INPUT]);
     // push event:
-    lua_pushstring(L,"axis");
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ref_axis);
     lua_pushinteger(L, id);
     lua_pushinteger(L, axis);
     lua_pushnumber(L, value);
-    lua_pushnil(L); // no second value
+    lua_pushnumber(L, timestamp);
     if(lua_pcall(L, 5, 0, 0) != LUA_OK)
         handleException(L);
 }
 
-void dispatchButtonEvent(size_t id, uint8_t button, float value, void* udata) {
-    arcmWindowCloseOnButton67(id, button, value);
-
+void dispatchButtonEvent(size_t id, uint8_t button, float value, double timestamp, void* udata) {
     lua_State* L = (lua_State*)udata;
-    if(lua_getglobal(L, "input") != LUA_TFUNCTION)
+    if(lifecycle_refs[LIFECYCLE_INPUT] == LUA_NOREF)
         return;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, lifecycle_refs[LIFECYCLE_INPUT]);
     // push event:
-    lua_pushstring(L,"button");
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ref_button);
     lua_pushinteger(L, id);
     lua_pushinteger(L, button);
     lua_pushnumber(L, value);
-    lua_pushnil(L); // no second value
+    lua_pushnumber(L, timestamp);
     if(lua_pcall(L, 5, 0, 0) != LUA_OK)
         handleException(L);
 }
 
+bool dispatchInputBatch(const double* events, size_t numEvents, void* udata) {
+    lua_State* L = (lua_State*)udata;
+    if(lifecycle_refs[LIFECYCLE_INPUT_BATCH] == LUA_NOREF)
+        return false;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, lifecycle_refs[LIFECYCLE_INPUT_BATCH]);
+    const size_t numValues = numEvents * ARCM_INPUT_EVENT_STRIDE;
+    lua_createtable(L, (int)numValues, 0);
+    for(size_t i=0; i<numValues; ++i) {
+        lua_pushnumber(L, events[i]);
+        lua_rawseti(L, -2, i + 1);
+    }
+    if(lua_pcall(L, 1, 0, 0) != LUA_OK)
+        handleException(L);
+    return true;
+}
+
+static void dispatchLoadProgress(lua_State* L) {
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ref_load_progress);
+    const float progress = arcmResourceLoadProgress();
+    if(progress >= 1.0f) { // report completion once, then release the handler
+        luaL_unref(L, LUA_REGISTRYINDEX, ref_load_progress);
+        ref_load_progress = LUA_NOREF;
+    }
+    lua_pushnumber(L, progress);
+    if(lua_pcall(L, 1, 0, 0) != LUA_OK)
+        handleException(L);
+}
+
 bool dispatchUpdateEvent(double deltaT, void* udata) {
     lua_State* L = (lua_State*)udata;
-    if(lua_getglobal(L, "update") != LUA_TFUNCTION)
+    if(ref_load_progress != LUA_NOREF)
+        dispatchLoadProgress(L);
+    if(lifecycle_refs[LIFECYCLE_UPDATE] == LUA_NOREF)
         return false;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, lifecycle_refs[LIFECYCLE_UPDATE]);
     lua_pushnumber(L, deltaT);
     if(lua_pcall(L, 1, 1, 0) != LUA_OK) {
         handleException(L);
@@ -529,9 +1161,10 @@ bool dispatchUpdateEvent(double deltaT, void* udata) {
 
 void dispatchDrawEvent(void* udata) {
     lua_State* L = (lua_State*)udata;
-    if(lua_getglobal(L, "draw") != LUA_TFUNCTION)
+    if(lifecycle_refs[LIFECYCLE_DRAW] == LUA_NOREF)
         return;
-    lua_getfield(L, LUA_REGISTRYINDEX, "arcalua_gfx");
+    lua_rawgeti(L, LUA_REGISTRYINDEX, lifecycle_refs[LIFECYCLE_DRAW]);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ref_gfx);
     if(lua_pcall(L, 1, 0, 0) != LUA_OK)
         handleException(L);
 }
@@ -17,6 +17,77 @@ static bool handleException() {
 	return false;
 }
 
+// identifies bytecode of this pocketpy version in the bytecode cache
+#define PY_BYTECODE_FORMAT "pocketpy" PK_VERSION
+const char* const scriptBytecodeFormat = PY_BYTECODE_FORMAT;
+
+// serializes a code object as py_compilefile does, not part of the public API
+extern void* CodeObject__dumps(const void* co, int* size);
+
+/// returns bytecode of a script from the bytecode cache, or compiles its source and caches the result.
+/// A NULL script looks up bytecode shipped in its place.
+/** @return bytecode to be freed by caller, or NULL if missing or not compilable, the latter raising */
+static void* loadBytecode(const char* script, const char* name, int* size) {
+	size_t numBytes;
+	void* bytecode = arcmBytecodeLoad(name, script, PY_BYTECODE_FORMAT, &numBytes);
+	if(bytecode) {
+		*size = (int)numBytes;
+		return bytecode;
+	}
+	if(!script || !py_compile(script, name, EXEC_MODE, false))
+		return NULL;
+	py_assign(py_pushtmp(), py_retval());
+	bytecode = CodeObject__dumps(py_touserdata(py_peek(-1)), size);
+	py_pop();
+	arcmBytecodeStore(name, script, PY_BYTECODE_FORMAT, bytecode, *size);
+	return bytecode;
+}
+
+/// executes a scene in the main module, preferably from the scene cache. Executing
+/// it again redefines the scene's globals, as if it were loaded anew.
+static bool execScene(const char* script, const char* name) {
+	size_t cachedSize;
+	const void* cached = arcmSceneCacheLoad(name, &cachedSize);
+	if(cached)
+		return py_execo(cached, (int)cachedSize, name, NULL);
+	int size;
+	void* bytecode = loadBytecode(script, name, &size);
+	if(!bytecode)
+		return script ? false : ImportError("%s: file not found", name);
+	arcmSceneCacheStore(name, bytecode, size);
+	bool ok = py_execo(bytecode, size, name, NULL);
+	free(bytecode);
+	return ok;
+}
+
+// The global lifecycle functions, resolved once per loaded scene instead of
+// looked up by name on every dispatch, followed by the event type arguments
+// of input() and the onProgress handler of resource.load(). Points into a
+// tuple kept alive by the arcamini module.
+enum { LIFECYCLE_STR_AXIS = LIFECYCLE_NUM, LIFECYCLE_STR_BUTTON, LIFECYCLE_LOAD_PROGRESS, LIFECYCLE_SLOTS };
+static py_Ref lifecycle_fns = NULL;
+
+static void resolveLifecycleCallbacks() {
+	for(int i=0; i<LIFECYCLE_NUM; ++i) {
+		py_Ref fn = py_getglobal(py_name(lifecycleName((LifecycleCallback)i)));
+		if(fn && (py_typeof(fn) == tp_function || py_typeof(fn) == tp_nativefunc))
+			lifecycle_fns[i] = *fn;
+		else
+			py_newnil(&lifecycle_fns[i]);
+	}
+}
+
+/// @return handler of evtName or NULL if not defined by the current scene
+static py_Ref lifecycleFunction(const char* evtName) {
+	LifecycleCallback cb = lifecycleCallback(evtName);
+	if(cb < LIFECYCLE_NUM)
+		return py_isnil(&lifecycle_fns[cb]) ? NULL : &lifecycle_fns[cb];
+	py_Ref fn = py_getglobal(py_name(evtName));
+	if(!fn || (py_typeof(fn) != tp_function && py_typeof(fn) != tp_nativefunc))
+		return NULL;
+	return fn;
+}
+
 // --- window bindings ---
 static bool py_WindowWidth(int argc, py_StackRef argv) {
 	py_newint(py_retval(), WindowWidth());
@@ -36,19 +107,83 @@ static bool py_WindowClearColor(int argc, py_StackRef argv) {
 	return true;
 }
 
+static bool py_WindowAxisFilter(int argc, py_StackRef argv) {
+	double resolution = 0.1, deadzone = 0.0;
+	if(argc > 0 && !py_castfloat(py_arg(0), &resolution))
+		return false;
+	if(argc > 1 && !py_castfloat(py_arg(1), &deadzone))
+		return false;
+	arcmWindowAxisFilter((float)resolution, (float)deadzone);
+	py_newnone(py_retval());
+	return true;
+}
+static bool py_WindowInputState(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(1);
+	int64_t device;
+	if(!py_castint(py_arg(0), &device))
+		return false;
+	uint32_t buttons;
+	float axes[16];
+	const int numAxes = arcmWindowInputState((size_t)device, &buttons, axes, 16);
+	py_newlistn(py_retval(), numAxes + 1);
+	py_Ref items = py_list_data(py_retval());
+	py_newint(&items[0], buttons);
+	for(int i=0; i<numAxes; ++i)
+		py_newfloat(&items[i+1], axes[i]);
+	return true;
+}
+static bool py_WindowPressed(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(2);
+	int64_t device, button;
+	if(!py_castint(py_arg(0), &device) || !py_castint(py_arg(1), &button))
+		return false;
+	py_newbool(py_retval(), button >= 0 && button < 256 && arcmWindowPressed((size_t)device, (uint8_t)button));
+	return true;
+}
+static bool py_WindowReleased(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(2);
+	int64_t device, button;
+	if(!py_castint(py_arg(0), &device) || !py_castint(py_arg(1), &button))
+		return false;
+	py_newbool(py_retval(), button >= 0 && button < 256 && arcmWindowReleased((size_t)device, (uint8_t)button));
+	return true;
+}
+static bool py_WindowStats(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(1);
+	PY_CHECK_ARG_TYPE(0, tp_str);
+	double value = arcmWindowStats(py_tostr(py_arg(0)));
+	if(isnan(value))
+		py_newnone(py_retval());
+	else
+		py_newfloat(py_retval(), value);
+	return true;
+}
+
 // experimental switchScene() implementation for supporting multiple scenes
 static bool py_switchScene(int argc, py_StackRef argv) {
+	PY_CHECK_ARG_TYPE(0, tp_str);
 	const char* fname = py_tostr(py_arg(0));
-	const char** args = argc>1 ? (const char**)malloc((argc-1) * sizeof(char*)) : NULL;
+	// scenes visited or preloaded before are compiled already
+	size_t size;
+	bool cached = arcmSceneCacheLoad(fname, &size) != NULL;
+	char* copy = NULL;
+	const char* script = cached ? NULL : arcmResourceText(fname, &copy);
+	if(!cached && !script && !arcmBytecodeShipped(fname, PY_BYTECODE_FORMAT))
+		return ImportError("window.switchScene(%s): file not found", fname);
+
+	// copied, as py_str() overwrites py_retval() and its result may be collected
+	char** args = argc>1 ? (char**)malloc((argc-1) * sizeof(char*)) : NULL;
 	for(int i=1; i<argc; ++i) {
-		py_str(py_arg(i));
-		args[i-1] = py_tostr(py_retval());
+		if(!py_str(py_arg(i))) {
+			while(--i > 0)
+				free(args[i-1]);
+			free(args);
+			free(copy);
+			return false;
+		}
+		args[i-1] = strdup(py_tostr(py_retval()));
 	}
 
-	char* script = ResourceGetText(fname);
-	if(!script)
-		return ImportError("window.switchScene(%s): file not found", fname);
-
 	// call leave event on current script
 	dispatchLifecycleEvent("leave", NULL);
 	// clear current callbacks
@@ -58,15 +193,39 @@ static bool py_switchScene(int argc, py_StackRef argv) {
 	py_setglobal(py_name("draw"), py_NIL());
 	py_setglobal(py_name("leave"), py_NIL());
 
-	bool ok = py_exec(script, fname, EXEC_MODE, NULL);
-	free(script);
-	if(!ok || py_checkexc(false)) {
-		free(args);
-		return handleException();
-	}
-	dispatchLifecycleEventArgv("enter", argc-1, (char**)args, NULL);
+	bool ok = execScene(script, fname) && !py_checkexc(false);
+	free(copy);
+	resolveLifecycleCallbacks();
+	if(ok)
+		dispatchLifecycleEventArgv("enter", argc-1, args, NULL);
+	for(int i=1; i<argc; ++i)
+		free(args[i-1]);
 	free(args);
+	if(!ok)
+		return handleException();
+
+	py_newnone(py_retval());
+	return true;
+}
 
+static bool py_preloadScene(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(1);
+	PY_CHECK_ARG_TYPE(0, tp_str);
+	const char* fname = py_tostr(py_arg(0));
+	size_t size;
+	if(!arcmSceneCacheLoad(fname, &size)) {
+		char* copy;
+		const char* script = arcmResourceText(fname, &copy);
+		if(!script && !arcmBytecodeShipped(fname, PY_BYTECODE_FORMAT))
+			return ImportError("window.preloadScene(%s): file not found", fname);
+		int bytecodeSize;
+		void* bytecode = loadBytecode(script, fname, &bytecodeSize);
+		free(copy);
+		if(!bytecode)
+			return false;
+		arcmSceneCacheStore(fname, bytecode, bytecodeSize); // only the bytecode is kept, switchScene executes it
+		free(bytecode);
+	}
 	py_newnone(py_retval());
 	return true;
 }
@@ -212,7 +371,7 @@ static bool py_gfxFillTextAlign(int argc, py_StackRef argv) {
 
 // --- audio bindings ---
 static bool py_AudioReplay(int argc, py_StackRef argv) {
-	int64_t sample;
+	int64_t sample, priority = 0;
 	float vol=1.0f, bal=0.0f, det=0.0f;
 	if(!py_castint(py_arg(0), &sample))
 		return false;
@@ -222,8 +381,10 @@ static bool py_AudioReplay(int argc, py_StackRef argv) {
 		return false;
 	if(argc > 3 && !py_castfloat32(py_arg(3), &det))
 		return false;
+	if(argc > 4 && !py_castint(py_arg(4), &priority))
+		return false;
 
-	uint32_t track = AudioReplay((uint32_t)sample, vol, bal, det);
+	uint32_t track = arcmAudioReplay((uint32_t)sample, vol, bal, det, (int)priority);
 	if(track == UINT32_MAX)
 		py_newnone(py_retval());
 	else
@@ -231,6 +392,41 @@ static bool py_AudioReplay(int argc, py_StackRef argv) {
 	return true;
 }
 
+static bool py_AudioReplayAt(int argc, py_StackRef argv) {
+	int64_t sample;
+	float vol=1.0f, bal=0.0f, det=0.0f;
+	double when;
+	if(!py_castint(py_arg(0), &sample) || !py_castfloat(py_arg(1), &when))
+		return false;
+	if(argc > 2 && !py_castfloat32(py_arg(2), &vol))
+		return false;
+	if(argc > 3 && !py_castfloat32(py_arg(3), &bal))
+		return false;
+	if(argc > 4 && !py_castfloat32(py_arg(4), &det))
+		return false;
+
+	py_newbool(py_retval(), arcmAudioReplayAt((uint32_t)sample, when, vol, bal, det));
+	return true;
+}
+
+static bool py_AudioTime(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(0);
+	py_newfloat(py_retval(), arcmAudioTime());
+	return true;
+}
+
+static bool py_AudioBufferSize(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(0);
+	py_newint(py_retval(), arcmAudioBufferSize());
+	return true;
+}
+
+static bool py_AudioLatency(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(0);
+	py_newfloat(py_retval(), arcmAudioLatency());
+	return true;
+}
+
 static bool py_AudioVolume(int argc, py_StackRef argv) {
 	int64_t track;
 	float volume, fadeTime = 0.0f;
@@ -245,6 +441,256 @@ static bool py_AudioVolume(int argc, py_StackRef argv) {
 	return true;
 }
 
+static bool py_AudioStream(int argc, py_StackRef argv) {
+	float volume = 1.0f;
+	bool loop = false;
+	PY_CHECK_ARG_TYPE(0, tp_str);
+	if(argc > 1 && !py_castfloat32(py_arg(1), &volume))
+		return false;
+	if(argc > 2) {
+		int truth = py_bool(py_arg(2));
+		if(truth < 0)
+			return false;
+		loop = truth;
+	}
+
+	uint32_t track = arcmAudioStream(py_tostr(py_arg(0)), volume, loop);
+	if(track == UINT32_MAX)
+		py_newnone(py_retval());
+	else
+		py_newint(py_retval(), track);
+	return true;
+}
+
+static bool py_AudioSynth(int argc, py_StackRef argv) {
+	PY_CHECK_ARG_TYPE(0, tp_dict);
+	ArcmSynthParams params;
+	arcmSynthDefaults(&params);
+	int found = py_dict_getitem_by_str(py_arg(0), "wave");
+	if(found < 0)
+		return false;
+	if(found && (!py_isstr(py_retval()) || !arcmSynthWave(&params, py_tostr(py_retval()))))
+		return ValueError("audio.synth: unknown wave");
+	for(unsigned i=0; arcmSynthParamName(i); ++i) {
+		const char* name = arcmSynthParamName(i);
+		float value;
+		found = py_dict_getitem_by_str(py_arg(0), name);
+		if(found < 0 || (found && !py_castfloat32(py_retval(), &value)))
+			return false;
+		if(found)
+			arcmSynthParam(&params, name, value);
+	}
+	py_newint(py_retval(), arcmAudioSynth(&params));
+	return true;
+}
+
+// --- buffer bindings ---
+static py_Type tp_buffer;
+
+static ArcmBuffer* py_newbuffer(py_OutRef out, ArcmBufferType type, int64_t count) {
+	const size_t size = count >= 0 ? arcmBufferSize(type, (size_t)count) : 0;
+	if(!size)
+		return NULL;
+	ArcmBuffer* buf = (ArcmBuffer*)py_newobject(out, tp_buffer, 0, (int)size);
+	arcmBufferInit(buf, type, (size_t)count);
+	return buf;
+}
+
+/// normalizes a Python index to [0, count], counting negative indices from the end
+static size_t py_bufferindex(int64_t index, size_t count) {
+	if(index < 0)
+		index += (int64_t)count;
+	return index < 0 ? 0 : (size_t)index > count ? count : (size_t)index;
+}
+
+/// converts optional start and stop arguments, both may be None, to a first index and count
+static bool py_bufferrange(const ArcmBuffer* buf, py_Ref start, py_Ref stop, size_t* first, size_t* count) {
+	int64_t i = 0, j = buf->count;
+	if((start && !py_isnone(start) && !py_castint(start, &i)) || (stop && !py_isnone(stop) && !py_castint(stop, &j)))
+		return false;
+	*first = py_bufferindex(i, buf->count);
+	const size_t last = py_bufferindex(j, buf->count);
+	*count = last > *first ? last - *first : 0;
+	return true;
+}
+
+// binding for buffer(type, sizeOrValues) creating a buffer of zeroes or of the values of a list
+static bool py_buffer__new__(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(3);
+	PY_CHECK_ARG_TYPE(1, tp_str);
+	const int type = arcmBufferTypeId(py_tostr(py_arg(1)));
+	if(type < 0)
+		return ValueError("buffer() expects buffer type float32, uint32, or uint8");
+	int64_t count;
+	const bool isList = py_islist(py_arg(2));
+	if(isList)
+		count = py_list_len(py_arg(2));
+	else if(!py_castint(py_arg(2), &count))
+		return false;
+	ArcmBuffer* buf = py_newbuffer(py_retval(), (ArcmBufferType)type, count);
+	if(!buf)
+		return ValueError("buffer() size %i out of range", count);
+	if(isList) {
+		py_ItemRef items = py_list_data(py_arg(2));
+		for(int64_t i=0; i<count; ++i) {
+			py_f64 value;
+			if(!py_castfloat(&items[i], &value))
+				return false;
+			arcmBufferSet(buf, (size_t)i, value);
+		}
+	}
+	return true;
+}
+
+static bool py_buffer__len__(int argc, py_StackRef argv) {
+	const ArcmBuffer* buf = (const ArcmBuffer*)py_touserdata(py_arg(0));
+	py_newint(py_retval(), buf->count);
+	return true;
+}
+
+static bool py_buffer__repr__(int argc, py_StackRef argv) {
+	const ArcmBuffer* buf = (const ArcmBuffer*)py_touserdata(py_arg(0));
+	py_newfstr(py_retval(), "buffer('%s', %d)", arcmBufferTypeName((ArcmBufferType)buf->type), (int)buf->count);
+	return true;
+}
+
+/// returns a copy of the range of elements between start and stop, both may be NULL or None
+static bool py_bufferslice(py_Ref self, py_Ref start, py_Ref stop) {
+	const ArcmBuffer* buf = (const ArcmBuffer*)py_touserdata(self);
+	size_t first, count;
+	if(!py_bufferrange(buf, start, stop, &first, &count))
+		return false;
+	ArcmBuffer* slice = py_newbuffer(py_retval(), (ArcmBufferType)buf->type, (int64_t)count);
+	arcmBufferSlice(slice, buf, first);
+	return true;
+}
+
+// binding for buffer[index] and buffer[start:stop], the latter returning a copy
+static bool py_buffer__getitem__(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(2);
+	const ArcmBuffer* buf = (const ArcmBuffer*)py_touserdata(py_arg(0));
+	if(py_istype(py_arg(1), tp_slice)) {
+		py_Ref step = py_getslot(py_arg(1), 2);
+		int64_t stepValue = 1;
+		if(!py_isnone(step) && (!py_castint(step, &stepValue) || stepValue != 1))
+			return stepValue != 1 ? ValueError("buffer slices do not support steps") : false;
+		return py_bufferslice(py_arg(0), py_getslot(py_arg(1), 0), py_getslot(py_arg(1), 1));
+	}
+	int64_t index;
+	if(!py_castint(py_arg(1), &index))
+		return false;
+	if(index < 0)
+		index += buf->count;
+	if(index < 0 || index >= buf->count)
+		return IndexError("buffer index %i out of range", index);
+	const double value = arcmBufferGet(buf, (size_t)index);
+	if(buf->type == ARCM_BUFFER_FLOAT32)
+		py_newfloat(py_retval(), value);
+	else
+		py_newint(py_retval(), (int64_t)value);
+	return true;
+}
+
+static bool py_buffer__setitem__(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(3);
+	ArcmBuffer* buf = (ArcmBuffer*)py_touserdata(py_arg(0));
+	int64_t index;
+	py_f64 value;
+	if(!py_castint(py_arg(1), &index) || !py_castfloat(py_arg(2), &value))
+		return false;
+	if(index < 0)
+		index += buf->count;
+	if(index < 0 || index >= buf->count)
+		return IndexError("buffer index %i out of range", index);
+	arcmBufferSet(buf, (size_t)index, value);
+	py_newnone(py_retval());
+	return true;
+}
+
+static bool py_buffer_type(int argc, py_StackRef argv) {
+	const ArcmBuffer* buf = (const ArcmBuffer*)py_touserdata(py_arg(0));
+	py_newstr(py_retval(), arcmBufferTypeName((ArcmBufferType)buf->type));
+	return true;
+}
+
+// binding for buffer.fill(value, start=0, stop=None)
+static bool py_buffer_fill(int argc, py_StackRef argv) {
+	if(argc < 2 || argc > 4)
+		return TypeError("fill() expects 1 to 3 arguments, got %d", argc - 1);
+	ArcmBuffer* buf = (ArcmBuffer*)py_touserdata(py_arg(0));
+	py_f64 value;
+	size_t first, count;
+	if(!py_castfloat(py_arg(1), &value)
+		|| !py_bufferrange(buf, argc > 2 ? py_arg(2) : NULL, argc > 3 ? py_arg(3) : NULL, &first, &count))
+		return false;
+	arcmBufferFill(buf, value, first, count);
+	py_assign(py_retval(), py_arg(0));
+	return true;
+}
+
+// binding for buffer.slice(start=0, stop=None) returning a copy of a range of elements
+static bool py_buffer_slice(int argc, py_StackRef argv) {
+	if(argc > 3)
+		return TypeError("slice() expects up to 2 arguments, got %d", argc - 1);
+	return py_bufferslice(py_arg(0), argc > 1 ? py_arg(1) : NULL, argc > 2 ? py_arg(2) : NULL);
+}
+
+static bool py_bufferApply(int argc, py_StackRef argv, ArcmBufferOp op, const char* name) {
+	ArcmBuffer* buf = (ArcmBuffer*)py_touserdata(py_arg(0));
+	const ArcmBuffer* src = argc > 1 && py_istype(py_arg(1), tp_buffer) ? (const ArcmBuffer*)py_touserdata(py_arg(1)) : NULL;
+	py_f64 scalar = 1.0;
+	if(src ? argc > 2 && !py_castfloat(py_arg(2), &scalar) : argc < 2 || !py_castfloat(py_arg(1), &scalar))
+		return argc < 2 ? TypeError("%s() expects a buffer or number", name) : false;
+	if(!arcmBufferApply(buf, op, src, scalar))
+		return ValueError("%s() expects a buffer of equal length", name);
+	py_assign(py_retval(), py_arg(0));
+	return true;
+}
+
+// binding for buffer.add(bufferOrNumber, factor=1.0), adding factor times the elements of another buffer
+static bool py_buffer_add(int argc, py_StackRef argv) {
+	return py_bufferApply(argc, argv, ARCM_BUFFER_ADD, "add");
+}
+
+static bool py_buffer_mul(int argc, py_StackRef argv) {
+	return py_bufferApply(argc, argv, ARCM_BUFFER_MUL, "mul");
+}
+
+// binding for buffer.clamp(min, max)
+static bool py_buffer_clamp(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(3);
+	ArcmBuffer* buf = (ArcmBuffer*)py_touserdata(py_arg(0));
+	py_f64 lo, hi;
+	if(!py_castfloat(py_arg(1), &lo) || !py_castfloat(py_arg(2), &hi))
+		return false;
+	arcmBufferApply(buf, ARCM_BUFFER_MAX, NULL, lo);
+	arcmBufferApply(buf, ARCM_BUFFER_MIN, NULL, hi);
+	py_assign(py_retval(), py_arg(0));
+	return true;
+}
+
+static bool py_buffer_sum(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(1);
+	py_newfloat(py_retval(), arcmBufferSum((const ArcmBuffer*)py_touserdata(py_arg(0))));
+	return true;
+}
+
+static void bindBuffer(py_GlobalRef module) {
+	tp_buffer = py_newtype("buffer", tp_object, module, NULL);
+	py_bindmagic(tp_buffer, py_name("__new__"), py_buffer__new__);
+	py_bindmagic(tp_buffer, py_name("__len__"), py_buffer__len__);
+	py_bindmagic(tp_buffer, py_name("__repr__"), py_buffer__repr__);
+	py_bindmagic(tp_buffer, py_name("__getitem__"), py_buffer__getitem__);
+	py_bindmagic(tp_buffer, py_name("__setitem__"), py_buffer__setitem__);
+	py_bindproperty(tp_buffer, "type", py_buffer_type, NULL);
+	py_bindmethod(tp_buffer, "fill", py_buffer_fill);
+	py_bindmethod(tp_buffer, "slice", py_buffer_slice);
+	py_bindmethod(tp_buffer, "add", py_buffer_add);
+	py_bindmethod(tp_buffer, "mul", py_buffer_mul);
+	py_bindmethod(tp_buffer, "clamp", py_buffer_clamp);
+	py_bindmethod(tp_buffer, "sum", py_buffer_sum);
+}
+
 // --- resource bindings ---
 static bool py_ResourceGetImage(int argc, py_StackRef argv) {
 	const char* name = py_tostr(py_arg(0));
@@ -264,34 +710,40 @@ static bool py_ResourceGetImage(int argc, py_StackRef argv) {
 	return true;
 }
 
+/// @return the contents of a bytes or buffer argument, as passed by scripts for packed arrays, or NULL for other types
+/** Buffers are accepted if their elements are of the given type or uint8. */
+static const void* py_getbytes(py_Ref arg, ArcmBufferType type, size_t* numBytes) {
+	if(py_istype(arg, tp_buffer)) {
+		const ArcmBuffer* buf = (const ArcmBuffer*)py_touserdata(arg);
+		if(buf->type != type && buf->type != ARCM_BUFFER_UINT8)
+			return NULL;
+		*numBytes = buf->count * arcmBufferElementSize((ArcmBufferType)buf->type);
+		return arcmBufferData(buf);
+	}
+	if(!py_istype(arg, tp_bytes))
+		return NULL;
+	int size;
+	const void* data = py_tobytes(arg, &size);
+	*numBytes = (size_t)size;
+	return data;
+}
+
 // binding for resource.createImage(array, width, height, centerX, centerY, filtering) to arcmResourceCreateImage(data, width, height, centerX, centerY, filtering)
 static bool py_ResourceCreateImage(int argc, py_StackRef argv) {
-	// read data from an array/list containing uint32_t color values:
-	const size_t numItems = py_islist(py_arg(0)) ? py_list_len(py_arg(0)) : 0;
+	// packed color data in bytes is used in place, lists of uint32_t color values are converted to it
+	size_t numBytes = 0;
+	const void* bytes = py_getbytes(py_arg(0), ARCM_BUFFER_UINT32, &numBytes);
+	const size_t numItems = bytes ? numBytes / sizeof(uint32_t) : py_islist(py_arg(0)) ? py_list_len(py_arg(0)) : 0;
 	if(!numItems)
-		return TypeError("resource.createImage() expects non-empty list containing numeric color values as first argument");
-
-	size_t numBytes = numItems * sizeof(uint32_t);
-	uint32_t* data = malloc(numBytes);
-	int64_t color;
-	for(size_t i=0; i<numItems; ++i) {
-		py_ItemRef item = py_list_getitem(py_arg(0), i);
-		if(!py_castint(item, &color) || color<0 || color>0xFFFFFFFF) {
-			free(data);
-			return ValueError("resource.createImage() argument 0 expects numeric color value at position %i\n", (int64_t)i);
-		}
-		data[i] = (uint32_t)color;
-	}
+		return TypeError("resource.createImage() expects non-empty uint32 buffer, bytes, or list containing numeric color values as first argument");
 
 	int64_t width, height, filtering = 1;
 	float centerX = 0.0f, centerY = 0.0f;
 	if(!py_castint(py_arg(1), &width) ||
 	   !py_castint(py_arg(2), &height))
 		return false;
-	if(width*height < numItems) {
-		free(data);
-		return ValueError("resource.createImage() argument 1 expects width*height >= %zu\n", numItems);
-	}
+	if(width <= 0 || height <= 0 || width > INT32_MAX || height > INT32_MAX || (uint64_t)width*(uint64_t)height > numItems)
+		return ValueError("resource.createImage() expects positive width and height with width*height <= %i\n", (int64_t)numItems);
 	if(argc > 3 && !py_castfloat32(py_arg(3), &centerX))
 		return false;
 	if(argc > 4 && !py_castfloat32(py_arg(4), &centerY))
@@ -299,7 +751,26 @@ static bool py_ResourceCreateImage(int argc, py_StackRef argv) {
 	if(argc > 5 && !py_castint(py_arg(5), &filtering))
 		return false;
 
-	uint32_t handle = arcmResourceCreateImage((uint8_t*)data, (int)width, (int)height, centerX, centerY, (int)filtering);
+	uint32_t* data = NULL;
+	if(!bytes) {
+		py_ItemRef items = py_list_data(py_arg(0));
+		data = malloc(numItems * sizeof(uint32_t));
+		int64_t color;
+		for(size_t i=0; i<numItems; ++i) {
+			if(!py_castint(&items[i], &color)) {
+				free(data);
+				return false;
+			}
+			if(color<0 || color>0xFFFFFFFF) {
+				free(data);
+				return ValueError("resource.createImage() argument 0 expects numeric color value at position %i\n", (int64_t)i);
+			}
+			data[i] = (uint32_t)color;
+		}
+		bytes = data;
+	}
+
+	uint32_t handle = arcmResourceCreateImage((const uint8_t*)bytes, (int)width, (int)height, centerX, centerY, (int)filtering);
 	free(data);
 	py_newint(py_retval(), (int64_t)handle);
 	return true;
@@ -356,33 +827,43 @@ static bool py_ResourceGetTileGrid(int argc, py_StackRef argv) {
 
 static bool py_ResourceGetAudio(int argc, py_StackRef argv) {
 	const char* name = py_tostr(py_arg(0));
-	size_t handle = ResourceGetAudio(name);
+	size_t handle = arcmResourceGetAudio(name);
 	py_newint(py_retval(), (int64_t)handle);
 	return true;
 }
 
-// binding for resource.createAudio(list, numChannels) to AudioUploadPCM(waveData, numSamples, numChannels, 0)
+// binding for resource.createAudio(list, numChannels) to arcmAudioUploadPCM(waveData, numSamples, numChannels, 0)
 static bool py_ResourceCreateAudio(int argc, py_StackRef argv) {
-	// read data from an array/list containing float sample values:
-	const size_t numSamples = py_islist(py_arg(0)) ? py_list_len(py_arg(0)) : 0;
-	if(!numSamples)
-		return TypeError("resource.createAudio() expects non-empty list containing numeric sample values as first argument");
+	// packed float samples in bytes are copied at once, lists of sample values are converted
+	size_t numBytes = 0;
+	const void* bytes = py_getbytes(py_arg(0), ARCM_BUFFER_FLOAT32, &numBytes);
+	const size_t numSamples = bytes ? numBytes / sizeof(float) : py_islist(py_arg(0)) ? py_list_len(py_arg(0)) : 0;
+	if(!numSamples || numBytes % sizeof(float))
+		return TypeError("resource.createAudio() expects non-empty float32 buffer, bytes of floats, or list containing numeric sample values as first argument");
 
-	size_t numBytes = numSamples * sizeof(float);
-	float* data = malloc(numBytes);
+	int64_t numChannels = 1;
+	if(argc > 1 && !py_castint(py_arg(1), &numChannels))
+		return false;
+	if(numChannels < 1 || numChannels > 2)
+		return ValueError("resource.createAudio() argument 1 expects numChannels to be 1 or 2\n");
+
+	float* data = malloc(numSamples * sizeof(float)); // owned by AudioUploadPCM
+	if(bytes)
+		memcpy(data, bytes, numSamples * sizeof(float));
+	py_ItemRef items = bytes ? NULL : py_list_data(py_arg(0));
 	for(size_t i=0; i<numSamples; ++i) {
-		py_ItemRef item = py_list_getitem(py_arg(0), i);
-		if(!py_castfloat32(item, &data[i]) || data[i] < -1.0f || data[i] > 1.0f) {
+		if(items && !py_castfloat32(&items[i], &data[i])) {
+			free(data);
+			return false;
+		}
+		if(!(data[i] >= -1.0f && data[i] <= 1.0f)) {
 			free(data);
 			return ValueError("resource.createAudio() argument 0 expects numeric sample value between -1.0 and 1.0 at position %i\n", (int64_t)i);
 		}
 	}
 
-	int64_t numChannels = 1;
-	if(argc > 1 && !py_castint(py_arg(1), &numChannels)) 
-		return false;
-
-	size_t handle = AudioUploadPCM(data, numSamples, numChannels, 0);
+	// arcmAudioUploadPCM counts samples per channel
+	size_t handle = arcmAudioUploadPCM(data, (uint32_t)(numSamples / numChannels), (uint8_t)numChannels, 0);
 	py_newint(py_retval(), (int64_t)handle);
 	return true;
 }
@@ -394,11 +875,107 @@ static bool py_ResourceGetFont(int argc, py_StackRef argv) {
 	if(!py_castint(py_arg(1), &fontSize))
 		return false;
 
-	size_t handle = ResourceGetFont(name, (uint32_t)fontSize);
+	size_t handle = arcmResourceGetFont(name, (uint32_t)fontSize);
 	py_newint(py_retval(), (int64_t)handle);
 	return true;
 }
 
+static bool py_ResourceCreateAtlas(int argc, py_StackRef argv) {
+	if(argc < 1 || argc > 5)
+		return TypeError("resource.createAtlas() expects 1 to 5 arguments, %d given", argc);
+	PY_CHECK_ARG_TYPE(0, tp_list);
+	float scale = 1.0f, centerX=0.0f, centerY=0.0f;
+	int64_t filtering = 1;
+	if(argc > 1 && !py_castfloat32(py_arg(1), &scale))
+		return false;
+	if(argc > 2 && !py_castfloat32(py_arg(2), &centerX))
+		return false;
+	if(argc > 3 && !py_castfloat32(py_arg(3), &centerY))
+		return false;
+	if(argc > 4 && !py_castint(py_arg(4), &filtering))
+		return false;
+
+	const size_t numNames = (size_t)py_list_len(py_arg(0));
+	const char** names = (const char**)malloc((numNames ? numNames : 1) * sizeof(const char*));
+	for(size_t i=0; i<numNames; ++i) {
+		py_ItemRef item = py_list_getitem(py_arg(0), (int)i);
+		if(!py_checkstr(item)) {
+			free(names);
+			return false;
+		}
+		names[i] = py_tostr(item);
+	}
+	uint32_t* handles = (uint32_t*)malloc((numNames ? numNames : 1) * sizeof(uint32_t));
+	arcmResourceCreateAtlas(names, numNames, scale, centerX, centerY, (int)filtering, handles);
+	py_newlistn(py_retval(), (int)numNames);
+	py_Ref items = py_list_data(py_retval());
+	for(size_t i=0; i<numNames; ++i)
+		py_newint(&items[i], handles[i]);
+	free(handles);
+	free(names);
+	return true;
+}
+
+static bool py_ResourceLoadAsync(int argc, py_StackRef argv) {
+	if(argc < 1 || argc > 5)
+		return TypeError("resource.loadAsync() expects 1 to 5 arguments, %d given", argc);
+	PY_CHECK_ARG_TYPE(0, tp_str);
+	const char* name = py_tostr(py_arg(0));
+	float param = 0.0f, centerX=0.0f, centerY=0.0f;
+	int64_t filtering = 1;
+	if(argc > 1 && !py_castfloat32(py_arg(1), &param))
+		return false;
+	if(argc > 2 && !py_castfloat32(py_arg(2), &centerX))
+		return false;
+	if(argc > 3 && !py_castfloat32(py_arg(3), &centerY))
+		return false;
+	if(argc > 4 && !py_castint(py_arg(4), &filtering))
+		return false;
+
+	py_newint(py_retval(), arcmResourceLoadAsync(name, param, centerX, centerY, (int)filtering));
+	return true;
+}
+
+static bool py_ResourceLoad(int argc, py_StackRef argv) {
+	if(argc < 1 || argc > 2)
+		return TypeError("resource.load() expects 1 or 2 arguments, %d given", argc);
+	PY_CHECK_ARG_TYPE(0, tp_list);
+	if(argc > 1 && !py_isnone(py_arg(1))) {
+		if(!py_callable(py_arg(1)))
+			return TypeError("resource.load() expects a callable onProgress handler");
+		lifecycle_fns[LIFECYCLE_LOAD_PROGRESS] = *py_arg(1);
+	}
+	const int numItems = py_list_len(py_arg(0));
+	py_newlistn(py_retval(), numItems);
+	py_Ref items = py_list_data(py_retval());
+	for(int i=0; i<numItems; ++i) {
+		py_ItemRef item = py_list_getitem(py_arg(0), i);
+		if(!py_checkstr(item))
+			return false;
+		py_newint(&items[i], arcmResourceLoadAsync(py_tostr(item), 0.0f, 0.0f, 0.0f, 1));
+	}
+	return true;
+}
+
+static bool py_ResourceLoaded(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(1);
+	int64_t pending;
+	if(!py_castint(py_arg(0), &pending))
+		return false;
+	uint32_t handle;
+	if(arcmResourceLoaded((uint32_t)pending, &handle))
+		py_newint(py_retval(), handle);
+	else
+		py_newnone(py_retval());
+	return true;
+}
+
+static bool py_ResourceLoadProgress(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(0);
+	py_newfloat(py_retval(), arcmResourceLoadProgress());
+	return true;
+}
+
 static bool py_ResourceQueryImage(int argc, py_StackRef argv) {
 	PY_CHECK_ARGC(2);
 	int64_t image;
@@ -441,22 +1018,45 @@ static bool py_ResourceQueryFont(int argc, py_StackRef argv) {
 static bool py_ResourceGetStorageItem(int argc, py_StackRef argv) {
 	PY_CHECK_ARGC(1);
 	const char* key = py_tostr(py_arg(0));
-	const char* val = arcmResourceGetStorageItem(key);
+	size_t size;
+	bool isBinary;
+	const char* val = arcmResourceGetStorageValue(key, &size, &isBinary);
 	if(!val) py_newnone(py_retval());
-	else py_newstr(py_retval(), val);
+	else if(isBinary) memcpy(py_newbytes(py_retval(), (int)size), val, size);
+	else py_newstrv(py_retval(), (c11_sv){ val, (int)size });
 	return true;
 }
 
 static bool py_ResourceSetStorageItem(int argc, py_StackRef argv) {
 	PY_CHECK_ARGC(2);
 	const char* key = py_tostr(py_arg(0));
-	py_str(py_arg(1));
-	const char* val = py_tostr(py_retval());
-	arcmResourceSetStorageItem(key, val);
+	if(py_isnone(py_arg(1)))
+		arcmResourceSetStorageValue(key, NULL, 0, false);
+	else if(py_istype(py_arg(1), tp_bytes)) {
+		int size;
+		const unsigned char* data = py_tobytes(py_arg(1), &size);
+		arcmResourceSetStorageValue(key, data, size, true);
+	}
+	else if(py_istype(py_arg(1), tp_buffer)) { // stored as binary data of its elements
+		const ArcmBuffer* buf = (const ArcmBuffer*)py_touserdata(py_arg(1));
+		arcmResourceSetStorageValue(key, arcmBufferData(buf), buf->count * arcmBufferElementSize((ArcmBufferType)buf->type), true);
+	}
+	else {
+		if(!py_str(py_arg(1)))
+			return false;
+		c11_sv val = py_tosv(py_retval());
+		arcmResourceSetStorageValue(key, val.data, val.size, false);
+	}
 	py_newnone(py_retval());
 	return true;
 }
 
+static bool py_ResourceFlushStorage(int argc, py_StackRef argv) {
+	PY_CHECK_ARGC(0);
+	py_newbool(py_retval(), arcmResourceFlushStorage());
+	return true;
+}
+
 /// --- Bindings ---
 static py_GlobalRef gfx_ns = NULL;
 
@@ -470,6 +1070,12 @@ static void bindArcamini() {
 	py_bindfunc(window_ns, "height", py_WindowHeight);
 	py_bindfunc(window_ns, "color", py_WindowClearColor);
 	py_bindfunc(window_ns, "switchScene", py_switchScene);
+	py_bindfunc(window_ns, "preloadScene", py_preloadScene);
+	py_bindfunc(window_ns, "axisFilter", py_WindowAxisFilter);
+	py_bindfunc(window_ns, "inputState", py_WindowInputState);
+	py_bindfunc(window_ns, "pressed", py_WindowPressed);
+	py_bindfunc(window_ns, "released", py_WindowReleased);
+	py_bindfunc(window_ns, "stats", py_WindowStats);
 	py_setdict(arcamini_ns, py_name("window"), window_ns);
 
 	// gfx namespace, only used by draw callback
@@ -489,7 +1095,13 @@ static void bindArcamini() {
 	// audio namespace
 	py_Ref audio_ns = py_newmodule("audio");
 	py_bindfunc(audio_ns, "replay", py_AudioReplay);
+	py_bindfunc(audio_ns, "replayAt", py_AudioReplayAt);
+	py_bindfunc(audio_ns, "time", py_AudioTime);
+	py_bindfunc(audio_ns, "bufferSize", py_AudioBufferSize);
+	py_bindfunc(audio_ns, "latency", py_AudioLatency);
 	py_bindfunc(audio_ns, "volume", py_AudioVolume);
+	py_bindfunc(audio_ns, "stream", py_AudioStream);
+	py_bindfunc(audio_ns, "synth", py_AudioSynth);
 	py_setdict(arcamini_ns, py_name("audio"), audio_ns);
 
 	// resource namespace
@@ -502,30 +1114,100 @@ static void bindArcamini() {
 	py_bindfunc(resource_ns, "getAudio", py_ResourceGetAudio);
 	py_bindfunc(resource_ns, "createAudio", py_ResourceCreateAudio);
 	py_bindfunc(resource_ns, "getFont", py_ResourceGetFont);
+	py_bindfunc(resource_ns, "createAtlas", py_ResourceCreateAtlas);
+	py_bindfunc(resource_ns, "loadAsync", py_ResourceLoadAsync);
+	py_bindfunc(resource_ns, "load", py_ResourceLoad);
+	py_bindfunc(resource_ns, "loaded", py_ResourceLoaded);
+	py_bindfunc(resource_ns, "loadProgress", py_ResourceLoadProgress);
 	py_bindfunc(resource_ns, "queryImage", py_ResourceQueryImage);
 	py_bindfunc(resource_ns, "queryAudio", py_ResourceQueryAudio);
 	py_bindfunc(resource_ns, "queryFont", py_ResourceQueryFont);
 	py_bindfunc(resource_ns, "getStorageItem", py_ResourceGetStorageItem);
 	py_bindfunc(resource_ns, "setStorageItem", py_ResourceSetStorageItem);
+	py_bindfunc(resource_ns, "flushStorage", py_ResourceFlushStorage);
 	py_setdict(arcamini_ns, py_name("resource"), resource_ns);
+
+	// buffer type
+	bindBuffer(arcamini_ns);
+
+	py_Ref slots = py_newtuple(py_getreg(0), LIFECYCLE_SLOTS);
+	for(int i=0; i<LIFECYCLE_SLOTS; ++i)
+		py_newnil(&slots[i]);
+	py_setdict(arcamini_ns, py_name("_lifecycle"), py_getreg(0));
+	lifecycle_fns = slots;
+	py_newstr(&lifecycle_fns[LIFECYCLE_STR_AXIS], "axis");
+	py_newstr(&lifecycle_fns[LIFECYCLE_STR_BUTTON], "button");
 }
 
 
 /// --- VM Management ---
 
-// Custom importfile callback
+// Bytecode of the module source requested last, handed to pocketpy when it
+// subsequently asks for the corresponding .pyc file.
+static struct {
+	char* name;
+	void* data;
+	int size;
+} pendingBytecode = { NULL, NULL, 0 };
+
+static void clearPendingBytecode() {
+	free(pendingBytecode.name);
+	free(pendingBytecode.data);
+	pendingBytecode.name = NULL;
+	pendingBytecode.data = NULL;
+}
+
+// Custom importfile callback. pocketpy requests <module>.py before <module>.pyc,
+// so sources are compiled via the bytecode cache right away and the source is
+// only returned if it does not compile, for pocketpy to report the error.
 static char* custom_importfile(const char* module_name, int* data_size) {
-	char* script = ResourceGetText(module_name);
+	size_t len = strlen(module_name);
+	if (len > 4 && strcmp(module_name + len - 4, ".pyc") == 0) {
+		if (pendingBytecode.name && strcmp(pendingBytecode.name, module_name) == 0) {
+			void* data = pendingBytecode.data;
+			pendingBytecode.data = NULL;
+			*data_size = pendingBytecode.size;
+			clearPendingBytecode();
+			return (char*)data;
+		}
+		clearPendingBytecode();
+		// module shipped as <module>.py.bc
+		char* srcName = strdup(module_name);
+		srcName[len-1] = 0;
+		void* data = loadBytecode(NULL, srcName, data_size);
+		if (!data)
+			fprintf(stderr, "Module not found: %s\n", srcName);
+		free(srcName);
+		return (char*)data;
+	}
+
+	char* copy;
+	const char* script = arcmResourceText(module_name, &copy);
 	if (!script)
-		fprintf(stderr, "Module not found: %s\n", module_name);
-	else if (data_size)
-		*data_size = (int)strlen(script);
-	return script;
+		return NULL;
+	int size;
+	void* data = loadBytecode(script, module_name, &size);
+	if (!data) {
+		py_clearexc(NULL);
+		if (data_size)
+			*data_size = (int)strlen(script);
+		return copy ? copy : strdup(script); // pocketpy takes ownership
+	}
+	free(copy);
+	clearPendingBytecode();
+	pendingBytecode.name = (char*)malloc(len + 2);
+	strcat(strcpy(pendingBytecode.name, module_name), "c");
+	pendingBytecode.data = data;
+	pendingBytecode.size = size;
+	return NULL;
 }
 
 void shutdownVM(void* context) {
 	if(context)
 		py_finalize();
+	lifecycle_fns = NULL;
+	clearPendingBytecode();
+	arcmSceneCacheClear();
 }
 
 // Creates and initializes a PocketPy VM and returns its context
@@ -536,21 +1218,46 @@ void* initVM(const char* script, const char* scriptName) {
 	void* ctx = (void*)1;
 
 	// Evaluate user script
-	bool ok = py_exec(script, scriptName, EXEC_MODE, NULL);
+	bool ok = execScene(script, scriptName);
 	if(!ok || py_checkexc(false)) {
 		py_printexc();
 		shutdownVM(ctx);
 		return NULL;
 	}
+	resolveLifecycleCallbacks();
 	return ctx;
 }
 
+// pocketpy code objects always include their source, so bytecode cannot be stripped
+bool compileScript(const char* scriptName, const char* fileName) {
+	char* script = arcmResourceGetText(scriptName);
+	if(!script) {
+		fprintf(stderr, "could not read script %s\n", scriptName);
+		return false;
+	}
+	py_initialize(); // does nothing if already initialized
+	bool ok = py_compile(script, scriptName, EXEC_MODE, false);
+	free(script);
+	if(!ok)
+		py_printexc();
+	else {
+		py_assign(py_pushtmp(), py_retval());
+		int size;
+		void* bytecode = CodeObject__dumps(py_touserdata(py_peek(-1)), &size);
+		py_pop();
+		ok = arcmBytecodeShip(fileName, PY_BYTECODE_FORMAT, bytecode, size);
+		free(bytecode);
+	}
+	// no py_finalize(), pocketpy cannot be initialized again for compiling further scripts
+	return ok;
+}
+
 /// --- Event dispatchers ---
 
 bool dispatchLifecycleEvent(const char* evtName, void* callback) {
 	(void)callback;
-	py_Ref fn = py_getglobal(py_name(evtName));
-	if(!fn || (py_typeof(fn) != tp_function && py_typeof(fn) != tp_nativefunc))
+	py_Ref fn = lifecycleFunction(evtName);
+	if(!fn)
 		return true;
 
 	py_push(fn);
@@ -562,8 +1269,8 @@ bool dispatchLifecycleEvent(const char* evtName, void* callback) {
 
 bool dispatchLifecycleEventArgv(const char* evtName, int argc, char** argv, void* callback) {
 	(void)callback;
-	py_Ref fn = py_getglobal(py_name(evtName));
-	if(!fn || (py_typeof(fn) != tp_function && py_typeof(fn) != tp_nativefunc))
+	py_Ref fn = lifecycleFunction(evtName);
+	if(!fn)
 		return true;
 
 	py_push(fn);
@@ -581,60 +1288,93 @@ bool dispatchLifecycleEventArgv(const char* evtName, int argc, char** argv, void
 	return true;
 }
 
-void dispatchAxisEvent(size_t id, uint8_t axis, float value, void* callback) {
+void dispatchAxisEvent(size_t id, uint8_t axis, float value, double timestamp, void* callback) {
 	(void)callback;
-	py_Ref fnInput = py_getglobal(py_name("input"));
-	if(!fnInput || (py_typeof(fnInput) != tp_function && py_typeof(fnInput) != tp_nativefunc))
+	py_Ref fnInput = &lifecycle_fns[LIFECYCLE_INPUT];
+	if(py_isnil(fnInput))
 		return;
 
 	py_push(fnInput);
 	py_pushnil();
 	py_Ref val = py_getreg(0);
 
-	py_newstr(val, "axis");
-	py_push(val);
+	py_push(&lifecycle_fns[LIFECYCLE_STR_AXIS]);
 	py_newint(val, id);
 	py_push(val);
 	py_newint(val, axis);
 	py_push(val);
 	py_newfloat(val, value);
 	py_push(val);
-	py_pushnone();
+	py_newfloat(val, timestamp);
+	py_push(val);
 
 	if(!py_vectorcall(5, 0))
 		handleException();
 }
 
-void dispatchButtonEvent(size_t id, uint8_t button, float value, void* callback) {
+void dispatchButtonEvent(size_t id, uint8_t button, float value, double timestamp, void* callback) {
 	(void)callback;
-	arcmWindowCloseOnButton67(id, button, value);
-
-	py_Ref fnInput = py_getglobal(py_name("input"));
-	if(!fnInput || (py_typeof(fnInput) != tp_function && py_typeof(fnInput) != tp_nativefunc))
+	py_Ref fnInput = &lifecycle_fns[LIFECYCLE_INPUT];
+	if(py_isnil(fnInput))
 		return;
 
 	py_push(fnInput);
 	py_pushnil();
 	py_Ref val = py_getreg(0);
 
-	py_newstr(val, "button");
-	py_push(val);
+	py_push(&lifecycle_fns[LIFECYCLE_STR_BUTTON]);
 	py_newint(val, id);
 	py_push(val);
 	py_newint(val, button);
 	py_push(val);
 	py_newfloat(val, value);
 	py_push(val);
-	py_pushnone();
+	py_newfloat(val, timestamp);
+	py_push(val);
 
 	if(!py_vectorcall(5, 0))
 		handleException();
 }
 
+bool dispatchInputBatch(const double* events, size_t numEvents, void* callback) {
+	(void)callback;
+	py_Ref fnBatch = &lifecycle_fns[LIFECYCLE_INPUT_BATCH];
+	if(py_isnil(fnBatch))
+		return false;
+
+	py_push(fnBatch);
+	py_pushnil();
+	const int numValues = (int)(numEvents * ARCM_INPUT_EVENT_STRIDE);
+	py_Ref list = py_getreg(0);
+	py_newlistn(list, numValues);
+	py_Ref items = py_list_data(list);
+	for(int i=0; i<numValues; ++i)
+		py_newfloat(&items[i], events[i]);
+	py_push(list);
+	if(!py_vectorcall(1, 0))
+		handleException();
+	return true;
+}
+
+static void dispatchLoadProgress() {
+	py_push(&lifecycle_fns[LIFECYCLE_LOAD_PROGRESS]);
+	py_pushnil();
+	const float progress = arcmResourceLoadProgress();
+	if(progress >= 1.0f) // report completion once, then release the handler
+		py_newnil(&lifecycle_fns[LIFECYCLE_LOAD_PROGRESS]);
+	py_Ref arg0 = py_getreg(0);
+	py_newfloat(arg0, progress);
+	py_push(arg0);
+	if(!py_vectorcall(1, 0))
+		handleException();
+}
+
 bool dispatchUpdateEvent(double deltaT, void* callback) {
 	(void)callback;
-	py_Ref fnUpdate = py_getglobal(py_name("update"));
-	if(!fnUpdate || (py_typeof(fnUpdate) != tp_function && py_typeof(fnUpdate) != tp_nativefunc))
+	if(!py_isnil(&lifecycle_fns[LIFECYCLE_LOAD_PROGRESS]))
+		dispatchLoadProgress();
+	py_Ref fnUpdate = &lifecycle_fns[LIFECYCLE_UPDATE];
+	if(py_isnil(fnUpdate))
 		return false;
 	py_push(fnUpdate);
 	py_pushnil();
@@ -648,8 +1388,8 @@ bool dispatchUpdateEvent(double deltaT, void* callback) {
 
 void dispatchDrawEvent(void* callback) {
 	(void)callback;
-	py_Ref fnDraw = py_getglobal(py_name("draw"));
-	if(!fnDraw || (py_typeof(fnDraw) != tp_function && py_typeof(fnDraw) != tp_nativefunc))
+	py_Ref fnDraw = &lifecycle_fns[LIFECYCLE_DRAW];
+	if(py_isnil(fnDraw))
 		return;
 	
 	py_push(fnDraw);
@@ -182,6 +182,56 @@ static float* getFloatArray(JSContext *ctx, JSValueConst arr, size_t *num_elems)
     return buf;
 }
 
+// identifies QuickJS bytecode in the bytecode cache, JS_ReadObject additionally
+// rejects bytecode of a different QuickJS version
+#define JS_BYTECODE_FORMAT "quickjs"
+const char* const scriptBytecodeFormat = JS_BYTECODE_FORMAT;
+
+// Compiles `script` as an ES module, or reads its bytecode from the bytecode
+// cache instead. Without source, the module must be shipped as bytecode. A
+// freshly compiled module is written to the cache before it is evaluated, as
+// JS_WriteObject only accepts modules that have not been instantiated yet.
+// The bytecode of scenes is additionally kept in the scene cache.
+static JSValue compileModule(JSContext *ctx, const char *script, const char *name, bool scene) {
+    size_t size;
+    uint8_t *bytecode = arcmBytecodeLoad(name, script, JS_BYTECODE_FORMAT, &size);
+    if (bytecode) {
+        JSValue compiled = JS_ReadObject(ctx, bytecode, size, JS_READ_OBJ_BYTECODE);
+        if (scene && !JS_IsException(compiled))
+            arcmSceneCacheStore(name, bytecode, size);
+        free(bytecode);
+        if (!JS_IsException(compiled) || !script)
+            return compiled;
+        JS_FreeValue(ctx, JS_GetException(ctx)); // outdated bytecode, recompile
+    }
+    if (!script)
+        return JS_ThrowReferenceError(ctx, "could not load module '%s'", name);
+
+    JSValue compiled = JS_Eval(ctx, script, strlen(script), name,
+        JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+    if (!JS_IsException(compiled)) {
+        uint8_t *buf = JS_WriteObject(ctx, &size, compiled, JS_WRITE_OBJ_BYTECODE);
+        if (buf) {
+            arcmBytecodeStore(name, script, JS_BYTECODE_FORMAT, buf, size);
+            if (scene)
+                arcmSceneCacheStore(name, buf, size);
+            js_free(ctx, buf);
+        }
+    }
+    return compiled;
+}
+
+// Returns the compiled module of a scene, preferably read from the scene
+// cache. Reading bytecode creates a new module instance, so each visit of a
+// scene starts with freshly evaluated module state, as if compiled anew.
+static JSValue compileScene(JSContext *ctx, const char *script, const char *name) {
+    size_t size;
+    const uint8_t *bytecode = arcmSceneCacheLoad(name, &size);
+    if (bytecode)
+        return JS_ReadObject(ctx, bytecode, size, JS_READ_OBJ_BYTECODE);
+    return compileModule(ctx, script, name, true);
+}
+
 // Standard ES module loader: called by the engine for every static or
 // dynamic `import` specifier. Compiles the referenced file as a module and
 // hands ownership of the resulting JSModuleDef to the module registry --
@@ -191,18 +241,16 @@ static float* getFloatArray(JSContext *ctx, JSValueConst arr, size_t *num_elems)
 // wrapper leaks and JS_FreeRuntime asserts on shutdown (found by testing a
 // standalone reproduction of this exact loader before wiring it in here).
 static JSModuleDef *js_module_loader(JSContext *ctx, const char *module_name, void *opaque) {
-    // ResourceGetText (not ResourceGetBinary) matches initVM's proven-working
+    // arcmResourceText (not ResourceGetBinary) matches initVM's proven-working
     // pattern below: ResourceGetBinary's numBytes includes a defensive
     // trailing NUL, which JS_Eval then tries to tokenize as a stray
     // character at end-of-source ("SyntaxError: unexpected character").
-    char *script = (char*)ResourceGetText(module_name);
-    if (!script) {
-        JS_ThrowReferenceError(ctx, "could not load module '%s'", module_name);
-        return NULL;
-    }
-    JSValue func_val = JS_Eval(ctx, script, strlen(script), module_name,
-        JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
-    free(script);
+    // The source is compiled in place if the archive is mapped. A missing
+    // source is fine as long as the module is shipped as bytecode.
+    char *copy;
+    const char *script = arcmResourceText(module_name, &copy);
+    JSValue func_val = compileModule(ctx, script, module_name, false);
+    free(copy);
     if (JS_IsException(func_val))
         return NULL;
     JSModuleDef *m = JS_VALUE_GET_PTR(func_val);
@@ -216,16 +264,49 @@ static JSModuleDef *js_module_loader(JSContext *ctx, const char *module_name, vo
 // wholesale on every window.switchScene() call.
 static JSValue lifecycle_ns;
 
+// The lifecycle functions exported by lifecycle_ns, resolved once per loaded
+// scene by resolveLifecycleCallbacks() so that dispatching an event does not
+// repeat the property lookup. Entries are JS_UNDEFINED for missing exports.
+static JSValue lifecycle_fns[LIFECYCLE_NUM];
+
+// event type arguments of input(), created once instead of per event
+static JSValue str_axis, str_button;
+
+static void resolveLifecycleCallbacks(JSContext *ctx) {
+    for (int i = 0; i < LIFECYCLE_NUM; ++i) {
+        JSValue fn = JS_GetPropertyStr(ctx, lifecycle_ns, lifecycleName((LifecycleCallback)i));
+        if (!JS_IsFunction(ctx, fn)) {
+            JS_FreeValue(ctx, fn);
+            fn = JS_UNDEFINED;
+        }
+        JS_FreeValue(ctx, lifecycle_fns[i]);
+        lifecycle_fns[i] = fn;
+    }
+}
+
+// Returns a new reference to the handler of evtName, or JS_UNDEFINED. The
+// reference keeps the function alive even if it switches scenes while running.
+static JSValue lifecycleFunction(JSContext *ctx, const char* evtName) {
+    LifecycleCallback cb = lifecycleCallback(evtName);
+    if (cb < LIFECYCLE_NUM)
+        return JS_DupValue(ctx, lifecycle_fns[cb]);
+    return JS_GetPropertyStr(ctx, lifecycle_ns, evtName);
+}
+
 // Compiles and runs `script` as an ES module, then points lifecycle_ns at
 // its exports. Returns false on failure, leaving the exception pending on
 // ctx for the caller to report (each call site -- initVM vs switchScene --
-// already has its own error-reporting convention).
-static bool loadLifecycleModule(JSContext *ctx, const char *script, size_t script_len, const char *scriptName) {
-    JSValue compiled = JS_Eval(ctx, script, script_len, scriptName,
-        JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+// already has its own error-reporting convention). `script` may be NULL for
+// scenes in the scene cache or scripts shipped as bytecode only.
+static bool loadLifecycleModule(JSContext *ctx, const char *script, const char *scriptName) {
+    JSValue compiled = compileScene(ctx, script, scriptName);
     if (JS_IsException(compiled))
         return false;
     JSModuleDef *m = JS_VALUE_GET_PTR(compiled);
+    // modules read from bytecode do not load their imports by themselves; on
+    // failure, JS_ResolveModule already discards the unresolved modules
+    if (JS_ResolveModule(ctx, compiled) < 0)
+        return false;
 
     JSValue result = JS_EvalFunction(ctx, compiled); // consumes `compiled`
     if (JS_IsException(result)) {
@@ -239,6 +320,7 @@ static bool loadLifecycleModule(JSContext *ctx, const char *script, size_t scrip
         return false;
     JS_FreeValue(ctx, lifecycle_ns);
     lifecycle_ns = ns;
+    resolveLifecycleCallbacks(ctx);
     return true;
 }
 
@@ -269,6 +351,55 @@ static JSValue js_WindowClearColor(JSContext *ctx, JSValueConst this_val, int ar
     return JS_UNDEFINED;
 }
 
+// --- window input state and stats bindings ---
+static JSValue js_WindowAxisFilter(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    double resolution, deadzone;
+    if (JS_ToFloat64Default(ctx, &resolution, argv[0], 0.1) || JS_ToFloat64Default(ctx, &deadzone, argv[1], 0.0))
+        return JS_ThrowTypeError(ctx, "window.axisFilter expects ([number, number])");
+    arcmWindowAxisFilter((float)resolution, (float)deadzone);
+    return JS_UNDEFINED;
+}
+
+static JSValue js_WindowInputState(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    uint32_t device;
+    if (JS_ToUint32(ctx, &device, argv[0]))
+        return JS_ThrowTypeError(ctx, "window.inputState expects (uint32)");
+    uint32_t buttons;
+    float axes[16];
+    const int numAxes = arcmWindowInputState(device, &buttons, axes, 16);
+    double state[17];
+    state[0] = buttons;
+    for (int i = 0; i < numAxes; ++i)
+        state[i+1] = axes[i];
+    JSValue buf = JS_NewArrayBufferCopy(ctx, (const uint8_t*)state, (numAxes + 1) * sizeof(double));
+    JSValue arr = JS_NewTypedArray(ctx, 1, &buf, JS_TYPED_ARRAY_FLOAT64);
+    JS_FreeValue(ctx, buf);
+    return arr;
+}
+
+static JSValue js_WindowPressed(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    uint32_t device, button;
+    if (JS_ToUint32(ctx, &device, argv[0]) || JS_ToUint32(ctx, &button, argv[1]))
+        return JS_ThrowTypeError(ctx, "window.pressed expects (uint32, uint32)");
+    return JS_NewBool(ctx, button < 256 && arcmWindowPressed(device, (uint8_t)button));
+}
+
+static JSValue js_WindowReleased(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    uint32_t device, button;
+    if (JS_ToUint32(ctx, &device, argv[0]) || JS_ToUint32(ctx, &button, argv[1]))
+        return JS_ThrowTypeError(ctx, "window.released expects (uint32, uint32)");
+    return JS_NewBool(ctx, button < 256 && arcmWindowReleased(device, (uint8_t)button));
+}
+
+static JSValue js_WindowStats(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    const char* name = JS_ToCString(ctx, argv[0]);
+    if (!name)
+        return JS_ThrowTypeError(ctx, "window.stats expects (string)");
+    double value = arcmWindowStats(name);
+    JS_FreeCString(ctx, name);
+    return isnan(value) ? JS_UNDEFINED : JS_NewFloat64(ctx, value);
+}
+
 // --- window.switchScene binding ---
 static JSValue js_WindowSwitchScene(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
     const char *fname = argc ? JS_ToCString(ctx, argv[0]) : NULL;
@@ -298,9 +429,13 @@ static JSValue js_WindowSwitchScene(JSContext *ctx, JSValueConst this_val, int a
 
     // Load new script (as an ES module -- clearing the old enter/input/
     // update/draw/leave bindings isn't needed anymore: those are read from
-    // lifecycle_ns, which loadLifecycleModule() below replaces wholesale)
-    char *script = (char *)ResourceGetText(fname);
-    if (!script) {
+    // lifecycle_ns, which loadLifecycleModule() below replaces wholesale).
+    // Scenes visited or preloaded before are compiled already.
+    size_t size;
+    bool cached = arcmSceneCacheLoad(fname, &size) != NULL;
+    char *copy = NULL;
+    const char *script = cached ? NULL : arcmResourceText(fname, &copy);
+    if (!cached && !script && !arcmBytecodeShipped(fname, JS_BYTECODE_FORMAT)) {
         JS_FreeCString(ctx, fname);
         if (args) {
             for (int i = 0; i < numArgs; ++i) free(args[i]);
@@ -309,8 +444,8 @@ static JSValue js_WindowSwitchScene(JSContext *ctx, JSValueConst this_val, int a
         return JS_ThrowReferenceError(ctx, "window.switchScene: file not found");
     }
 
-    bool ok = loadLifecycleModule(ctx, script, strlen(script), fname);
-    free(script);
+    bool ok = loadLifecycleModule(ctx, script, fname);
+    free(copy);
     JS_FreeCString(ctx, fname);
 
     if (!ok)
@@ -323,12 +458,43 @@ static JSValue js_WindowSwitchScene(JSContext *ctx, JSValueConst this_val, int a
     return JS_UNDEFINED;
 }
 
+static JSValue js_WindowPreloadScene(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    const char *fname = argc ? JS_ToCString(ctx, argv[0]) : NULL;
+    if (!fname)
+        return JS_ThrowTypeError(ctx, "window.preloadScene: invalid or missing filename");
+    size_t size;
+    JSValue ret = JS_UNDEFINED;
+    if (!arcmSceneCacheLoad(fname, &size)) {
+        char *copy;
+        const char *script = arcmResourceText(fname, &copy);
+        if (!script && !arcmBytecodeShipped(fname, JS_BYTECODE_FORMAT))
+            ret = JS_ThrowReferenceError(ctx, "window.preloadScene: file not found");
+        else {
+            // only the bytecode is kept, switchScene instantiates it
+            JSValue compiled = compileModule(ctx, script, fname, true);
+            if (JS_IsException(compiled))
+                ret = compiled;
+            else
+                JS_FreeValue(ctx, compiled);
+        }
+        free(copy);
+    }
+    JS_FreeCString(ctx, fname);
+    return ret;
+}
+
 static const JSCFunctionListEntry js_Window_funcs[] = {
     JS_CFUNC_DEF("title", 1, js_WindowTitle),
     JS_CFUNC_DEF("width", 0, js_WindowWidth),
     JS_CFUNC_DEF("height", 0, js_WindowHeight),
     JS_CFUNC_DEF("color", 1, js_WindowClearColor),
     JS_CFUNC_DEF("switchScene", 1, js_WindowSwitchScene),
+    JS_CFUNC_DEF("preloadScene", 1, js_WindowPreloadScene),
+    JS_CFUNC_DEF("axisFilter", 2, js_WindowAxisFilter),
+    JS_CFUNC_DEF("inputState", 1, js_WindowInputState),
+    JS_CFUNC_DEF("pressed", 2, js_WindowPressed),
+    JS_CFUNC_DEF("released", 2, js_WindowReleased),
+    JS_CFUNC_DEF("stats", 1, js_WindowStats),
 };
 
 
@@ -467,18 +633,46 @@ static const JSCFunctionListEntry js_gfx_funcs[] = {
 
 static JSValue js_AudioReplay(JSContext *ctx, JSValueConst this_val,
                               int argc, JSValueConst *argv) {
-    uint32_t sample; double vol, bal, det;
+    uint32_t sample; double vol, bal, det; int32_t priority;
     if (JS_ToUint32(ctx, &sample, argv[0]) ||
         JS_ToFloat64Default(ctx, &vol, argv[1], 1.0) ||
         JS_ToFloat64Default(ctx, &bal, argv[2], 0.0) ||
-        JS_ToFloat64Default(ctx, &det, argv[3], 0.0))
-        return JS_ThrowTypeError(ctx, "audio.replay expects (uint32[, number, number, number])");
-    uint32_t track = AudioReplay(sample,(float)vol,(float)bal,(float)det);
+        JS_ToFloat64Default(ctx, &det, argv[3], 0.0) ||
+        JS_ToInt32Default(ctx, &priority, argv[4], 0))
+        return JS_ThrowTypeError(ctx, "audio.replay expects (uint32[, number, number, number, int])");
+    uint32_t track = arcmAudioReplay(sample,(float)vol,(float)bal,(float)det,priority);
     if (track == UINT_MAX)
         return JS_UNDEFINED; // signify invalid
     return JS_NewUint32(ctx, track);
 }
 
+static JSValue js_AudioReplayAt(JSContext *ctx, JSValueConst this_val,
+                                int argc, JSValueConst *argv) {
+    uint32_t sample; double when, vol, bal, det;
+    if (JS_ToUint32(ctx, &sample, argv[0]) ||
+        JS_ToFloat64(ctx, &when, argv[1]) ||
+        JS_ToFloat64Default(ctx, &vol, argv[2], 1.0) ||
+        JS_ToFloat64Default(ctx, &bal, argv[3], 0.0) ||
+        JS_ToFloat64Default(ctx, &det, argv[4], 0.0))
+        return JS_ThrowTypeError(ctx, "audio.replayAt expects (uint32, number[, number, number, number])");
+    return JS_NewBool(ctx, arcmAudioReplayAt(sample, when, (float)vol, (float)bal, (float)det));
+}
+
+static JSValue js_AudioTime(JSContext *ctx, JSValueConst this_val,
+                            int argc, JSValueConst *argv) {
+    return JS_NewFloat64(ctx, arcmAudioTime());
+}
+
+static JSValue js_AudioBufferSize(JSContext *ctx, JSValueConst this_val,
+                                  int argc, JSValueConst *argv) {
+    return JS_NewUint32(ctx, arcmAudioBufferSize());
+}
+
+static JSValue js_AudioLatency(JSContext *ctx, JSValueConst this_val,
+                               int argc, JSValueConst *argv) {
+    return JS_NewFloat64(ctx, arcmAudioLatency());
+}
+
 static JSValue js_AudioVolume(JSContext *ctx, JSValueConst this_val,
                               int argc, JSValueConst *argv) {
     uint32_t track; double vol, fadeTime;
@@ -490,9 +684,60 @@ static JSValue js_AudioVolume(JSContext *ctx, JSValueConst this_val,
     return JS_UNDEFINED;
 }
 
+static JSValue js_AudioStream(JSContext *ctx, JSValueConst this_val,
+                              int argc, JSValueConst *argv) {
+    double vol;
+    const char* name = JS_ToCString(ctx, argv[0]);
+    if (!name || JS_ToFloat64Default(ctx, &vol, argv[1], 1.0)) {
+        JS_FreeCString(ctx, name);
+        return JS_ThrowTypeError(ctx, "audio.stream expects (string[, number, boolean])");
+    }
+    uint32_t track = arcmAudioStream(name, (float)vol, argc > 2 && JS_ToBool(ctx, argv[2]) > 0);
+    JS_FreeCString(ctx, name);
+    if (track == UINT_MAX)
+        return JS_UNDEFINED;
+    return JS_NewUint32(ctx, track);
+}
+
+static JSValue js_AudioSynth(JSContext *ctx, JSValueConst this_val,
+                             int argc, JSValueConst *argv) {
+    if (!JS_IsObject(argv[0]))
+        return JS_ThrowTypeError(ctx, "audio.synth expects (object)");
+    ArcmSynthParams params;
+    arcmSynthDefaults(&params);
+    JSValue val = JS_GetPropertyStr(ctx, argv[0], "wave");
+    if (!JS_IsUndefined(val)) {
+        const char* wave = JS_ToCString(ctx, val);
+        const bool known = wave && arcmSynthWave(&params, wave);
+        JS_FreeCString(ctx, wave);
+        JS_FreeValue(ctx, val);
+        if (!known)
+            return JS_ThrowRangeError(ctx, "audio.synth: unknown wave");
+    }
+    for (unsigned i = 0; arcmSynthParamName(i); ++i) {
+        const char* name = arcmSynthParamName(i);
+        double value;
+        val = JS_GetPropertyStr(ctx, argv[0], name);
+        const bool defined = !JS_IsUndefined(val);
+        const int err = defined && JS_ToFloat64(ctx, &value, val);
+        JS_FreeValue(ctx, val);
+        if (err)
+            return JS_EXCEPTION;
+        if (defined)
+            arcmSynthParam(&params, name, (float)value);
+    }
+    return JS_NewUint32(ctx, arcmAudioSynth(&params));
+}
+
 static const JSCFunctionListEntry js_Audio_funcs[] = {
-    JS_CFUNC_DEF("replay", 4, js_AudioReplay),
+    JS_CFUNC_DEF("replay", 5, js_AudioReplay),
+    JS_CFUNC_DEF("replayAt", 5, js_AudioReplayAt),
+    JS_CFUNC_DEF("time", 0, js_AudioTime),
+    JS_CFUNC_DEF("bufferSize", 0, js_AudioBufferSize),
+    JS_CFUNC_DEF("latency", 0, js_AudioLatency),
     JS_CFUNC_DEF("volume", 3, js_AudioVolume),
+    JS_CFUNC_DEF("stream", 3, js_AudioStream),
+    JS_CFUNC_DEF("synth", 1, js_AudioSynth),
 };
 
 
@@ -548,6 +793,10 @@ static JSValue js_ResourceCreateImage(JSContext *ctx, JSValueConst this_val, int
         free(alloc_data);
         return JS_ThrowTypeError(ctx, "resource.createImage expects (ArrayBuffer, int, int[, float, float, int])");
     }
+    if (width <= 0 || height <= 0 || (uint64_t)width * (uint64_t)height > bufSz / sizeof(uint32_t)) {
+        free(alloc_data);
+        return JS_ThrowRangeError(ctx, "resource.createImage expects positive width and height, and their product must not exceed the number of color values");
+    }
     size_t handle = arcmResourceCreateImage(data, width, height, centerX, centerY, filtering);
     free(alloc_data);
     return JS_NewUint32(ctx, (uint32_t)handle);
@@ -586,12 +835,12 @@ static JSValue js_ResourceGetAudio(JSContext *ctx, JSValueConst this_val, int ar
     const char* name = JS_ToCString(ctx, argv[0]);
     if (!name)
         return JS_ThrowTypeError(ctx, "resource.getAudio expects string");
-    size_t handle = ResourceGetAudio(name);
+    size_t handle = arcmResourceGetAudio(name);
     JS_FreeCString(ctx, name);
     return JS_NewUint32(ctx, (uint32_t)handle);
 }
 
-// binding for uint32_t AudioUploadPCM(float* waveData, uint32_t numSamples, uint8_t numChannels, uint32_t offset)
+// binding for uint32_t arcmAudioUploadPCM(float* waveData, uint32_t numSamples, uint8_t numChannels, uint32_t offset)
 static JSValue js_ResourceCreateAudio(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
     float* alloc_data = NULL;
     size_t bufSz=0;
@@ -623,7 +872,7 @@ static JSValue js_ResourceCreateAudio(JSContext *ctx, JSValueConst this_val, int
         if (!alloc_data) return JS_ThrowOutOfMemory(ctx);
         memcpy(alloc_data, data, bufSz);
     }
-    size_t handle = AudioUploadPCM(alloc_data, numSamples, numChannels, 0);
+    size_t handle = arcmAudioUploadPCM(alloc_data, numSamples, numChannels, 0);
     return JS_NewUint32(ctx, (uint32_t)handle);
 }
 
@@ -634,11 +883,95 @@ static JSValue js_ResourceGetFont(JSContext *ctx, JSValueConst this_val, int arg
         if (name) JS_FreeCString(ctx, name);
         return JS_ThrowTypeError(ctx, "resource.getFont expects (string, uint32)");
     }
-    size_t handle = ResourceGetFont(name, fontSize);
+    size_t handle = arcmResourceGetFont(name, fontSize);
     JS_FreeCString(ctx, name);
     return JS_NewUint32(ctx, (uint32_t)handle);
 }
 
+static JSValue js_ResourceCreateAtlas(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    double scale, centerX, centerY; int filtering;
+    if (!JS_IsArray(ctx, argv[0]) || JS_ToFloat64Default(ctx, &scale, argv[1], 1.0)
+        || JS_ToFloat64Default(ctx, &centerX, argv[2], 0.0)
+        || JS_ToFloat64Default(ctx, &centerY, argv[3], 0.0)
+        || JS_ToInt32Default(ctx, &filtering, argv[4], 1))
+        return JS_ThrowTypeError(ctx, "resource.createAtlas expects (array[, number, number, number, int])");
+    const size_t len = getArrayLength(ctx, argv[0]);
+    const char** names = (const char**)calloc(len ? len : 1, sizeof(const char*));
+    uint32_t* handles = (uint32_t*)calloc(len ? len : 1, sizeof(uint32_t));
+    size_t numNames = 0;
+    for (; numNames < len; ++numNames) {
+        JSValue item = JS_GetPropertyUint32(ctx, argv[0], (uint32_t)numNames);
+        names[numNames] = JS_ToCString(ctx, item);
+        JS_FreeValue(ctx, item);
+        if (!names[numNames])
+            break;
+    }
+    JSValue arr = JS_EXCEPTION;
+    if (numNames == len) {
+        arcmResourceCreateAtlas(names, len, (float)scale, (float)centerX, (float)centerY, filtering, handles);
+        arr = JS_NewArray(ctx);
+        for (size_t i = 0; i < len; ++i)
+            JS_SetPropertyUint32(ctx, arr, (uint32_t)i, JS_NewUint32(ctx, handles[i]));
+    }
+    for (size_t i = 0; i < numNames; ++i)
+        JS_FreeCString(ctx, names[i]);
+    free(names);
+    free(handles);
+    return arr;
+}
+
+static JSValue load_progress_fn;
+
+static JSValue js_ResourceLoadAsync(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    const char* name = JS_ToCString(ctx, argv[0]);
+    double param, centerX, centerY; int filtering;
+    if (!name || JS_ToFloat64Default(ctx, &param, argv[1], 0.0)
+        || JS_ToFloat64Default(ctx, &centerX, argv[2], 0.0)
+        || JS_ToFloat64Default(ctx, &centerY, argv[3], 0.0)
+        || JS_ToInt32Default(ctx, &filtering, argv[4], 1)) {
+        if (name) JS_FreeCString(ctx, name);
+        return JS_ThrowTypeError(ctx, "resource.loadAsync expects (string[, number, number, number, int])");
+    }
+    uint32_t pending = arcmResourceLoadAsync(name, (float)param, (float)centerX, (float)centerY, filtering);
+    JS_FreeCString(ctx, name);
+    return JS_NewUint32(ctx, pending);
+}
+
+static JSValue js_ResourceLoad(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    if (!JS_IsArray(ctx, argv[0])
+        || (argc > 1 && !JS_IsUndefined(argv[1]) && !JS_IsFunction(ctx, argv[1])))
+        return JS_ThrowTypeError(ctx, "resource.load expects (array[, function])");
+    const size_t len = getArrayLength(ctx, argv[0]);
+    JSValue arr = JS_NewArray(ctx);
+    for (size_t i = 0; i < len; ++i) {
+        JSValue item = JS_GetPropertyUint32(ctx, argv[0], (uint32_t)i);
+        const char* name = JS_ToCString(ctx, item);
+        JS_FreeValue(ctx, item);
+        if (!name) {
+            JS_FreeValue(ctx, arr);
+            return JS_EXCEPTION;
+        }
+        JS_SetPropertyUint32(ctx, arr, (uint32_t)i, JS_NewUint32(ctx, arcmResourceLoadAsync(name, 0.0f, 0.0f, 0.0f, 1)));
+        JS_FreeCString(ctx, name);
+    }
+    if (argc > 1 && JS_IsFunction(ctx, argv[1])) {
+        JS_FreeValue(ctx, load_progress_fn);
+        load_progress_fn = JS_DupValue(ctx, argv[1]);
+    }
+    return arr;
+}
+
+static JSValue js_ResourceLoaded(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    uint32_t pending, handle;
+    if (JS_ToUint32(ctx, &pending, argv[0]))
+        return JS_ThrowTypeError(ctx, "resource.loaded expects (uint32)");
+    return arcmResourceLoaded(pending, &handle) ? JS_NewUint32(ctx, handle) : JS_UNDEFINED;
+}
+
+static JSValue js_ResourceLoadProgress(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return JS_NewFloat64(ctx, arcmResourceLoadProgress());
+}
+
 static JSValue js_ResourceQueryImage(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
     uint32_t image;
     const char* property = JS_ToCString(ctx, argv[1]);
@@ -699,26 +1032,51 @@ static JSValue js_ResourceGetStorageItem(JSContext *ctx, JSValueConst this_val,
     const char* key = JS_ToCString(ctx, argv[0]);
     if (!key)
         return JS_ThrowTypeError(ctx, "resource.getStorageItem expects string key");
-    const char* val = arcmResourceGetStorageItem(key);
+    size_t size;
+    bool isBinary;
+    const char* val = arcmResourceGetStorageValue(key, &size, &isBinary);
     JS_FreeCString(ctx, key);
     if (!val) return JS_NULL;
-    return JS_NewString(ctx, val);
+    if (isBinary)
+        return JS_NewArrayBufferCopy(ctx, (const uint8_t*)val, size);
+    return JS_NewStringLen(ctx, val, size);
 }
 
 static JSValue js_ResourceSetStorageItem(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
     const char* key = JS_ToCString(ctx, argv[0]);
-    const char* val = JS_ToCString(ctx, argv[1]);
-    if (!key || !val) {
-        if (key) JS_FreeCString(ctx, key);
-        if (val) JS_FreeCString(ctx, val);
-        return JS_ThrowTypeError(ctx, "resource.setStorageItem expects (string, string)");
+    if (!key)
+        return JS_ThrowTypeError(ctx, "resource.setStorageItem expects (string, string|ArrayBuffer|TypedArray)");
+    if (JS_IsNull(argv[1]) || JS_IsUndefined(argv[1])) {
+        arcmResourceSetStorageValue(key, NULL, 0, false);
+        JS_FreeCString(ctx, key);
+        return JS_UNDEFINED;
+    }
+    if (JS_IsObject(argv[1])) {
+        size_t size;
+        const uint8_t* data = qjs_get_bytes(ctx, argv[1], &size, NULL);
+        if (data) {
+            arcmResourceSetStorageValue(key, data, size, true);
+            JS_FreeCString(ctx, key);
+            return JS_UNDEFINED;
+        }
+        JS_FreeValue(ctx, JS_GetException(ctx)); // not a buffer, store as string
+    }
+    size_t size;
+    const char* val = JS_ToCStringLen(ctx, &size, argv[1]);
+    if (!val) {
+        JS_FreeCString(ctx, key);
+        return JS_ThrowTypeError(ctx, "resource.setStorageItem expects (string, string|ArrayBuffer|TypedArray)");
     }
-    arcmResourceSetStorageItem(key, val);
+    arcmResourceSetStorageValue(key, val, size, false);
     JS_FreeCString(ctx, key);
     JS_FreeCString(ctx, val);
     return JS_UNDEFINED;
 }
 
+static JSValue js_ResourceFlushStorage(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return JS_NewBool(ctx, arcmResourceFlushStorage());
+}
+
 static const JSCFunctionListEntry js_Resource_funcs[] = {
     JS_CFUNC_DEF("getImage", 5, js_ResourceGetImage),
     JS_CFUNC_DEF("createSVGImage", 4, js_ResourceCreateSVGImage),
@@ -728,11 +1086,17 @@ static const JSCFunctionListEntry js_Resource_funcs[] = {
     JS_CFUNC_DEF("getAudio", 1, js_ResourceGetAudio),
     JS_CFUNC_DEF("createAudio", 4, js_ResourceCreateAudio),
     JS_CFUNC_DEF("getFont", 2, js_ResourceGetFont),
+    JS_CFUNC_DEF("createAtlas", 5, js_ResourceCreateAtlas),
+    JS_CFUNC_DEF("loadAsync", 5, js_ResourceLoadAsync),
+    JS_CFUNC_DEF("load", 2, js_ResourceLoad),
+    JS_CFUNC_DEF("loaded", 1, js_ResourceLoaded),
+    JS_CFUNC_DEF("loadProgress", 0, js_ResourceLoadProgress),
     JS_CFUNC_DEF("queryImage", 2, js_ResourceQueryImage),
     JS_CFUNC_DEF("queryAudio", 2, js_ResourceQueryAudio),
     JS_CFUNC_DEF("queryFont", 3, js_ResourceQueryFont),
     JS_CFUNC_DEF("getStorageItem", 1, js_ResourceGetStorageItem),
     JS_CFUNC_DEF("setStorageItem", 2, js_ResourceSetStorageItem),
+    JS_CFUNC_DEF("flushStorage", 0, js_ResourceFlushStorage),
 };
 
 static void bindArcamini(JSContext *ctx) {
@@ -827,13 +1191,18 @@ void* initVM(const char* script, const char* scriptName) {
     }
     JS_SetModuleLoaderFunc(rt, NULL, js_module_loader, NULL);
     lifecycle_ns = JS_UNDEFINED; // static var has no compile-time-constant initializer available
+    load_progress_fn = JS_UNDEFINED;
+    for (int i = 0; i < LIFECYCLE_NUM; ++i)
+        lifecycle_fns[i] = JS_UNDEFINED;
+    str_axis = JS_NewAtomString(ctx, "axis");
+    str_button = JS_NewAtomString(ctx, "button");
 
     // Initialize our bindings
     bindArcamini(ctx);
     bindConsole(ctx);
 
     // Evaluate user script as an ES module (see loadLifecycleModule)
-    if (!loadLifecycleModule(ctx, script, strlen(script), scriptName)) {
+    if (!loadLifecycleModule(ctx, script, scriptName)) {
         JSValue exc = JS_GetException(ctx);
         js_print_exception(ctx, exc);
         JS_FreeValue(ctx, exc);
@@ -849,8 +1218,17 @@ void shutdownVM(void* context) {
     JSContext* ctx = (JSContext*)context;
     JSRuntime* rt = JS_GetRuntime(ctx);
     JS_FreeValue(ctx, gfx_ns);
+    for (int i = 0; i < LIFECYCLE_NUM; ++i) {
+        JS_FreeValue(ctx, lifecycle_fns[i]);
+        lifecycle_fns[i] = JS_UNDEFINED;
+    }
+    JS_FreeValue(ctx, str_axis);
+    JS_FreeValue(ctx, str_button);
+    JS_FreeValue(ctx, load_progress_fn);
+    load_progress_fn = JS_UNDEFINED;
     JS_FreeValue(ctx, lifecycle_ns);
     lifecycle_ns = JS_UNDEFINED;
+    arcmSceneCacheClear();
     JS_FreeContext(ctx);
     // module namespace objects and their closures form reference cycles
     // that plain refcounting can't collect on its own.
@@ -858,11 +1236,45 @@ void shutdownVM(void* context) {
     JS_FreeRuntime(rt);
 }
 
+bool compileScript(const char* scriptName, const char* fileName) {
+    char *script = arcmResourceGetText(scriptName);
+    if (!script) {
+        fprintf(stderr, "could not read script %s\n", scriptName);
+        return false;
+    }
+    JSRuntime* rt = JS_NewRuntime();
+    JS_SetStripInfo(rt, JS_STRIP_DEBUG);
+    JSContext* ctx = JS_NewContext(rt);
+    // compiling a module resolves its imports, which are compiled on their own
+    JS_SetModuleLoaderFunc(rt, NULL, js_module_loader, NULL);
+
+    bool ok = false;
+    JSValue compiled = JS_Eval(ctx, script, strlen(script), scriptName,
+        JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+    free(script);
+    if (JS_IsException(compiled)) {
+        JSValue exc = JS_GetException(ctx);
+        js_print_exception(ctx, exc);
+        JS_FreeValue(ctx, exc);
+    }
+    else {
+        size_t size;
+        uint8_t *buf = JS_WriteObject(ctx, &size, compiled, JS_WRITE_OBJ_BYTECODE);
+        ok = buf && arcmBytecodeShip(fileName, JS_BYTECODE_FORMAT, buf, size);
+        js_free(ctx, buf);
+        JS_FreeValue(ctx, compiled);
+    }
+    JS_FreeContext(ctx);
+    JS_RunGC(rt);
+    JS_FreeRuntime(rt);
+    return ok;
+}
+
 // --- event dispatchers ---
 
 bool dispatchLifecycleEvent(const char* evtName, void* callback) {
     JSContext *ctx = (JSContext*)callback;
-    JSValue fn = JS_GetPropertyStr(ctx, lifecycle_ns, evtName);
+    JSValue fn = lifecycleFunction(ctx, evtName);
     bool ok = true;
     if (JS_IsFunction(ctx, fn)) {
         JSValue ret = JS_Call(ctx, fn, JS_UNDEFINED, 0, NULL);
@@ -878,7 +1290,7 @@ bool dispatchLifecycleEvent(const char* evtName, void* callback) {
 
 bool dispatchLifecycleEventArgv(const char* evtName, int argc, char** argv, void* callback) {
     JSContext *ctx = (JSContext*)callback;
-    JSValue fn = JS_GetPropertyStr(ctx, lifecycle_ns, evtName);
+    JSValue fn = lifecycleFunction(ctx, evtName);
     bool ok = true;
     if (JS_IsFunction(ctx, fn)) {
         JSValue args_array = JS_NewArray(ctx);
@@ -897,57 +1309,90 @@ bool dispatchLifecycleEventArgv(const char* evtName, int argc, char** argv, void
     return ok;
 }
 
-void dispatchAxisEvent(size_t id, uint8_t axis, float value, void* callback) {
+void dispatchAxisEvent(size_t id, uint8_t axis, float value, double timestamp, void* callback) {
     JSContext *ctx = (JSContext*)callback;
-    JSValue fn = JS_GetPropertyStr(ctx, lifecycle_ns, "input");
+    JSValue fn = JS_DupValue(ctx, lifecycle_fns[LIFECYCLE_INPUT]);
     if (JS_IsFunction(ctx, fn)) {
-        JSValue evt = JS_NewString(ctx, "axis");
         JSValue device = JS_NewUint32(ctx, (uint32_t)id);
         JSValue id = JS_NewUint32(ctx, axis);
         JSValue val = JS_NewFloat64(ctx, value);
-        JSValue val2 = JS_UNDEFINED;
+        JSValue val2 = JS_NewFloat64(ctx, timestamp);
 
-        JSValue argv[5] = { evt, device, id, val, val2 };
+        JSValue argv[5] = { str_axis, device, id, val, val2 };
         JSValue ret = JS_Call(ctx, fn, JS_UNDEFINED, 5, argv);
         if (JS_IsException(ret))
             handleException(ctx);
         JS_FreeValue(ctx, ret);
-        JS_FreeValue(ctx, evt);
         JS_FreeValue(ctx, device);
         JS_FreeValue(ctx, id);
         JS_FreeValue(ctx, val);
+        JS_FreeValue(ctx, val2);
     }
     JS_FreeValue(ctx, fn);
 }
 
-void dispatchButtonEvent(size_t id, uint8_t button, float value, void* callback) {
+void dispatchButtonEvent(size_t id, uint8_t button, float value, double timestamp, void* callback) {
     JSContext *ctx = (JSContext*)callback;
-    arcmWindowCloseOnButton67(id, button, value);
-
-    JSValue fn = JS_GetPropertyStr(ctx, lifecycle_ns, "input");
+    JSValue fn = JS_DupValue(ctx, lifecycle_fns[LIFECYCLE_INPUT]);
     if (JS_IsFunction(ctx, fn)) {
-        JSValue evt = JS_NewString(ctx, "button");
         JSValue device = JS_NewUint32(ctx, (uint32_t)id);
         JSValue id = JS_NewUint32(ctx, button);
         JSValue val = JS_NewFloat64(ctx, value);
-        JSValue val2 = JS_UNDEFINED;
+        JSValue val2 = JS_NewFloat64(ctx, timestamp);
 
-        JSValue argv[5] = { evt, device, id, val, val2 };
+        JSValue argv[5] = { str_button, device, id, val, val2 };
         JSValue ret = JS_Call(ctx, fn, JS_UNDEFINED, 5, argv);
         if (JS_IsException(ret))
             handleException(ctx);
         JS_FreeValue(ctx, ret);
-        JS_FreeValue(ctx, evt);
         JS_FreeValue(ctx, device);
         JS_FreeValue(ctx, id);
         JS_FreeValue(ctx, val);
+        JS_FreeValue(ctx, val2);
     }
     JS_FreeValue(ctx, fn);
 }
 
+bool dispatchInputBatch(const double* events, size_t numEvents, void* callback) {
+    JSContext *ctx = (JSContext*)callback;
+    JSValue fn = JS_DupValue(ctx, lifecycle_fns[LIFECYCLE_INPUT_BATCH]);
+    if (!JS_IsFunction(ctx, fn)) {
+        JS_FreeValue(ctx, fn);
+        return false;
+    }
+    JSValue buf = JS_NewArrayBufferCopy(ctx, (const uint8_t*)events,
+        numEvents * ARCM_INPUT_EVENT_STRIDE * sizeof(double));
+    JSValue arr = JS_NewTypedArray(ctx, 1, &buf, JS_TYPED_ARRAY_FLOAT64);
+    JS_FreeValue(ctx, buf);
+    JSValue ret = JS_Call(ctx, fn, JS_UNDEFINED, 1, &arr);
+    if (JS_IsException(ret))
+        handleException(ctx);
+    JS_FreeValue(ctx, ret);
+    JS_FreeValue(ctx, arr);
+    JS_FreeValue(ctx, fn);
+    return true;
+}
+
+static void dispatchLoadProgress(JSContext *ctx) {
+    JSValue fn = load_progress_fn;
+    double progress = arcmResourceLoadProgress();
+    if (progress >= 1.0) // report completion once, then release the handler
+        load_progress_fn = JS_UNDEFINED;
+    else
+        fn = JS_DupValue(ctx, fn);
+    JSValue argv[1] = { JS_NewFloat64(ctx, progress) };
+    JSValue ret = JS_Call(ctx, fn, JS_UNDEFINED, 1, argv);
+    if (JS_IsException(ret))
+        handleException(ctx);
+    JS_FreeValue(ctx, ret);
+    JS_FreeValue(ctx, fn);
+}
+
 bool dispatchUpdateEvent(double deltaT, void* callback) {
     JSContext *ctx = (JSContext*)callback;
-    JSValue fn = JS_GetPropertyStr(ctx, lifecycle_ns, "update");
+    if (!JS_IsUndefined(load_progress_fn))
+        dispatchLoadProgress(ctx);
+    JSValue fn = JS_DupValue(ctx, lifecycle_fns[LIFECYCLE_UPDATE]);
     bool keepRunning = false;
     if (JS_IsFunction(ctx, fn)) {
         JSValue argv[1] = { JS_NewFloat64(ctx, deltaT) };
@@ -967,7 +1412,7 @@ bool dispatchUpdateEvent(double deltaT, void* callback) {
 
 void dispatchDrawEvent(void* callback) {
     JSContext *ctx = (JSContext*)callback;
-    JSValue fn = JS_GetPropertyStr(ctx, lifecycle_ns, "draw");
+    JSValue fn = JS_DupValue(ctx, lifecycle_fns[LIFECYCLE_DRAW]);
     if (JS_IsFunction(ctx, fn)) {
         JSValue argv[1] = { gfx_ns }; // pass gfx namespace as argument
         JSValue ret = JS_Call(ctx, fn, JS_UNDEFINED, 1, argv);
@@ -80,10 +80,18 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 	// keyboard input is silently ignored with no error at all.
 	const numControllers = 0;
 	const keyDeviceArrows = numControllers + 0, keyDeviceWasd = numControllers + 1;
-	const gamepadResolution = 0.1;
+	let gamepadResolution = 0.1, gamepadDeadzone = 0.0; // see window.axisFilter
 	let gamepadStates = [];
-	const btnState = {}; // per-device bitmask, for close-on-6+7 detection
+	// per-device button bitmasks and axis values, for window.inputState/pressed/released
+	// and close-on-6+7 detection; pressed and released are reset after each frame
+	const inputStates = [];
+	function inputStateOf(device) {
+		return inputStates[device] || (inputStates[device] = {buttons: 0, pressed: 0, released: 0, axes: []});
+	}
 	const storagePrefix = 'arcamini:' + location.pathname + ':';
+	// localStorage only holds strings: binary values are stored base64-encoded behind a
+	// type marker, which strings that happen to start with the marker character get as well
+	const storageMarker = '\u0001', storageBinary = storageMarker + 'b', storageString = storageMarker + 's';
 
 	function reportError(err) {
 		console.error(err);
@@ -111,6 +119,34 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 		clearColor[1] = ((color >>> 16) & 0xff) / 255;
 		clearColor[2] = ((color >>> 8) & 0xff) / 255;
 	};
+	window.axisFilter = function(resolution=0.1, deadzone=0.0) {
+		gamepadResolution = resolution > 0 ? resolution : 0;
+		gamepadDeadzone = deadzone < 0 ? 0 : deadzone < 1 ? deadzone : 0.99;
+	};
+	// no runtime statistics are collected here, so every name is unknown, which the
+	// native JS binding reports as undefined (arcmWindowStats' NaN never reaches scripts)
+	window.stats = function(name) { return undefined; };
+	window.inputState = function(device) {
+		const state = inputStates[device];
+		if(!state)
+			return new Float64Array(1);
+		const ret = new Float64Array(1 + state.axes.length);
+		ret[0] = state.buttons >>> 0;
+		state.axes.forEach((v, i)=>{ ret[1 + i] = v; });
+		return ret;
+	};
+	window.pressed = function(device, button) {
+		const state = inputStates[device];
+		return !!state && button < 32 && (state.pressed & (1 << button)) !== 0;
+	};
+	window.released = function(device, button) {
+		const state = inputStates[device];
+		return !!state && button < 32 && (state.released & (1 << button)) !== 0;
+	};
+	// warms the HTTP cache, so that loadScene's fetch of the script doesn't hit the network
+	window.preloadScene = function(script) {
+		fetch(script).catch(()=>{});
+	};
 	window.switchScene = function(script, ...args) {
 		// a scene that fails to load/enter is fatal, matching the native runtime
 		// (window.switchScene -> handleException -> WindowEmitClose -> leave() -> halt)
@@ -123,6 +159,13 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 			const track = arcamini.audio.replay(sample, volume, balance, detune);
 			return (track === undefined || track === 0xffffffff) ? undefined : track;
 		},
+		replayAt: function(sample, when, volume=1.0, balance=0.0, detune=0.0) {
+			const track = arcamini.audio.replayAt(sample, when, volume, balance, detune);
+			return track !== undefined && track !== 0xffffffff;
+		},
+		time: ()=>arcamini.audio.time(),
+		bufferSize: ()=>arcamini.audio.bufferSize(),
+		latency: ()=>arcamini.audio.latency(),
 		volume: function(track, volume, fadeTime=0.0) {
 			if(fadeTime <= 0.0) {
 				if(volume > 0.0)
@@ -134,15 +177,74 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 				arcamini.audio.fadeOut(track, fadeTime);
 			else // fade-in not supported, matches native arcmAudioVolume
 				arcamini.audio.volume(track, volume);
+		},
+		stream: function(name, volume=1.0, loop=false) {
+			const track = arcamini.audio.stream(name, volume, loop);
+			return track === 0xffffffff ? undefined : track;
 		}
 	};
 
 	//--- resource --------------------------------------------------------
+	// background loads of resource.loadAsync()/load(): per pending handle the resulting
+	// resource handle, 0 if loading failed, or undefined while it is still in progress.
+	// Unlike top-level getImage()/getAudio()/... calls, these don't hold enter() back.
+	const asyncLoads = [];
+	let asyncRequested = 0, asyncCompleted = 0, asyncProgressHandler = null;
+	function loadAsync(name, param=0.0, centerX=0.0, centerY=0.0, filtering=1) {
+		const suffix = name.substr(name.lastIndexOf('.') + 1).toLowerCase();
+		const isImage = ['png', 'jpg', 'jpeg', 'svg'].includes(suffix);
+		const isAudio = ['wav', 'mp3', 'ogg'].includes(suffix);
+		if(!isImage && !isAudio && suffix !== 'ttf')
+			return 0;
+		if(asyncCompleted === asyncRequested)
+			asyncCompleted = asyncRequested = 0;
+		++asyncRequested;
+		const pending = asyncLoads.push(undefined);
+		let handle = 0;
+		const complete = (ok)=>{
+			if(!ok)
+				console.error('loading resource "' + name + '" failed');
+			asyncLoads[pending - 1] = ok ? handle : 0;
+			++asyncCompleted;
+		};
+		if(isImage)
+			handle = gfxImpl.loadTexture(name, {scale: param || 1.0, centerX, centerY, filtering}, (tex)=>complete(tex && tex.ready));
+		else if(isAudio)
+			handle = arcamini.audio.load(name, undefined, (sample)=>complete(!!sample));
+		else
+			handle = gfxImpl.loadFont(name, {size: param || 16}, ()=>complete(gfxImpl.measureText(handle) !== null));
+		return pending;
+	}
+	function loadProgress() {
+		return asyncRequested ? asyncCompleted / asyncRequested : 1.0;
+	}
+	// called before each update(), until the handler has been handed 1.0
+	function dispatchLoadProgress() {
+		const handler = asyncProgressHandler, progress = loadProgress();
+		if(progress >= 1.0)
+			asyncProgressHandler = null;
+		handler(progress);
+	}
+
 	window.resource = {
+		loadAsync: loadAsync,
+		load: function(names, onProgress) {
+			const pending = names.map((name)=> loadAsync(String(name)));
+			if(typeof onProgress === 'function')
+				asyncProgressHandler = onProgress;
+			return pending;
+		},
+		loaded: function(pending) {
+			return (pending > 0 && pending <= asyncLoads.length) ? asyncLoads[pending - 1] : 0;
+		},
+		loadProgress: loadProgress,
 		getImage: function(name, scale=1.0, centerX=0.0, centerY=0.0, filtering=1) {
 			return gfxImpl.loadTexture(name, {scale, centerX, centerY, filtering}, trackLoad());
 		},
 		createImage: function(data, width, height, centerX=0.0, centerY=0.0, filtering=1) {
+			const numItems = data instanceof ArrayBuffer ? data.byteLength / 4 : data.length;
+			if(!(width > 0 && height > 0 && width * height <= numItems))
+				throw new RangeError('resource.createImage expects positive width and height, and their product must not exceed the number of color values');
 			return gfxImpl.createTexture(width, height, data, {centerX, centerY, filtering});
 		},
 		createSVGImage: function(svg, scale=1.0, centerX=0.0, centerY=0.0) {
@@ -151,6 +253,10 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 			const blob = new Blob([svg], {type: 'image/svg+xml'});
 			return gfxImpl.loadTexture(URL.createObjectURL(blob), {scale, centerX, centerY}, trackLoad());
 		},
+		// one texture per image: the handles behave like atlas images, just without sharing a texture
+		createAtlas: function(names, scale=1.0, centerX=0.0, centerY=0.0, filtering=1) {
+			return names.map((name)=> gfxImpl.loadTexture(String(name), {scale, centerX, centerY, filtering}, trackLoad()));
+		},
 		getTileImage: function(parent, x, y, w, h, centerX=0.0, centerY=0.0) {
 			return gfxImpl.createTileTexture(parent, x, y, w, h, {centerX, centerY}, trackLoad());
 		},
@@ -196,10 +302,36 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 		},
 		getStorageItem: function(key) {
 			const v = localStorage.getItem(storagePrefix + key);
-			return v === null ? null : v;
+			if(v === null || v[0] !== storageMarker)
+				return v;
+			if(!v.startsWith(storageBinary))
+				return v.substr(storageString.length);
+			const bin = atob(v.substr(storageBinary.length));
+			const bytes = new Uint8Array(bin.length);
+			for(let i=0; i<bin.length; ++i)
+				bytes[i] = bin.charCodeAt(i);
+			return bytes.buffer;
 		},
 		setStorageItem: function(key, value) {
-			localStorage.setItem(storagePrefix + key, String(value));
+			if(value === null || value === undefined)
+				return localStorage.removeItem(storagePrefix + key);
+			const bytes = (value instanceof ArrayBuffer) ? new Uint8Array(value)
+				: ArrayBuffer.isView(value) ? new Uint8Array(value.buffer, value.byteOffset, value.byteLength) : null;
+			if(bytes) {
+				let bin = '';
+				for(let i=0; i<bytes.length; ++i)
+					bin += String.fromCharCode(bytes[i]);
+				value = storageBinary + btoa(bin);
+			}
+			else {
+				value = String(value);
+				if(value[0] === storageMarker)
+					value = storageString + value;
+			}
+			localStorage.setItem(storagePrefix + key, value);
+		},
+		flushStorage: function() { // localStorage writes are synchronous already
+			return true;
 		}
 	};
 
@@ -255,6 +387,12 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 			if(typeof jsModule.input === 'function')
 				jsModule.input(evt, dev, id, val, val2);
 		},
+		hasInputBatch: function() {
+			return typeof jsModule.inputBatch === 'function';
+		},
+		callInputBatch: function(events) {
+			jsModule.inputBatch(events);
+		},
 		callUpdate: function(dt) {
 			// no update() defined -> stop, matching the native runtime
 			// (dispatchUpdateEvent defaults to false when update isn't a function)
@@ -332,6 +470,9 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 				const fn = (evt === 'axis') ? 'dispatchAxisEvent' : 'dispatchButtonEvent';
 				Module.ccall(fn, null, ['number', 'number', 'number', 'number'], [dev, id, val, vm]);
 			},
+			// the WASM dispatchers predate inputBatch(events), so these scenes get input() only
+			hasInputBatch: function() { return false; },
+			callInputBatch: function(events) {},
 			callUpdate: function(dt) {
 				return Module.ccall('dispatchUpdateEvent', 'boolean', ['number', 'number'], [dt, vm]);
 			},
@@ -378,38 +519,67 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 			return new Promise((resolve)=>{ waitForResources(resolve); });
 		}).then(()=>{
 			currentDriver = driver;
+			inputBatch.length = 0;
 			driver.callEnter(args);
 		});
 	}
 
 	//--- input dispatch ------------------------------------------------
-	function checkCloseButtons(device, button, value) {
-		if(button > 15)
+	function updateButtonState(device, button, value) {
+		if(button > 31)
 			return;
-		let mask = btnState[device] || 0;
-		if(value !== 0)
-			mask |= (1 << button);
-		else
-			mask &= ~(1 << button);
-		btnState[device] = mask;
-		if((mask & (1 << 6)) && (mask & (1 << 7)))
+		const state = inputStateOf(device), bit = 1 << button;
+		if(value !== 0) {
+			if(!(state.buttons & bit))
+				state.pressed |= bit;
+			state.buttons |= bit;
+		}
+		else {
+			if(state.buttons & bit)
+				state.released |= bit;
+			state.buttons &= ~bit;
+		}
+		if((state.buttons & (1 << 6)) && (state.buttons & (1 << 7)))
 			stopApp();
 	}
+	function clearPressedReleased() {
+		for(const state of inputStates)
+			if(state)
+				state.pressed = state.released = 0;
+	}
+
+	// events queued for a scene's inputBatch(events) handler, flushed once per frame
+	// as 5 values per event: type (0 for axis, 1 for button), device, id, value, timestamp
+	// timestamps are performance.now() in seconds, the native runtime counts them since startup
+	const inputBatch = [];
+	function flushInputBatch() {
+		if(!inputBatch.length)
+			return;
+		const events = new Float64Array(inputBatch);
+		inputBatch.length = 0;
+		try { currentDriver.callInputBatch(events); }
+		catch(err) { reportError(err); stopApp(); }
+	}
 
 	// any lifecycle callback exception is fatal in the native runtime (handleException
 	// -> WindowEmitClose -> the loop stops and leave() runs); input() is no exception
-	function dispatchButtonEvent(device, button, value) {
-		checkCloseButtons(device, button, value);
-		if(currentDriver) {
-			try { currentDriver.callInput('button', device, button, value, undefined); }
-			catch(err) { reportError(err); stopApp(); }
+	function dispatchInputEvent(evt, device, id, value) {
+		if(!currentDriver)
+			return;
+		if(currentDriver.hasInputBatch()) {
+			inputBatch.push(evt === 'axis' ? 0 : 1, device, id, value, performance.now() * 0.001);
+			return;
 		}
+		try { currentDriver.callInput(evt, device, id, value, undefined); }
+		catch(err) { reportError(err); stopApp(); }
+	}
+	function dispatchButtonEvent(device, button, value) {
+		updateButtonState(device, button, value);
+		dispatchInputEvent('button', device, button, value);
 	}
 	function dispatchAxisEvent(device, axis, value) {
-		if(currentDriver) {
-			try { currentDriver.callInput('axis', device, axis, value, undefined); }
-			catch(err) { reportError(err); stopApp(); }
-		}
+		inputStateOf(device).axes[axis] = value;
+		dispatchInputEvent('axis', device, axis, value);
 	}
 
 	function handleKey(code, down) {
@@ -465,6 +635,7 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 					axes: pad.axes.map(()=>0),
 					buttons: pad.buttons.map(()=>false)
 				};
+				inputStateOf(index).axes = pad.axes.map(()=>0);
 				continue;
 			}
 			for(let i=0; i<pad.buttons.length; ++i) {
@@ -476,9 +647,12 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 			}
 			for(let i=0; i<pad.axes.length; ++i) {
 				let v = pad.axes[i];
+				if(gamepadDeadzone > 0) // rescale the remaining range, matching native
+					v = Math.abs(v) <= gamepadDeadzone ? 0 : (v - Math.sign(v) * gamepadDeadzone) / (1 - gamepadDeadzone);
 				if(Math.abs(v) < gamepadResolution)
 					v = 0;
-				if(Math.round(v/gamepadResolution) !== Math.round(state.axes[i]/gamepadResolution)) {
+				if(gamepadResolution > 0 ? Math.round(v/gamepadResolution) !== Math.round(state.axes[i]/gamepadResolution)
+					: v !== state.axes[i]) {
 					state.axes[i] = v;
 					dispatchAxisEvent(index, i, v);
 				}
@@ -524,10 +698,17 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 		tLastFrame = now;
 
 		pollGamepads();
+		flushInputBatch();
+		if(!running)
+			return;
 		adjustCanvasSize();
 
 		let keepRunning = false;
-		try { keepRunning = currentDriver.callUpdate(deltaT); }
+		try {
+			if(asyncProgressHandler)
+				dispatchLoadProgress();
+			keepRunning = currentDriver.callUpdate(deltaT);
+		}
 		catch(err) { reportError(err); keepRunning = false; }
 		if(!keepRunning) {
 			stopApp();
@@ -539,6 +720,7 @@ let app = arcamini.app = (function(canvas_id='arcamini_canvas') {
 		try { currentDriver.callDraw(); }
 		catch(err) { reportError(err); drawFailed = true; }
 		gfxImpl._frameEnd();
+		clearPressedReleased();
 		if(drawFailed) {
 			stopApp();
 			return;
@@ -104,6 +104,9 @@ return {
 		return sample.id;
 	},
 	replay: function(id, gain=1.0, pan=0, detune=0) {
+		return this.replayAt(id, 0, gain, pan, detune);
+	},
+	replayAt: function(id, when, gain=1.0, pan=0, detune=0) {
 		if(id===0 || id>samples.length)
 			return;
 		const sample = samples[id-1];
@@ -118,10 +121,44 @@ return {
 			source.playbackRate.value = Math.pow(2, detune/12);
 		source.buffer = sample.buffer;
 		tracks[trackId] = { src:source, gain:connectSource(source, gain, pan) };
-		source.start(audioCtx.currentTime, sample.offset || 0);
+		source.start(Math.max(when, audioCtx.currentTime), sample.offset || 0);
 		source.addEventListener('ended', ()=>{ tracks[trackId]=null; })
 		return trackId;
 	},
+	time: function() {
+		return audioCtx.currentTime;
+	},
+	latency: function() {
+		return audioCtx.baseLatency || 0;
+	},
+	bufferSize: function() {
+		return Math.round((audioCtx.baseLatency || 0) * audioCtx.sampleRate);
+	},
+	stream: function(url, gain=1.0, loop=false) {
+		let trackId = findAvailableTrack();
+		if(trackId === numTracksMax)
+			return 0xffffffff;
+
+		// media elements decode progressively, stopping them releases the track like a buffer source
+		let element = new Audio(url);
+		element.loop = loop;
+		let track = { gain:connectSource(audioCtx.createMediaElementSource(element), gain, 0) };
+		const release = ()=>{
+			element.pause();
+			if(tracks[trackId]===track)
+				tracks[trackId] = null;
+		};
+		track.src = { stop: (when)=>{
+			if(when===undefined)
+				release();
+			else
+				setTimeout(release, Math.max(0, when-audioCtx.currentTime)*1000);
+		} };
+		tracks[trackId] = track;
+		element.addEventListener('ended', release);
+		element.play().catch((error)=>{ console.error('stream error', url, error); release(); });
+		return trackId;
+	},
 	stop: function(track) {
 		const tr = tracks[track];
 		if(!tr)
@@ -121,47 +121,64 @@ void gfxDrawBatch(const uint8_t* ops, uint32_t ops_len, const char* strings, uin
 // Callback types
 typedef bool (*am_update_cb_t)(double dt);
 typedef void (*am_draw_cb_t)();
-typedef void (*am_input_cb_t)(const char* evt, int device, int id, float value, float value2);
+typedef void (*am_input_cb_t)(const char* evt, int device, int id, float value, double value2);
+typedef bool (*am_input_batch_cb_t)(const double* events, int numEvents);
 
 // Globals for callbacks
 static am_update_cb_t g_update = NULL;
 static am_draw_cb_t   g_draw   = NULL;
 static am_input_cb_t  g_input  = NULL;
+static am_input_batch_cb_t g_input_batch = NULL;
 
 // global variables
 bool isRunning = true;
 int debug = 0;
 
-bool arcamini_init(int winSzX, int winSzY, bool fullscreen, const char* archiveName, const char* scriptBaseName) {
+bool arcamini_init(int winSzX, int winSzY, bool fullscreen, const char* archiveName, const char* scriptName) {
     if(debug)
         printf("arcamini_init(width=%d, height=%d, fullscreen=%s, archiveName=%s)\n", winSzX, winSzY, fullscreen ? "true" : "false", archiveName);
 
-    if(!ResourceArchiveOpen(archiveName)) {
+    // directories are mapped in addition to arcajs reading them, packs are read by arcamini only
+    const bool mapped = arcmArchiveOpen(archiveName);
+    if(!(mapped && arcmArchivePacked()) && !ResourceArchiveOpen(archiveName)) {
         fprintf(stderr, "Opening archive \"%s\" failed.\n", archiveName);
         return false;
     }
 
-    srand(time(NULL));
-    AudioOpen(44100, 8);
-	AudioSetVolume(0.5);
-
+    // the manifest configures window and audio unless sizes are passed
+    arcmManifestOpen(scriptName);
+    if(winSzX <= 0)
+        winSzX = arcmManifestInt("window_width", 640);
+    if(winSzY <= 0)
+        winSzY = arcmManifestInt("window_height", 480);
     int windowFlags = WINDOW_VSYNC;
-    if (fullscreen)
+    if (fullscreen || strcmp(arcmManifestString("display", ""), "fullscreen")==0)
         windowFlags |= WINDOW_FULLSCREEN;
+
+    // audio and storage are set up on worker threads while the window opens
+    char* scriptBaseName = ResourceBaseName(scriptName);
+    for(char* pch = scriptBaseName; *pch; ++pch)
+        if(*pch=='_')
+            *pch=' ';
+    srand(time(NULL));
+    arcmStartupBegin("arcapy", scriptBaseName, NULL, NULL, arcmManifestInt("audio_tracks", 8));
     if(WindowOpen(winSzX, winSzY, windowFlags)!=0) {
         fprintf(stderr, "Setting video mode failed.\n");
+        arcmStartupJoin(NULL);
+        free(scriptBaseName);
         return false;
     }
     winSzX = WindowWidth();
     winSzY = WindowHeight();
     gfxInit(winSzX, winSzY, 1, WindowRenderer());
     WindowTitle(scriptBaseName);
+    free(scriptBaseName);
     WindowShowPointer(0);
+    arcmStartupJoin(NULL);
+    if(!arcmManifestPreload())
+        WindowClose();
 
-    arcmStorageInit("arcapy", scriptBaseName);
-
-    for(size_t i=0; i<WindowNumControllers(); ++i)
-        WindowControllerOpen(i, 0);
+    // controllers are opened on first use when input is polled, as they get connected
     WindowEventHandler(arcmDispatchInputEvents, NULL);
     return true;
 }
@@ -174,7 +191,14 @@ void arcamini_shutdown() {
     gfxClose();
     if(WindowIsOpen())
         WindowClose();
+    arcmAudioStreamClose();
+    arcmSynthCacheClose();
     AudioClose();
+    arcmResourceLoaderClose();
+    arcmManifestClose();
+    arcmSVGCacheClose();
+    arcmAudioCacheClose();
+    arcmArchiveClose();
     ResourceArchiveClose();
     if(debug)
         printf("done.\n");
@@ -186,6 +210,10 @@ void arcamini_set_callbacks(am_input_cb_t input_cb, am_update_cb_t update_cb, am
     g_draw = draw_cb;
 }
 
+void arcamini_set_input_batch_callback(am_input_batch_cb_t input_batch_cb) {
+    g_input_batch = input_batch_cb;
+}
+
 // main loop
 void arcamini_run(void) {
 
@@ -196,7 +224,8 @@ void arcamini_run(void) {
 
     isRunning = true;
     while (isRunning && WindowIsOpen()) {
-        if (!g_update(WindowDeltaT()))
+        arcmResourceUploadPending();
+        if (!arcmWindowLatchInput(NULL) || !g_update(WindowDeltaT()))
             break;
 
         gfxBeginFrame(WindowGetClearColor());
@@ -216,19 +245,23 @@ uint32_t arcamini_createAudio(float* waveData, uint32_t numSamples, uint8_t numC
         return 0;
     }
     memcpy(waveDataCopy, waveData, numSamples * numChannels * sizeof(float));
-    return AudioUploadPCM(waveDataCopy, numSamples, numChannels, 0);
+    return arcmAudioUploadPCM(waveDataCopy, numSamples, numChannels, 0);
 }
 
 
-void dispatchAxisEvent(size_t id, uint8_t axis, float value, void* callback) {
+void dispatchAxisEvent(size_t id, uint8_t axis, float value, double timestamp, void* callback) {
 	(void)callback;
     if (g_input)
-        g_input("axis", id, axis, value, 0.0f);
+        g_input("axis", id, axis, value, timestamp);
 }
 
-void dispatchButtonEvent(size_t id, uint8_t button, float value, void* callback) {
+void dispatchButtonEvent(size_t id, uint8_t button, float value, double timestamp, void* callback) {
 	(void)callback;
-	arcmWindowCloseOnButton67(id, button, value);
     if (g_input)
-        g_input("button", id, button, value, 0.0f);
+        g_input("button", id, button, value, timestamp);
+}
+
+bool dispatchInputBatch(const double* events, size_t numEvents, void* callback) {
+	(void)callback;
+    return g_input_batch && g_input_batch(events, (int)numEvents);
 }
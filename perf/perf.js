@@ -10,24 +10,38 @@ function randi(lo, hi) {
 
 var counter = 0, frames=0;
 var fps = '', now=0;
-const sprites = resource.getTileGrid(resource.getImage('flags.png', 1, 0.5, 0.5), 6,5,2);
+const NUM_IMAGES = 30;
+const tileGrid = resource.getTileGrid(resource.getImage('flags.png', 1, 0.5, 0.5), 6,5,2);
+// image variants switchable by left/right: tiles of a single image, separate images, and an atlas of the latter
+const imageModes = [ 'tile grid', 'separate images', 'atlas' ];
+const imageSets = [ Array.from({ length:NUM_IMAGES }, (_, i) => tileGrid + i) ];
+const imageNames = Array.from({ length:NUM_IMAGES }, (_, i) => 'flags/flag' + String(i).padStart(2, '0') + '.png');
+var imageMode = 0, sprites = imageSets[0];
+
+function switchImageMode(mode) {
+	imageMode = (mode + imageModes.length) % imageModes.length;
+	if(!imageSets[imageMode])
+		imageSets[imageMode] = (imageMode == 1) ? imageNames.map((name) => resource.getImage(name, 1, 0.5, 0.5))
+			: resource.createAtlas(imageNames, 1, 0.5, 0.5);
+	sprites = imageSets[imageMode];
+}
 
 const LINE_SIZE = 24;
 
 function Sprite(seed, winSzX, winSzY, szMin, szMax) {
 	const type = seed%3;
 	if(type==0) { // circle
-		this.image = sprites + 29
+		this.image = 29;
 		this.color = randi(63,0xFFffFFff);
 		this.rot = this.velRot = 0;
 	}
 	else if(type==1) { // rect
-		this.image = sprites + 28;
+		this.image = 28;
 		this.color = randi(63,0xFFffFFff);
 		this.rot = this.velRot = 0;
 	}
 	else if(type==2) { // img
-		this.image = sprites + Math.floor(seed/3)%28;
+		this.image = Math.floor(seed/3)%28;
 		this.color = 0xFFffFFff;
 		this.rot = Math.random()*Math.PI*2;
 		this.velRot = Math.random()*Math.PI - Math.PI*0.5;
@@ -40,7 +54,7 @@ function Sprite(seed, winSzX, winSzY, szMin, szMax) {
 
 	this.draw = function(gfx) {
 		gfx.color(this.color);
-		gfx.drawImage(this.image, this.x, this.y, this.rot);
+		gfx.drawImage(sprites[this.image], this.x, this.y, this.rot);
 
 	}
 }
@@ -74,6 +88,8 @@ export function input(evt,device,id,value,value2) {
 		}
 		prevAxisY = value;
 	}
+	else if (evt === 'axis' && id === 0 && (value === -1.0 || value === 1.0))
+		switchImageMode(imageMode + value);
 }
 
 export function update(deltaT) {
@@ -121,7 +137,7 @@ export function draw(gfx) {
 	gfx.color(0x7f);
 	gfx.fillRect(0, window.height()-LINE_SIZE-2, window.width(), LINE_SIZE+2);
 	gfx.color(0xFFffFFff);
-	gfx.fillText(0, 0,window.height()-20, "arcaqjs graphics performance test");
+	gfx.fillText(0, 0,window.height()-20, "arcaqjs graphics performance test, " + imageModes[imageMode]);
 	gfx.color(0xFF5555FF);
 	gfx.fillText(0, window.width()-60, window.height()-20, fps);
 }
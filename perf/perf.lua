@@ -20,7 +20,36 @@ local function randi(lo, hi)
 end
 
 -- load image and quads
-local sprites = resource.getTileGrid(resource.getImage('flags.png', 1, 0.5, 0.5), 6,5,2)
+local NUM_IMAGES = 30
+local tileGrid = resource.getTileGrid(resource.getImage('flags.png', 1, 0.5, 0.5), 6,5,2)
+-- image variants switchable by left/right: tiles of a single image, separate images, and an atlas of the latter
+local imageModes = { 'tile grid', 'separate images', 'atlas' }
+local imageSets = { {} }
+local imageNames = {}
+for i=0,NUM_IMAGES-1 do
+    imageSets[1][i] = tileGrid + i
+    imageNames[i+1] = string.format('flags/flag%02d.png', i)
+end
+local imageMode = 1
+local sprites = imageSets[1]
+
+local function switchImageMode(mode)
+    imageMode = (mode - 1) % #imageModes + 1
+    if not imageSets[imageMode] then
+        local images = {}
+        if imageMode == 2 then
+            for i,name in ipairs(imageNames) do
+                images[i-1] = resource.getImage(name, 1, 0.5, 0.5)
+            end
+        else
+            for i,handle in ipairs(resource.createAtlas(imageNames, 1, 0.5, 0.5)) do
+                images[i-1] = handle
+            end
+        end
+        imageSets[imageMode] = images
+    end
+    sprites = imageSets[imageMode]
+end
 
 -- Sprite class
 local Sprite = {}
@@ -31,17 +60,17 @@ function Sprite:new(seed, winW, winH, szMin, szMax)
     local type_ = seed % 3
 
     if type_ == 0 then -- circle (quad index 29)
-        self.image = sprites + 29
+        self.image = 29
         self.color = randi(63,0xFFffFFff)
         self.rot = 0
         self.velRot = 0
     elseif type_ == 1 then -- rect (quad index 28)
-        self.image = sprites + 28
+        self.image = 28
         self.color = randi(63,0xFFffFFff)
         self.rot = 0
         self.velRot = 0
     else -- image
-        self.image = sprites + (math.floor(seed/3) % 28)
+        self.image = math.floor(seed/3) % 28
         self.color = 0xFFffFFff
         self.rot = math.random() * math.pi * 2
         self.velRot = math.random() * math.pi - math.pi*0.5
@@ -58,7 +87,7 @@ end
 
 function Sprite:draw(gfx)
     gfx.color(self.color)
-    gfx.drawImage(self.image, self.x, self.y, self.rot)
+    gfx.drawImage(sprites[self.image], self.x, self.y, self.rot)
 end
 
 -- adjust object count
@@ -89,6 +118,8 @@ function input(evt,device,id,value,value2)
 			end
 		end
 		prevAxisY = value
+	elseif evt == 'axis' and id == 0 and (value == -1.0 or value == 1.0) then
+		switchImageMode(imageMode + math.floor(value))
 	end
 end
 
@@ -154,7 +185,7 @@ function draw(gfx)
     gfx.fillRect(0, winH - LINE_SIZE - 2, winW, LINE_SIZE + 2)
 
     gfx.color(0xFFFFFFFF)
-    gfx.fillText(0, 0, winH - 20, "arcalua graphics performance test")
+    gfx.fillText(0, 0, winH - 20, "arcalua graphics performance test, " .. imageModes[imageMode])
 
     gfx.color(0xFF5555FF)
     gfx.fillText(0, winW - 60, winH - 20, fps)
@@ -15,7 +15,24 @@ frames = 0
 fps = ''
 now = 0
 
-sprites = resource.getTileGrid(resource.getImage('flags.png', 1, 0.5, 0.5), 6, 5, 2)
+NUM_IMAGES = 30
+tileGrid = resource.getTileGrid(resource.getImage('flags.png', 1, 0.5, 0.5), 6, 5, 2)
+# image variants switchable by left/right: tiles of a single image, separate images, and an atlas of the latter
+imageModes = ['tile grid', 'separate images', 'atlas']
+imageSets = [[tileGrid + i for i in range(NUM_IMAGES)], None, None]
+imageNames = ['flags/flag%02d.png' % i for i in range(NUM_IMAGES)]
+imageMode = 0
+sprites = imageSets[0]
+
+def switchImageMode(mode):
+    global imageMode, sprites
+    imageMode = mode % len(imageModes)
+    if imageSets[imageMode] is None:
+        if imageMode == 1:
+            imageSets[imageMode] = [resource.getImage(name, 1, 0.5, 0.5) for name in imageNames]
+        else:
+            imageSets[imageMode] = resource.createAtlas(imageNames, 1, 0.5, 0.5)
+    sprites = imageSets[imageMode]
 
 LINE_SIZE = 24
 
@@ -23,17 +40,17 @@ class Sprite:
     def __init__(self, seed, winSzX, winSzY, szMin, szMax):
         type_ = seed % 3
         if type_ == 0:  # circle
-            self.image = sprites + 29
+            self.image = 29
             self.color = randi(63, 0xFFFFFFFF)
             self.rot = 0
             self.velRot = 0
         elif type_ == 1:  # rect
-            self.image = sprites + 28
+            self.image = 28
             self.color = randi(63, 0xFFFFFFFF)
             self.rot = 0
             self.velRot = 0
         elif type_ == 2:  # img
-            self.image = sprites + ((seed // 3) % 28)
+            self.image = (seed // 3) % 28
             self.color = 0xFFFFFFFF
             self.rot = random.random() * math.pi * 2
             self.velRot = random.random() * math.pi - math.pi * 0.5
@@ -46,7 +63,7 @@ class Sprite:
 
     def draw(self, gfx):
         gfx.color(self.color)
-        gfx.drawImage(self.image, self.x, self.y, self.rot)
+        gfx.drawImage(sprites[self.image], self.x, self.y, self.rot)
 
 objs = []
 
@@ -71,6 +88,8 @@ def input(evt,device,id,value,value2):
                         adjustNumObj(objCounts[i+1])
                         break
         prevAxisY = value
+    elif evt == 'axis' and id == 0 and value in (-1.0, 1.0):
+        switchImageMode(imageMode + int(value))
 
 def update(deltaT):
     global now, counter, frames, fps
@@ -114,7 +133,7 @@ def draw(gfx):
     gfx.color(0x7f)
     gfx.fillRect(0, window.height() - LINE_SIZE - 2, window.width(), LINE_SIZE + 2)
     gfx.color(0xFFFFFFFF)
-    gfx.fillText(0, 0, window.height() - 20, "arcapy graphics performance test")
+    gfx.fillText(0, 0, window.height() - 20, "arcapy graphics performance test, " + imageModes[imageMode])
     gfx.color(0xFF5555FF)
     gfx.fillText(0, window.width() - 60, window.height() - 20, fps)
 
@@ -375,9 +375,9 @@ static bool py_ResourceCreateImage(int argc, py_StackRef argv) {
         free(data);
         return false;
     }
-    if(width*height < numItems) {
+    if(width <= 0 || height <= 0 || width > INT32_MAX || height > INT32_MAX || (uint64_t)width*(uint64_t)height > numItems) {
         free(data);
-        return ValueError("resource.createImage() argument 1 expects width*height >= %zu\n", numItems);
+        return ValueError("resource.createImage() expects positive width and height with width*height <= %i\n", (int64_t)numItems);
     }
     if(argc > 3 && !py_castfloat32(py_arg(3), &centerX)) {
         free(data);
@@ -1,7 +1,14 @@
 let img = resource.getImage("test.png");
 let rings = resource.getTileGrid(resource.getImage("rings.svg", 1.0, 0.5, 0.5), 5);
+console.log("svg cached:", resource.getImage("rings.svg", 2.0) === resource.getImage("rings.svg", 2.0));
+console.log("atlas images:", resource.createAtlas(["test.png", "rings.svg"], 1.0, 0.5, 0.5));
 let font = resource.getFont("Viafont.ttf", 32);
 let sample = resource.getAudio("ding.wav");
+const pending = resource.load(["test.png", "rings.svg", "ding.wav"], (progress) => {
+    console.log("load progress:", progress);
+    if (progress >= 1.0)
+        console.log("loaded:", pending.map((p) => resource.loaded(p)));
+});
 function createBeep(freq, dur, vol = 1.0) {
     let data = [];
     for (let n = 0; n < Math.floor(44100 * dur); n++) {
@@ -13,7 +20,9 @@ let tone880 = createBeep(880, 1.0);
 
 resource.setStorageItem("key", "value");
 let val = resource.getStorageItem("key");
-console.log("Storage value:", val);
+console.log("Storage value:", val, "flushed:", resource.flushStorage());
+resource.setStorageItem("binary", new Uint8Array([0, 1, 2, 255]));
+console.log("Binary storage value:", new Uint8Array(resource.getStorageItem("binary")));
 
 let frame = 0;
 
@@ -21,9 +30,15 @@ export function enter(args) {
     console.log("enter called, args:", args);
     console.log("window dimensions:", window.width(), window.height());
     window.color(0x000055ff);
+    window.axisFilter(0.1, 0.15);
     audio.replay(sample, 1, 0.5);
     let track = audio.replay(tone880, 0.5, -0.5);
     audio.volume(track, 0.0, 1.0); // fade out over 1 second
+    let music = audio.stream("ding.wav", 0.5, true);
+    audio.volume(music, 0.0, 2.0); // looped stream, fades out over 2 seconds
+    console.log("audio buffer/latency:", audio.bufferSize(), audio.latency());
+    for (let beat = 1; beat <= 3; ++beat) // exactly half a second apart on the audio clock
+        audio.replayAt(sample, audio.time() + 0.1 + beat * 0.5, 0.5);
 
     console.log("query image w/h:", resource.queryImage(img, "width"), resource.queryImage(img, "height"));
     try {
@@ -32,6 +47,12 @@ export function enter(args) {
     } catch(e) {
         console.log("query image invalid handle correctly threw:", e.message);
     }
+    try {
+        resource.createImage(new Uint32Array(4), 4, 4);
+        console.log("create image short buffer: BUG - did not throw");
+    } catch(e) {
+        console.log("create image short buffer correctly threw:", e.message);
+    }
     console.log("query audio channels/frames/sampleRate:", resource.queryAudio(sample, "channels"), resource.queryAudio(sample, "frames"), resource.queryAudio(sample, "sampleRate"));
     console.log("query font w/h/ascent/descent:", resource.queryFont(font, "width", "Hello"), resource.queryFont(font, "height", "Hello"), resource.queryFont(font, "ascent", "Hello"), resource.queryFont(font, "descent", "Hello"));
     console.log("query font default str:", resource.queryFont(font, "width"));
@@ -44,6 +65,7 @@ export function input(evt, device, id, value, value2) {
 export function update(deltaT) {
     if (frame < 2) {
         console.log(`update called with deltaT ${deltaT} at frame ${frame}`);
+        console.log("input state:", Array.from(window.inputState(0)), "pressed:", window.pressed(0, 0), "released:", window.released(0, 0));
     }
     return true;
 }
@@ -74,5 +96,5 @@ export function draw(gfx) {
 }
 
 export function leave() {
-    console.log("leave called");
+    console.log("leave called, coalesced axis events:", window.stats("inputCoalesced"));
 }
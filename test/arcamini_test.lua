@@ -1,7 +1,19 @@
 img = resource.getImage("test.png")
 rings = resource.getTileGrid(resource.getImage("rings.svg", 1.0, 0.5, 0.5), 5)
+print("svg cached:", resource.getImage("rings.svg", 2.0) == resource.getImage("rings.svg", 2.0))
+if resource.createAtlas then -- native runtimes
+    print("atlas images:", table.unpack(resource.createAtlas({"test.png", "rings.svg"}, 1.0, 0.5, 0.5)))
+end
 font = resource.getFont("Viafont.ttf", 32)
 sample = resource.getAudio("ding.wav")
+if resource.load then -- native runtimes
+    pending = resource.load({"test.png", "rings.svg", "ding.wav"}, function(progress)
+        print("load progress:", progress)
+        if progress >= 1.0 then
+            print("loaded:", resource.loaded(pending[1]), resource.loaded(pending[2]), resource.loaded(pending[3]))
+        end
+    end)
+end
 function createBeep(freq, dur, vol)
     vol = vol or 1.0
     local data = {}
@@ -11,10 +23,22 @@ function createBeep(freq, dur, vol)
     return resource.createAudio(data)
 end
 tone880 = createBeep(880, 1.0)
+if buffer then -- native runtimes
+    local samples = buffer.new("float32", 4410)
+    for n = 1, #samples do
+        samples[n] = math.sin(2 * math.pi * 440 * n / 44100)
+    end
+    samples:add(samples:slice(), 0.5):mul(0.5):clamp(-0.5, 0.5)
+    print("buffer:", samples, samples:sum(), resource.createAudio(samples))
+end
 
 resource.setStorageItem("key", "value")
 local val = resource.getStorageItem("key")
-print("Storage value:", val)
+print("Storage value:", val, "flushed:", resource.flushStorage and resource.flushStorage())
+if resource.flushStorage then -- native runtimes keep binary strings intact
+    resource.setStorageItem("binary", "\0\1\2\255")
+    print("Binary storage value length:", #resource.getStorageItem("binary"))
+end
 
 frame = 0
 
@@ -22,14 +46,30 @@ function enter(args)
     print("enter called, args:", args)
     print("window dimensions:", window.width(), window.height())
     window.color(0x000055ff)
+    if window.axisFilter then -- native runtimes
+        window.axisFilter(0.1, 0.15)
+    end
     audio.replay(sample, 1, 0.5)
     local track = audio.replay(tone880, 0.5, -0.5)
     audio.volume(track, 0.0, 1.0) -- fade out over 1 second
+    if audio.stream then -- native runtimes
+        local music = audio.stream("ding.wav", 0.5, true)
+        audio.volume(music, 0.0, 2.0) -- looped stream, fades out over 2 seconds
+    end
+    if audio.replayAt then -- native runtimes
+        print("audio buffer/latency:", audio.bufferSize(), audio.latency())
+        for beat = 1, 3 do -- exactly half a second apart on the audio clock
+            audio.replayAt(sample, audio.time() + 0.1 + beat * 0.5, 0.5)
+        end
+    end
 
     print("query image w/h:", resource.queryImage(img, "width"), resource.queryImage(img, "height"))
     local ok, err = pcall(function() resource.queryImage(999999, "width") end)
     if ok then print("query image invalid handle: BUG - did not throw")
     else print("query image invalid handle correctly threw:", err) end
+    ok, err = pcall(function() resource.createImage({ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, 4, 4) end)
+    if ok then print("create image short buffer: BUG - did not throw")
+    else print("create image short buffer correctly threw:", err) end
     print("query audio channels/frames/sampleRate:", resource.queryAudio(sample, "channels"), resource.queryAudio(sample, "frames"), resource.queryAudio(sample, "sampleRate"))
     print("query font w/h/ascent/descent:", resource.queryFont(font, "width", "Hello"), resource.queryFont(font, "height", "Hello"), resource.queryFont(font, "ascent", "Hello"), resource.queryFont(font, "descent", "Hello"))
     print("query font default str:", resource.queryFont(font, "width"))
@@ -42,6 +82,10 @@ end
 function update(deltaT)
     if frame < 2 then
         print(string.format("update called with deltaT %s at frame %d", tostring(deltaT), frame))
+        if window.inputState then -- native runtimes
+            local state = window.inputState(0)
+            print("input state: buttons", state[1], "axes", #state - 1, "pressed:", window.pressed(0, 0))
+        end
     end
     return true
 end
@@ -72,5 +116,5 @@ function draw(gfx)
 end
 
 function leave()
-    print("leave called")
+    print("leave called, coalesced axis events:", window.stats and window.stats("inputCoalesced"))
 end
@@ -3,16 +3,37 @@ import math
 
 img = resource.getImage("test.png")
 rings = resource.getTileGrid(resource.getImage("rings.svg", 1.0, 0.5, 0.5), 5)
+print("svg cached:", resource.getImage("rings.svg", 2.0) == resource.getImage("rings.svg", 2.0))
+if hasattr(resource, "createAtlas"): # native runtimes
+    print("atlas images:", resource.createAtlas(["test.png", "rings.svg"], 1.0, 0.5, 0.5))
 font = resource.getFont("Viafont.ttf", 32)
 sample = resource.getAudio("ding.wav")
+def onProgress(progress):
+    print("load progress:", progress)
+    if progress >= 1.0:
+        print("loaded:", [resource.loaded(p) for p in pending])
+if hasattr(resource, "load"): # native runtimes
+    pending = resource.load(["test.png", "rings.svg", "ding.wav"], onProgress)
 def createBeep(freq, dur, vol=1.0):
     return resource.createAudio([math.sin(2 * math.pi * freq * n / 44100) * vol
         for n in range(int(44100 * dur))])
 tone880 = createBeep(880, 1.0)
+try: # native runtimes
+    from arcamini import buffer
+    samples = buffer("float32", 4410)
+    for n in range(len(samples)):
+        samples[n] = math.sin(2 * math.pi * 440 * n / 44100)
+    samples.add(samples[:], 0.5).mul(0.5).clamp(-0.5, 0.5)
+    print("buffer:", samples.type, len(samples), samples.sum(), resource.createAudio(samples))
+except ImportError:
+    pass
 
 resource.setStorageItem("key", "value")
 val = resource.getStorageItem("key")
-print("Storage value:", val)
+print("Storage value:", val, "flushed:", resource.flushStorage() if hasattr(resource, "flushStorage") else None)
+if hasattr(resource, "flushStorage"): # native runtimes accept bytes
+    resource.setStorageItem("binary", bytes([0, 1, 2, 255]))
+    print("Binary storage value:", resource.getStorageItem("binary"))
 
 frame = 0
 
@@ -21,9 +42,18 @@ def enter(args):
     print("enter called, args:", args)
     print("window dimensions:", window.width(), window.height())
     window.color(0x000055ff)
+    if hasattr(window, "axisFilter"): # native runtimes
+        window.axisFilter(0.1, 0.15)
     audio.replay(sample, 1, 0.5)
     track = audio.replay(tone880, 0.5, -0.5)
     audio.volume(track, 0.0, 1.0) # fade out over 1 second
+    if hasattr(audio, "stream"): # native runtimes
+        music = audio.stream("ding.wav", 0.5, True)
+        audio.volume(music, 0.0, 2.0) # looped stream, fades out over 2 seconds
+    if hasattr(audio, "replayAt"): # native runtimes
+        print("audio buffer/latency:", audio.bufferSize(), audio.latency())
+        for beat in range(1, 4): # exactly half a second apart on the audio clock
+            audio.replayAt(sample, audio.time() + 0.1 + beat * 0.5, 0.5)
 
     print("query image w/h:", resource.queryImage(img, "width"), resource.queryImage(img, "height"))
     try:
@@ -31,6 +61,11 @@ def enter(args):
         print("query image invalid handle: BUG - did not throw")
     except Exception as e:
         print("query image invalid handle correctly threw:", e)
+    try:
+        resource.createImage([0xffffffff] * 4, 4, 4)
+        print("create image short buffer: BUG - did not throw")
+    except Exception as e:
+        print("create image short buffer correctly threw:", e)
     print("query audio channels/frames/sampleRate:", resource.queryAudio(sample, "channels"), resource.queryAudio(sample, "frames"), resource.queryAudio(sample, "sampleRate"))
     print("query font w/h/ascent/descent:", resource.queryFont(font, "width", "Hello"), resource.queryFont(font, "height", "Hello"), resource.queryFont(font, "ascent", "Hello"), resource.queryFont(font, "descent", "Hello"))
     print("query font default str:", resource.queryFont(font, "width"))
@@ -42,6 +77,8 @@ def update(deltaT):
     global frame
     if frame < 2:
         print(f"update called with deltaT {deltaT} at frame {frame}")
+        if hasattr(window, "inputState"): # native runtimes
+            print("input state:", window.inputState(0), "pressed:", window.pressed(0, 0))
     return True
 
 def draw(gfx):
@@ -69,4 +106,4 @@ def draw(gfx):
     frame += 1
 
 def leave():
-    print("leave called")
+    print("leave called, coalesced axis events:", window.stats("inputCoalesced") if hasattr(window, "stats") else None)
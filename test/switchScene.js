@@ -2,6 +2,15 @@ let now = 0.0;
 
 export function enter(arg) {
     console.log('enter', arg);
+    window.preloadScene('switchSceneDest.js');
+}
+
+export function inputBatch(events) {
+    // 5 values per event: type (1=button), device, id, value, timestamp
+    for (let i = 0; i < events.length; i += 5) {
+        if (events[i] == 1 && events[i+3] == 1)
+            return window.switchScene('switchSceneDest.js', 'button_time', events[i+4]);
+    }
 }
 
 export function update(deltaT) {
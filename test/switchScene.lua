@@ -2,6 +2,18 @@ now = 0.0
 
 function enter(arg)
     print('enter', arg)
+    if window.preloadScene then -- native runtimes
+        window.preloadScene('switchSceneDest.lua')
+    end
+end
+
+function inputBatch(events)
+    -- 5 values per event: type (1=button), device, id, value, timestamp
+    for i = 1, #events, 5 do
+        if events[i] == 1 and events[i+3] == 1 then
+            return window.switchScene('switchSceneDest.lua', 'button_time', events[i+4])
+        end
+    end
 end
 
 function update(deltaT)
@@ -4,6 +4,15 @@ now = 0.0
 
 def enter(arg):
     print("enter", arg)
+    if hasattr(window, "preloadScene"): # native runtimes
+        window.preloadScene("switchSceneDest.py")
+
+def inputBatch(events):
+    # 5 values per event: type (1=button), device, id, value, timestamp
+    for i in range(0, len(events), 5):
+        if events[i] == 1 and events[i+3] == 1:
+            window.switchScene("switchSceneDest.py", 'button_time', events[i+4])
+            return
 
 def update(deltaT):
     global now